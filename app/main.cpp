@@ -4,8 +4,13 @@
 #include <QLocale>
 #include <QTranslator>
 
+#include "protocols/iec104/infoobjects.hpp"
+
 int main(int argc, char *argv[])
 {
+    // All info objects are registered during static initialization
+    IEC104::InfoObjectFactory::Freeze();
+
     QApplication a(argc, argv);
 
     QTranslator translator;
@@ -19,6 +19,7 @@ MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
     , networkTick(this)
+    , networkPoll(this)
 {
     ui->setupUi(this);
     async::this_thread::set_executor(ctx.get_executor());
@@ -28,6 +29,10 @@ MainWindow::MainWindow(QWidget *parent)
     networkTick.callOnTimeout(this, &MainWindow::executeNetworkTasks);
     networkTick.start(250);
 
+    // Received data is handled, as soon as the context is polled. Timers only need the slower tick.
+    networkPoll.callOnTimeout(this, &MainWindow::pollNetwork);
+    networkPoll.start(5);
+
     ui->editPort->setValidator(new QIntValidator(0, 65535, this));
     ui->tableConnections->setColumnCount(4);
     ui->tableConnections->hideColumn(0);
@@ -71,10 +76,11 @@ void MainWindow::onStartClicked()
     ui->cbIpSelect->setEnabled(false);
     ui->editPort->setEnabled(false);
 
-    server->SignalApduReceived.Register([this](IEC104::Link& l, const IEC104::Apdu& msg) { OnApduReceived(l, msg);    });
+    server->SignalApduReceived.Register([this](IEC104::Link& l, const IEC104::ApduView& msg) { OnApduReceived(l, msg);    });
     server->SignalApduSent.Register([this](IEC104::Link& l, const IEC104::Apdu& msg) { OnApduSent(l, msg);        });
     server->SignalLinkStateChanged.Register([this](IEC104::Link& l) { OnLinkStateChanged(l);});
     server->SignalLinkTickFinished.Register([this](IEC104::Link& l) { OnLinkTickFinished(l);     });
+    server->Start();
 
     AddServer();
 }
@@ -126,14 +132,14 @@ void MainWindow::OnLinkTickFinished(IEC104::Link& l)
         return; // debug stub
 }
 
-void MainWindow::OnApduReceived(IEC104::Link& l, const IEC104::Apdu& msg)
+void MainWindow::OnApduReceived(IEC104::Link& l, const IEC104::ApduView& msg)
 {
     AddApdu(l, msg, false);
 }
 
 void MainWindow::OnApduSent(IEC104::Link& l, const IEC104::Apdu& msg)
 {
-    AddApdu(l, msg, true);
+    AddApdu(l, msg.View(), true);
 }
 
 void MainWindow::AddServer()
@@ -171,7 +177,7 @@ static QString IpString(asio::ip::address ip, uint16_t port) {
     return QString("%1:%2").arg(QString::fromStdString(ip.to_string()), port);
 }
 
-void MainWindow::AddApdu(IEC104::Link& l, const IEC104::Apdu& msg, bool sent)
+void MainWindow::AddApdu(IEC104::Link& l, const IEC104::ApduView& msg, bool sent)
 {
     auto view = ui->tableMainLog;
     auto row = view->rowCount();
@@ -185,7 +191,7 @@ void MainWindow::AddApdu(IEC104::Link& l, const IEC104::Apdu& msg, bool sent)
     SetReadOnly(view, row);
 }
 
-QString MainWindow::ParseApdu(const IEC104::Apdu& msg) {
+QString MainWindow::ParseApdu(const IEC104::ApduView& msg) {
     return QString(" ");
 }
 
@@ -207,10 +213,21 @@ void MainWindow::executeNetworkTasks()
         async::spawn(ctx, ServerTick(), asio::detached);
         ctx.poll();
     }
-    catch (std::exception e) 
+    catch (const std::exception&)
     {
     }
 
     auto stop = std::chrono::high_resolution_clock::now();
     std::cout << std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count() << std::endl;
 }
+
+void MainWindow::pollNetwork()
+{
+    try
+    {
+        ctx.poll();
+    }
+    catch (const std::exception&)
+    {
+    }
+}
\ No newline at end of file
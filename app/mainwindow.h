@@ -12,6 +12,7 @@
 namespace IEC104
 {
     class Apdu;
+    class ApduView;
     class Link;
     class Server;
 }
@@ -34,22 +35,24 @@ public slots:
     void onStartClicked();
     void onStopClicked();
     void executeNetworkTasks();
+    void pollNetwork();
 
 private:
     boost::cobalt::task<void> ServerTick();
 
     void OnLinkStateChanged(IEC104::Link& l);
     void OnLinkTickFinished(IEC104::Link& l);
-    void OnApduReceived(IEC104::Link& l, const IEC104::Apdu& msg);
+    void OnApduReceived(IEC104::Link& l, const IEC104::ApduView& msg);
     void OnApduSent(IEC104::Link& l, const IEC104::Apdu& msg);
-    void AddApdu(IEC104::Link& l, const IEC104::Apdu& msg, bool sent);
-    QString ParseApdu(const IEC104::Apdu& msg);
+    void AddApdu(IEC104::Link& l, const IEC104::ApduView& msg, bool sent);
+    QString ParseApdu(const IEC104::ApduView& msg);
 
     void AddServer();
     void RemoveServer();
 
 private:
     QTimer networkTick;
+    QTimer networkPoll;
     void FillIpSelectBox();
     Ui::MainWindow *ui;
     boost::asio::io_context ctx;
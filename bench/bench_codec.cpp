@@ -0,0 +1,370 @@
+#include "bench/benchmark.hpp"
+
+#include <random>
+#include <vector>
+
+#include "core/bytestream.hpp"
+#include "protocols/iec104/104enums.hpp"
+#include "protocols/iec104/apdu.hpp"
+#include "protocols/iec104/asdu.hpp"
+#include "protocols/iec104/infoobjects.hpp"
+#include "protocols/iec104/sequence.hpp"
+#include "protocols/iec104/typedasdu.hpp"
+
+using namespace IEC104;
+
+namespace
+{
+    // Fixed seed: every run measures the same data
+    constexpr unsigned SEED = 104;
+    // APDUs in a simulated receive buffer
+    constexpr size_t FRAMES = 64;
+
+    template <typename RECORD>
+    RECORD MakeRecord(uint32_t aAddress, std::minstd_rand& arRandom)
+    {
+        RECORD record;
+        record.address = aAddress;
+        record.q = Quality(static_cast<uint8_t>(arRandom() & 0xF1));
+
+        if constexpr (std::is_same_v<RECORD, RecordSinglePoint>)
+            record.val = arRandom() & 1;
+        else if constexpr (std::is_same_v<RECORD, RecordDoublePoint>)
+            record.val = static_cast<DoublePoint>(arRandom() & 0x03);
+        else if constexpr (std::is_same_v<RECORD, RecordMeasuredScaled>)
+            record.val = static_cast<int16_t>(arRandom());
+        else
+            record.val = static_cast<float>(arRandom() % 100000) / 100.0f;
+
+        return record;
+    }
+
+    // Encoded ASDU with as many objects as fit into a single APDU
+    template <typename RECORD>
+    std::vector<uint8_t> EncodeFullAsdu(bool aSequence)
+    {
+        std::minstd_rand random(SEED);
+        TypedAsdu<RECORD> asdu(AsduConfig::Defaults);
+        asdu.SetSequence(aSequence);
+        asdu.GetHeader().commonAddress = 1;
+
+        // Scattered addresses, unless the sequence defines them
+        for (size_t i = 0; asdu.HasMoreSpace(); ++i)
+            asdu.Append(MakeRecord<RECORD>(aSequence ? 1000 + i : random() % 0xFFFFFF, random));
+
+        ByteStream encoded;
+        asdu.WriteTo(encoded);
+        return std::vector<uint8_t>(encoded.DataBegin(), encoded.DataEnd());
+    }
+
+    template <typename RECORD>
+    Apdu MakeFullApdu(bool aSequence)
+    {
+        const auto asdu = EncodeFullAsdu<RECORD>(aSequence);
+        Apdu apdu(asdu.data(), asdu.size());
+        apdu.SetSequences(Sequence(1), Sequence(2));
+        return apdu;
+    }
+
+    // Back-to-back I-Frames of varying size, as they arrive from the network
+    std::vector<uint8_t> MakeReceiveBuffer()
+    {
+        const Apdu frames[] = {
+            MakeFullApdu<RecordMeasuredFloat>(false),
+            MakeFullApdu<RecordSinglePoint>(true),
+            MakeFullApdu<RecordMeasuredScaled>(false),
+            Apdu(Sequence(7)),
+        };
+
+        std::vector<uint8_t> buffer;
+        for (size_t i = 0; i < FRAMES; ++i)
+            frames[i % std::size(frames)].WriteTo(buffer);
+        return buffer;
+    }
+}
+
+// APDU ////////////////////////////////////////////////////////////////////////////////////////////
+
+// Refill a receive buffer and take all views from it, as the receive loop does
+static void BM_ApduViewParse(BENCH::State& state)
+{
+    const auto data = MakeReceiveBuffer();
+    ByteStream stream(data.size());
+
+    for (auto _ : state)
+    {
+        stream.Clear();
+        stream.WriteData(data.data(), data.size());
+
+        while (Apdu::IsFullyAvailable(stream))
+        {
+            ApduView apdu(stream);
+            BENCH::DoNotOptimize(apdu.SendSequence());
+        }
+    }
+
+    state.SetItemsProcessed(state.Iterations() * FRAMES);
+    state.SetBytesProcessed(state.Iterations() * data.size());
+}
+VRTU_BENCHMARK(BM_ApduViewParse);
+
+// Same, but copy every frame into an owning Apdu
+static void BM_ApduParse(BENCH::State& state)
+{
+    const auto data = MakeReceiveBuffer();
+    ByteStream stream(data.size());
+
+    for (auto _ : state)
+    {
+        stream.Clear();
+        stream.WriteData(data.data(), data.size());
+
+        while (Apdu::IsFullyAvailable(stream))
+        {
+            Apdu apdu(stream);
+            BENCH::DoNotOptimize(apdu);
+        }
+    }
+
+    state.SetItemsProcessed(state.Iterations() * FRAMES);
+    state.SetBytesProcessed(state.Iterations() * data.size());
+}
+VRTU_BENCHMARK(BM_ApduParse);
+
+// Arg: 0 = S-Frame, 1 = I-Frame of maximum size
+static void BM_ApduWriteTo(BENCH::State& state)
+{
+    const Apdu apdu = state.Range(0) ? MakeFullApdu<RecordMeasuredFloat>(false) : Apdu(Sequence(7));
+    std::vector<uint8_t> dest;
+    dest.reserve(ApduView::MAX_LENGTH);
+
+    for (auto _ : state)
+    {
+        dest.clear();
+        apdu.WriteTo(dest);
+        BENCH::DoNotOptimize(dest.data());
+    }
+
+    state.SetItemsProcessed(state.Iterations());
+    state.SetBytesProcessed(state.Iterations() * apdu.Length());
+}
+VRTU_BENCHMARK(BM_ApduWriteTo)->Arg(0)->Arg(1);
+
+// ASDU ////////////////////////////////////////////////////////////////////////////////////////////
+// Arg: SQ bit. Every ASDU carries as many objects as fit into one APDU.
+
+template <typename RECORD>
+static void BM_AsduReadFrom(BENCH::State& state)
+{
+    const auto apdu = MakeFullApdu<RECORD>(state.Range(0) != 0);
+    Asdu asdu;
+
+    for (auto _ : state)
+    {
+        asdu.ReadFrom(apdu.View());
+        BENCH::DoNotOptimize(asdu.GetNumberOfInfoObjects());
+    }
+
+    state.SetItemsProcessed(state.Iterations() * asdu.GetNumberOfInfoObjects());
+    state.SetBytesProcessed(state.Iterations() * apdu.PayloadLength());
+}
+VRTU_BENCHMARK_TEMPLATE(BM_AsduReadFrom, RecordSinglePoint)->Arg(0)->Arg(1);
+VRTU_BENCHMARK_TEMPLATE(BM_AsduReadFrom, RecordDoublePoint)->Arg(0)->Arg(1);
+VRTU_BENCHMARK_TEMPLATE(BM_AsduReadFrom, RecordMeasuredScaled)->Arg(0)->Arg(1);
+VRTU_BENCHMARK_TEMPLATE(BM_AsduReadFrom, RecordMeasuredFloat)->Arg(0)->Arg(1);
+
+template <typename RECORD>
+static void BM_AsduWriteTo(BENCH::State& state)
+{
+    const auto apdu = MakeFullApdu<RECORD>(state.Range(0) != 0);
+    Asdu asdu;
+    asdu.ReadFrom(apdu.View());
+    ByteStream out(ApduView::MAX_LENGTH);
+
+    for (auto _ : state)
+    {
+        out.Clear();
+        asdu.WriteTo(out);
+        BENCH::DoNotOptimize(out.DataBegin());
+    }
+
+    state.SetItemsProcessed(state.Iterations() * asdu.GetNumberOfInfoObjects());
+    state.SetBytesProcessed(state.Iterations() * apdu.PayloadLength());
+}
+VRTU_BENCHMARK_TEMPLATE(BM_AsduWriteTo, RecordSinglePoint)->Arg(0)->Arg(1);
+VRTU_BENCHMARK_TEMPLATE(BM_AsduWriteTo, RecordDoublePoint)->Arg(0)->Arg(1);
+VRTU_BENCHMARK_TEMPLATE(BM_AsduWriteTo, RecordMeasuredScaled)->Arg(0)->Arg(1);
+VRTU_BENCHMARK_TEMPLATE(BM_AsduWriteTo, RecordMeasuredFloat)->Arg(0)->Arg(1);
+
+template <typename RECORD>
+static void BM_TypedAsduReadFrom(BENCH::State& state)
+{
+    const auto apdu = MakeFullApdu<RECORD>(state.Range(0) != 0);
+    TypedAsdu<RECORD> asdu;
+
+    for (auto _ : state)
+    {
+        asdu.ReadFrom(apdu.View());
+        BENCH::DoNotOptimize(asdu.Size());
+    }
+
+    state.SetItemsProcessed(state.Iterations() * asdu.Size());
+    state.SetBytesProcessed(state.Iterations() * apdu.PayloadLength());
+}
+VRTU_BENCHMARK_TEMPLATE(BM_TypedAsduReadFrom, RecordSinglePoint)->Arg(0)->Arg(1);
+VRTU_BENCHMARK_TEMPLATE(BM_TypedAsduReadFrom, RecordDoublePoint)->Arg(0)->Arg(1);
+VRTU_BENCHMARK_TEMPLATE(BM_TypedAsduReadFrom, RecordMeasuredScaled)->Arg(0)->Arg(1);
+VRTU_BENCHMARK_TEMPLATE(BM_TypedAsduReadFrom, RecordMeasuredFloat)->Arg(0)->Arg(1);
+
+template <typename RECORD>
+static void BM_TypedAsduWriteTo(BENCH::State& state)
+{
+    const auto apdu = MakeFullApdu<RECORD>(state.Range(0) != 0);
+    TypedAsdu<RECORD> asdu;
+    asdu.ReadFrom(apdu.View());
+    ByteStream out(ApduView::MAX_LENGTH);
+
+    for (auto _ : state)
+    {
+        out.Clear();
+        asdu.WriteTo(out);
+        BENCH::DoNotOptimize(out.DataBegin());
+    }
+
+    state.SetItemsProcessed(state.Iterations() * asdu.Size());
+    state.SetBytesProcessed(state.Iterations() * apdu.PayloadLength());
+}
+VRTU_BENCHMARK_TEMPLATE(BM_TypedAsduWriteTo, RecordSinglePoint)->Arg(0)->Arg(1);
+VRTU_BENCHMARK_TEMPLATE(BM_TypedAsduWriteTo, RecordDoublePoint)->Arg(0)->Arg(1);
+VRTU_BENCHMARK_TEMPLATE(BM_TypedAsduWriteTo, RecordMeasuredScaled)->Arg(0)->Arg(1);
+VRTU_BENCHMARK_TEMPLATE(BM_TypedAsduWriteTo, RecordMeasuredFloat)->Arg(0)->Arg(1);
+
+// Info objects ////////////////////////////////////////////////////////////////////////////////////
+
+// Arg: type id
+static void BM_InfoObjectFactoryCreate(BENCH::State& state)
+{
+    const auto type = static_cast<uint8_t>(state.Range(0));
+
+    for (auto _ : state)
+    {
+        auto p_object = InfoObjectFactory::Create(type);
+        BENCH::DoNotOptimize(p_object.get());
+    }
+
+    state.SetItemsProcessed(state.Iterations());
+}
+VRTU_BENCHMARK(BM_InfoObjectFactoryCreate)
+    ->Arg(Type::M_SP_NA_1)->Arg(Type::M_DP_NA_1)->Arg(Type::M_ME_NB_1)->Arg(Type::M_ME_NC_1);
+
+// Sequence ////////////////////////////////////////////////////////////////////////////////////////
+
+static void BM_SequenceDistance(BENCH::State& state)
+{
+    constexpr size_t PAIRS = 1024;
+    std::minstd_rand random(SEED);
+    std::uniform_int_distribution<int> value(0, Sequence::MAX_SEQ);
+
+    // Pairs across the overflow are as likely as regular ones
+    std::vector<std::pair<Sequence, Sequence>> pairs;
+    for (size_t i = 0; i < PAIRS; ++i)
+        pairs.emplace_back(Sequence(value(random)), Sequence(value(random)));
+
+    for (auto _ : state)
+    {
+        int sum = 0;
+        for (const auto& [from, to] : pairs)
+            sum += from.Distance(to);
+        BENCH::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.Iterations() * PAIRS);
+}
+VRTU_BENCHMARK(BM_SequenceDistance);
+
+// ByteStream //////////////////////////////////////////////////////////////////////////////////////
+
+// Arg: bytes per read. 1 uses ReadByte, larger reads use a cursor.
+static void BM_ByteStreamRead(BENCH::State& state)
+{
+    constexpr size_t SIZE = 4096;
+    const auto chunk = static_cast<size_t>(state.Range(0));
+    const std::vector<uint8_t> data(SIZE, 0x5A);
+    ByteStream stream(SIZE);
+
+    for (auto _ : state)
+    {
+        stream.Clear();
+        stream.WriteData(data.data(), data.size());
+        unsigned sum = 0;
+
+        if (chunk == 1)
+        {
+            while (stream.RemainingBytes() > 0)
+                sum += stream.ReadByte();
+        }
+        else
+        {
+            while (stream.RemainingBytes() >= chunk)
+            {
+                auto cursor = stream.ReadCursor(chunk);
+                for (size_t i = 0; i < chunk; ++i)
+                    sum += cursor.ReadByte();
+            }
+        }
+
+        BENCH::DoNotOptimize(sum);
+    }
+
+    state.SetBytesProcessed(state.Iterations() * SIZE);
+}
+VRTU_BENCHMARK(BM_ByteStreamRead)->Arg(1)->Arg(8)->Arg(64);
+
+/*
+ * Receive pattern: a read fills the buffer, all complete frames are consumed and a partial frame remains.
+ * Arg 0: bytes of the partial frame. Arg 1: 0 = Flush after every read, 1 = Reclaim
+ */
+static void BM_ByteStreamFlush(BENCH::State& state)
+{
+    constexpr size_t SIZE = 4096;
+    const auto partial = static_cast<size_t>(state.Range(0));
+    const bool reclaim = state.Range(1) != 0;
+    const std::vector<uint8_t> data(SIZE, 0x68);
+    ByteStream stream(SIZE);
+
+    for (auto _ : state)
+    {
+        const auto writable = std::min(stream.WritableBytes(), SIZE - partial);
+        stream.WriteData(data.data(), writable);
+        stream.ReadData(stream.RemainingBytes() - std::min(partial, stream.RemainingBytes()));
+
+        if (reclaim)
+            stream.Reclaim(ApduView::MAX_LENGTH);
+        else
+            stream.Flush();
+
+        BENCH::DoNotOptimize(stream.DataBegin());
+    }
+
+    state.SetItemsProcessed(state.Iterations());
+}
+VRTU_BENCHMARK(BM_ByteStreamFlush)
+    ->Args({0, 0})->Args({6, 0})->Args({200, 0})
+    ->Args({0, 1})->Args({6, 1})->Args({200, 1});
+
+// NamedEnum ///////////////////////////////////////////////////////////////////////////////////////
+
+// Arg: reason code. The labels are searched linearly, so later codes take longer.
+static void BM_NamedEnumGetLabel(BENCH::State& state)
+{
+    const ReasonCodeEnum reason(static_cast<ReasonCode>(state.Range(0)));
+
+    for (auto _ : state)
+        BENCH::DoNotOptimize(reason.GetLabel().data());
+
+    state.SetItemsProcessed(state.Iterations());
+}
+VRTU_BENCHMARK(BM_NamedEnumGetLabel)
+    ->Arg(static_cast<int64_t>(ReasonCode::PERIODIC))
+    ->Arg(static_cast<int64_t>(ReasonCode::SPONTANEOUS))
+    ->Arg(static_cast<int64_t>(ReasonCode::CUSTOM_CODE_63));
@@ -0,0 +1,115 @@
+#include "bench/benchmark.hpp"
+
+#include <memory>
+#include <optional>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/cobalt/this_thread.hpp>
+
+#include "core/bufferpool.hpp"
+#include "core/bytestream.hpp"
+#include "protocols/iec104/link.hpp"
+#include "protocols/iec104/typedasdu.hpp"
+
+using namespace IEC104;
+
+namespace
+{
+    // Controlling and controlled station, connected on loopback
+    class LoopbackPair
+    {
+    public:
+        LoopbackPair()
+        {
+            async::this_thread::set_executor(ctx.get_executor());
+
+            const auto address = asio::ip::make_address("127.0.0.1");
+            asio::ip::tcp::acceptor listener(ctx, {address, 0});
+            asio::ip::tcp::socket client(ctx), server(ctx);
+
+            client.connect(listener.local_endpoint());
+            listener.accept(server);
+            client.set_option(asio::ip::tcp::no_delay(true));
+            server.set_option(asio::ip::tcp::no_delay(true));
+
+            master.emplace(std::move(client), Link::Mode::Master, buffers);
+            slave.emplace(std::move(server), Link::Mode::Slave, buffers);
+
+            master->SignalApduReceived.Register([this](Link&, const ApduView& apdu) {
+                if (apdu.HasPayload())
+                    ++received;
+            });
+
+            master->Run();
+            slave->Run();
+
+            auto start = master->Start();
+            Await(start, [this]() { return master->IsActive() && slave->IsActive(); });
+        }
+
+        ~LoopbackPair()
+        {
+            slave->Close();
+            master->Close();
+            ctx.poll();
+        }
+
+        // Run handlers until the promise completed and the condition holds
+        template <typename CONDITION>
+        void Await(async::promise<void>& arPromise, CONDITION aCondition)
+        {
+            while (!arPromise.ready() || !aCondition())
+            {
+                if (ctx.run_one_for(std::chrono::seconds(5)) == 0)
+                    throw std::runtime_error("loopback exchange stalled");
+            }
+
+            arPromise.get();
+        }
+
+        // Destroyed after the links, whose receive loops run on it
+        asio::io_context ctx;
+        CORE::BufferPool buffers{Link::BUFFER_SIZE};
+        std::optional<Link> master;
+        std::optional<Link> slave;
+        uint64_t received = 0;
+    };
+}
+
+/*
+ * The controlled station sends a batch of I-Frames with a single flush, until the controlling station
+ * received all of them. Acknowledges of the controlling station are part of the exchange.
+ * Arg: I-Frames per batch
+ */
+static void BM_LinkLoopback(BENCH::State& state)
+{
+    const auto batch = static_cast<uint64_t>(state.Range(0));
+
+    TypedAsdu<RecordMeasuredFloat> asdu;
+    asdu.GetHeader().commonAddress = 1;
+    for (uint32_t i = 0; i < 10; ++i)
+        asdu.Append(RecordMeasuredFloat{1000 + i, static_cast<float>(i), Quality()});
+
+    ByteStream encoded;
+    asdu.WriteTo(encoded);
+    Asdu generic;
+    generic.ReadFrom(encoded);
+
+    LoopbackPair pair;
+    uint64_t expected = 0;
+
+    for (auto _ : state)
+    {
+        for (uint64_t i = 0; i < batch; ++i)
+            pair.slave->Enqueue(generic);
+
+        expected += batch;
+        auto flush = pair.slave->Flush();
+        pair.Await(flush, [&]() { return pair.received >= expected; });
+    }
+
+    state.SetItemsProcessed(state.Iterations() * batch);
+    state.SetBytesProcessed(state.Iterations() * batch * (ApduView::HEADER_SIZE + generic.GetHeader().GetExpectedSize(AsduConfig::Defaults, RecordMeasuredFloat::DATA_SIZE)));
+}
+VRTU_BENCHMARK(BM_LinkLoopback)->Arg(1)->Arg(8)->Arg(12);
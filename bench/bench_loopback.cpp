@@ -0,0 +1,505 @@
+/**
+ * @brief End-to-end benchmark of the link layer on loopback
+ *
+ * For every scenario, N pairs of controlling (master) and controlled (slave) stations are connected
+ * on loopback. The links of each side share a LinkGroup, as they do within Client and Server, and
+ * are ticked for timer supervision. All links run on a single thread.
+ *
+ * Every slave keeps its k-window full: whenever an acknowledge frees room, the free room is
+ * refilled with I-Frames from within the receive loop, which writes them with its next flush.
+ * Thus the links run at the maximum rate the stack allows and frames never wait in the queue.
+ *
+ * Reported per scenario:
+ *  - I-Frames per second, received by all masters together
+ *  - latency from the send of an I-Frame until SignalApduReceived of its master
+ *  - ack round-trip from the send of an I-Frame until its slave received the acknowledge
+ *
+ * Options: --links=1,100,10000 --kw=2:1,12:8,64:42 --duration=<seconds> --out=<json file>
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/cobalt/op.hpp>
+#include <boost/cobalt/this_thread.hpp>
+
+#include "core/clockwrapper.hpp"
+#include "core/metrics.hpp"
+#include "protocols/iec104/link.hpp"
+#include "protocols/iec104/server.hpp"
+#include "protocols/iec104/typedasdu.hpp"
+
+using namespace IEC104;
+
+namespace
+{
+    // Timer supervision of both link groups
+    constexpr std::chrono::milliseconds TICK_INTERVAL(100);
+    // Traffic before the measurement starts
+    constexpr std::chrono::milliseconds WARMUP(500);
+
+    uint64_t Microseconds(std::chrono::steady_clock::duration aLatency) noexcept
+    {
+        return static_cast<uint64_t>(std::max<int64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(aLatency).count(), 0));
+    }
+
+    // Upper bound of the bucket, which holds the quantile, but never above the largest latency
+    uint64_t Quantile(const CORE::Histogram::Snapshot& arLatencies, double aQuantile) noexcept
+    {
+        return std::min(arLatencies.Quantile(aQuantile), arLatencies.max);
+    }
+
+    struct Scenario
+    {
+        size_t links = 1;
+        int k = 12;
+        int w = 8;
+    };
+
+    struct Result
+    {
+        Scenario scenario;
+        double seconds = 0.0;
+        uint64_t frames = 0;
+        double cpuSeconds = 0.0;
+        // Latencies in microseconds
+        CORE::Histogram::Snapshot latency;
+        CORE::Histogram::Snapshot ack;
+        std::string error;
+    };
+
+    struct Options
+    {
+        std::vector<size_t> links = { 1, 100, 10000 };
+        std::vector<std::pair<int, int>> windows = { {2, 1}, {12, 8}, {64, 42} };
+        std::chrono::seconds duration{3};
+        std::string out;
+    };
+
+    // Both stations of a connection and the I-Frames between them
+    struct Pair
+    {
+        Link* master = nullptr;
+        Link* slave = nullptr;
+        // Send time of every I-Frame, which its master has not received yet
+        std::deque<std::chrono::steady_clock::time_point> inTransit;
+        // Send time of every I-Frame, which is not acknowledged yet. The first one has send sequence nextAck.
+        std::deque<std::chrono::steady_clock::time_point> unacked;
+        Sequence nextAck;
+    };
+
+    class Loopback
+    {
+    public:
+        explicit Loopback(const Scenario& arScenario)
+            : mScenario(arScenario)
+            , mConfig(30, 15, 10, 20, arScenario.k, arScenario.w)
+            , mMasters(VRTU::ClockWrapper::UtcNow())
+            , mSlaves(VRTU::ClockWrapper::UtcNow())
+        {
+            async::this_thread::set_executor(mContext.get_executor());
+
+            TypedAsdu<RecordMeasuredFloat> asdu;
+            asdu.GetHeader().commonAddress = 1;
+            for (uint32_t i = 0; i < 10; ++i)
+                asdu.Append(RecordMeasuredFloat{1000 + i, static_cast<float>(i), Quality()});
+
+            ByteStream encoded;
+            asdu.WriteTo(encoded);
+            mAsdu.ReadFrom(encoded);
+        }
+
+        Result Run(std::chrono::seconds aDuration)
+        {
+            Handshake();
+
+            std::vector<async::promise<void>> starts;
+            for (auto& r_pair : mPairs)
+                starts.push_back(r_pair.master->Start());
+
+            [[maybe_unused]] auto supervision = Supervise(aDuration);
+            mContext.run();
+
+            Result result = mResult;
+            result.scenario = mScenario;
+            result.latency = mLatency.Read();
+            result.ack = mAck.Read();
+            return result;
+        }
+
+    private:
+        // Connect all pairs through a listener on an ephemeral port
+        void Handshake()
+        {
+            asio::ip::tcp::acceptor listener(mContext, {asio::ip::make_address("127.0.0.1"), 0});
+
+            for (size_t i = 0; i < mScenario.links; ++i)
+            {
+                asio::ip::tcp::socket client(mContext), server(mContext);
+                client.connect(listener.local_endpoint());
+                listener.accept(server);
+                client.set_option(asio::ip::tcp::no_delay(true));
+                server.set_option(asio::ip::tcp::no_delay(true));
+
+                auto& r_pair = mPairs.emplace_back();
+                r_pair.master = mMasters.Find(mMasters.Add(std::move(client), Link::Mode::Master, mConfig));
+                r_pair.slave = mSlaves.Find(mSlaves.Add(std::move(server), Link::Mode::Slave, mConfig));
+
+                r_pair.master->SignalApduReceived.Register([this, p = &r_pair](Link&, const ApduView& apdu) {
+                    OnMasterReceived(*p, apdu);
+                });
+                r_pair.slave->SignalApduReceived.Register([this, p = &r_pair](Link&, const ApduView& apdu) {
+                    OnSlaveReceived(*p, apdu);
+                });
+                r_pair.slave->SignalStateChanged.Register([this, p = &r_pair](Link& l) {
+                    if (l.IsActive())
+                        Refill(*p);
+                });
+
+                r_pair.master->Run();
+                r_pair.slave->Run();
+            }
+        }
+
+        // Timer supervision, warmup and the end of the measurement
+        async::promise<void> Supervise(std::chrono::seconds aDuration)
+        {
+            asio::steady_timer timer(mContext);
+            const auto warmup_end = std::chrono::steady_clock::now() + WARMUP;
+            const auto end = warmup_end + aDuration;
+            std::clock_t cpu_start = 0;
+
+            for (auto now = std::chrono::steady_clock::now(); now < end; now = std::chrono::steady_clock::now())
+            {
+                timer.expires_after(TICK_INTERVAL);
+                co_await timer.async_wait(async::use_op);
+
+                co_await mMasters.Tick();
+                co_await mSlaves.Tick();
+
+                if (!mMeasuring && std::chrono::steady_clock::now() >= warmup_end)
+                {
+                    mMeasuring = true;
+                    mStart = std::chrono::steady_clock::now();
+                    cpu_start = std::clock();
+                }
+            }
+
+            mResult.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+            mResult.cpuSeconds = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+
+            if (!mMeasuring)
+                mResult.error = "warmup did not finish";
+
+            for (const auto& r_pair : mPairs)
+            {
+                if (!r_pair.master->IsConnected() || !r_pair.slave->IsConnected())
+                {
+                    mResult.error = "a link was closed during the measurement";
+                    break;
+                }
+            }
+
+            mContext.stop();
+        }
+
+        // Keep the k-window of the slave full
+        void Refill(Pair& arPair)
+        {
+            const auto now = std::chrono::steady_clock::now();
+
+            while (arPair.unacked.size() < static_cast<size_t>(mScenario.k))
+            {
+                arPair.slave->Enqueue(mAsdu);
+                arPair.inTransit.push_back(now);
+                arPair.unacked.push_back(now);
+            }
+        }
+
+        void OnMasterReceived(Pair& arPair, const ApduView& arApdu)
+        {
+            if (!arApdu.SendSequence() || arPair.inTransit.empty())
+                return;
+
+            if (mMeasuring)
+            {
+                mLatency.Record(Microseconds(std::chrono::steady_clock::now() - arPair.inTransit.front()));
+                ++mResult.frames;
+            }
+
+            arPair.inTransit.pop_front();
+        }
+
+        // Called before the link handles the acknowledge. The refilled frames are written with the flush of the receive loop.
+        void OnSlaveReceived(Pair& arPair, const ApduView& arApdu)
+        {
+            auto receive = arApdu.ReceiveSequence();
+            if (!receive || !arPair.slave->IsActive())
+                return;
+
+            const auto now = std::chrono::steady_clock::now();
+            const auto acked = std::min<size_t>(std::max(arPair.nextAck.Distance(*receive), 0), arPair.unacked.size());
+
+            for (size_t i = 0; i < acked; ++i)
+            {
+                if (mMeasuring)
+                    mAck.Record(Microseconds(now - arPair.unacked.front()));
+                arPair.unacked.pop_front();
+                ++arPair.nextAck;
+            }
+
+            if (acked > 0)
+                Refill(arPair);
+        }
+
+    private:
+        Scenario mScenario;
+        ConnectionConfig mConfig;
+        Asdu mAsdu;
+
+        // Destroyed after the links, whose sockets and coroutines belong to it
+        asio::io_context mContext;
+        LinkGroup mMasters;
+        LinkGroup mSlaves;
+        // Pairs keep their address, because the signals refer to them
+        std::deque<Pair> mPairs;
+
+        bool mMeasuring = false;
+        std::chrono::steady_clock::time_point mStart;
+        Result mResult;
+        CORE::Histogram mLatency;
+        CORE::Histogram mAck;
+    };
+
+    // Every link needs a socket on both sides
+    bool RaiseFileLimit(size_t aLinks)
+    {
+#ifndef _WIN32
+        const rlim_t needed = static_cast<rlim_t>(aLinks) * 2 + 64;
+        rlimit limit{};
+
+        if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+            return false;
+
+        if (limit.rlim_cur >= needed)
+            return true;
+
+        if (limit.rlim_max != RLIM_INFINITY && limit.rlim_max < needed)
+            return false;
+
+        limit.rlim_cur = needed;
+        return setrlimit(RLIMIT_NOFILE, &limit) == 0;
+#else
+        (void)aLinks;
+        return true;
+#endif
+    }
+
+    std::vector<std::string> Split(const std::string& arText, char aSeparator)
+    {
+        std::vector<std::string> parts;
+        std::istringstream input(arText);
+
+        for (std::string part; std::getline(input, part, aSeparator);)
+        {
+            if (!part.empty())
+                parts.push_back(part);
+        }
+
+        return parts;
+    }
+
+    Options ReadArguments(int argc, char* argv[])
+    {
+        Options options;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg(argv[i]);
+            const auto separator = arg.find('=');
+            const auto option = arg.substr(0, separator);
+            const auto value = separator == std::string::npos ? std::string() : arg.substr(separator + 1);
+
+            if (option == "--links")
+            {
+                options.links.clear();
+                for (const auto& r_links : Split(value, ','))
+                    options.links.push_back(std::stoul(r_links));
+            }
+            else if (option == "--kw")
+            {
+                options.windows.clear();
+                for (const auto& r_window : Split(value, ','))
+                {
+                    const auto kw = Split(r_window, ':');
+                    if (kw.size() != 2)
+                        throw std::invalid_argument("window must be given as k:w");
+                    options.windows.emplace_back(std::stoi(kw[0]), std::stoi(kw[1]));
+                }
+            }
+            else if (option == "--duration")
+            {
+                options.duration = std::chrono::seconds(std::stoul(value));
+            }
+            else if (option == "--out")
+            {
+                options.out = value;
+            }
+            else
+            {
+                throw std::invalid_argument("unknown option " + arg);
+            }
+        }
+
+        return options;
+    }
+
+    void PrintHeader()
+    {
+        std::cout << std::right
+                  << std::setw(7) << "links" << std::setw(5) << "k" << std::setw(5) << "w"
+                  << std::setw(14) << "frames/s"
+                  << std::setw(12) << "lat p50" << std::setw(10) << "p99" << std::setw(10) << "max"
+                  << std::setw(12) << "ack p50" << std::setw(10) << "p99" << std::setw(10) << "max"
+                  << std::setw(9) << "cpu" << "\n"
+                  << std::string(108, '-') << std::endl;
+    }
+
+    void Print(const Result& arResult)
+    {
+        const auto& s = arResult.scenario;
+        std::cout << std::right << std::setw(7) << s.links << std::setw(5) << s.k << std::setw(5) << s.w;
+
+        if (!arResult.error.empty())
+        {
+            std::cout << "  ERROR: " << arResult.error << std::endl;
+            return;
+        }
+
+        std::cout << std::fixed << std::setprecision(0)
+                  << std::setw(14) << static_cast<double>(arResult.frames) / arResult.seconds
+                  << std::setw(10) << Quantile(arResult.latency, 0.5) << "us"
+                  << std::setw(8) << Quantile(arResult.latency, 0.99) << "us"
+                  << std::setw(8) << arResult.latency.max << "us"
+                  << std::setw(10) << Quantile(arResult.ack, 0.5) << "us"
+                  << std::setw(8) << Quantile(arResult.ack, 0.99) << "us"
+                  << std::setw(8) << arResult.ack.max << "us"
+                  << std::setprecision(1)
+                  << std::setw(8) << 100.0 * arResult.cpuSeconds / arResult.seconds << "%"
+                  << std::endl;
+    }
+
+    void WriteHistogram(std::ostream& arOut, const char* apName, const CORE::Histogram::Snapshot& arHistogram)
+    {
+        arOut << "      \"" << apName << "\": { \"count\": " << arHistogram.count
+              << ", \"p50\": " << Quantile(arHistogram, 0.5)
+              << ", \"p90\": " << Quantile(arHistogram, 0.9)
+              << ", \"p99\": " << Quantile(arHistogram, 0.99)
+              << ", \"max\": " << arHistogram.max
+              << ", \"buckets\": [";
+
+        // Bucket i counts the latencies below 2^i microseconds
+        const auto used = std::find_if(arHistogram.buckets.rbegin(), arHistogram.buckets.rend(),
+                                       [](uint64_t aCount) { return aCount != 0; }).base();
+        for (auto it = arHistogram.buckets.begin(); it != used; ++it)
+            arOut << (it == arHistogram.buckets.begin() ? "" : ", ") << *it;
+
+        arOut << "] }";
+    }
+
+    void WriteJson(const std::string& arPath, const std::vector<Result>& arResults)
+    {
+        std::ofstream out(arPath);
+        if (!out)
+            throw std::runtime_error("cannot open " + arPath);
+
+        out << std::setprecision(10) << "{\n  \"time_unit\": \"us\",\n  \"scenarios\": [";
+
+        for (size_t i = 0; i < arResults.size(); ++i)
+        {
+            const auto& r_result = arResults[i];
+            const auto& s = r_result.scenario;
+
+            out << (i ? ",\n" : "\n") << "    {\n"
+                << "      \"links\": " << s.links << ",\n"
+                << "      \"k\": " << s.k << ",\n"
+                << "      \"w\": " << s.w << ",\n";
+
+            if (!r_result.error.empty())
+            {
+                out << "      \"error_message\": \"" << r_result.error << "\"\n    }";
+                continue;
+            }
+
+            out << "      \"seconds\": " << r_result.seconds << ",\n"
+                << "      \"frames\": " << r_result.frames << ",\n"
+                << "      \"frames_per_second\": " << static_cast<double>(r_result.frames) / r_result.seconds << ",\n"
+                << "      \"cpu_seconds\": " << r_result.cpuSeconds << ",\n";
+            WriteHistogram(out, "latency", r_result.latency);
+            out << ",\n";
+            WriteHistogram(out, "ack_round_trip", r_result.ack);
+            out << "\n    }";
+        }
+
+        out << "\n  ]\n}\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        const auto options = ReadArguments(argc, argv);
+        std::vector<Result> results;
+
+        PrintHeader();
+
+        for (auto links : options.links)
+        {
+            for (auto [k, w] : options.windows)
+            {
+                Result result;
+                result.scenario = Scenario{links, k, w};
+
+                try
+                {
+                    if (!RaiseFileLimit(links))
+                        throw std::runtime_error("not enough file descriptors, raise the limit with ulimit -n");
+
+                    result = Loopback(result.scenario).Run(options.duration);
+                }
+                catch (const std::exception& e)
+                {
+                    result.error = e.what();
+                }
+
+                Print(result);
+                results.push_back(result);
+            }
+        }
+
+        if (!options.out.empty())
+            WriteJson(options.out, results);
+
+        return 0;
+    }
+    catch (std::exception& e) { std::cout << "An unhandled error occured: " << e.what() << std::endl; }
+    catch (...)               { std::cout << "An unhandled and unknown error occured" << std::endl; }
+    return -1;
+}
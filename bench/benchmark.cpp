@@ -0,0 +1,436 @@
+#include "bench/benchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <regex>
+#include <sstream>
+#include <thread>
+
+#include <boost/asio/ip/host_name.hpp>
+
+namespace BENCH
+{
+    namespace
+    {
+        struct Options
+        {
+            std::string filter = ".*";
+            std::string out;
+            double minTime = 0.5;
+            int repetitions = 1;
+            bool list = false;
+        };
+
+        struct Result
+        {
+            std::string name;
+            std::string runName;
+            std::string aggregate;
+            int repetitions = 1;
+            int repetitionIndex = 0;
+            uint64_t iterations = 0;
+            // Per iteration in nanoseconds
+            double realTime = 0.0;
+            double cpuTime = 0.0;
+            double itemsPerSecond = 0.0;
+            double bytesPerSecond = 0.0;
+            std::string label;
+            std::string error;
+        };
+
+        // Upper limit, if a benchmark is too fast to be measured at all
+        constexpr uint64_t MAX_ITERATIONS = 1000000000;
+
+        std::vector<std::unique_ptr<Benchmark>>& Registry()
+        {
+            static std::vector<std::unique_ptr<Benchmark>> registry;
+            return registry;
+        }
+
+        Options ReadArguments(int argc, char* argv[])
+        {
+            Options options;
+
+            for (int i = 1; i < argc; ++i)
+            {
+                const std::string arg(argv[i]);
+                const auto separator = arg.find('=');
+                const auto option = arg.substr(0, separator);
+                const auto value = separator == std::string::npos ? std::string() : arg.substr(separator + 1);
+
+                if (option == "--benchmark_filter")
+                    options.filter = value;
+                else if (option == "--benchmark_out")
+                    options.out = value;
+                else if (option == "--benchmark_min_time")
+                    options.minTime = std::stod(value);
+                else if (option == "--benchmark_repetitions")
+                    options.repetitions = std::max(std::stoi(value), 1);
+                else if (option == "--benchmark_list_tests")
+                    options.list = true;
+                else
+                    throw std::invalid_argument("unknown option " + arg);
+            }
+
+            return options;
+        }
+
+        std::string RunName(const Benchmark& arBenchmark, const std::vector<int64_t>& arArgs)
+        {
+            std::string name = arBenchmark.Name();
+            for (auto arg : arArgs)
+                name += "/" + std::to_string(arg);
+            return name;
+        }
+
+        // Measure with a growing number of iterations, until the run takes long enough
+        Result Measure(const Benchmark& arBenchmark, const std::vector<int64_t>& arArgs, double aMinTime)
+        {
+            uint64_t iterations = 1;
+
+            for (;;)
+            {
+                State state(iterations, arArgs);
+                arBenchmark.GetFunction()(state);
+
+                const double seconds = std::chrono::duration<double>(state.RealTime()).count();
+
+                if (!state.Error().empty() || seconds >= aMinTime || iterations >= MAX_ITERATIONS)
+                {
+                    Result result;
+                    result.iterations = iterations;
+                    result.realTime = seconds * 1e9 / static_cast<double>(iterations);
+                    result.cpuTime = state.CpuSeconds() * 1e9 / static_cast<double>(iterations);
+                    result.itemsPerSecond = seconds > 0 ? static_cast<double>(state.ItemsProcessed()) / seconds : 0.0;
+                    result.bytesPerSecond = seconds > 0 ? static_cast<double>(state.BytesProcessed()) / seconds : 0.0;
+                    result.label = state.Label();
+                    result.error = state.Error();
+                    return result;
+                }
+
+                // Aim a little above the minimum time, but grow by at most 10 times per step
+                const double multiplier = std::min(aMinTime * 1.4 / std::max(seconds, 1e-9), 10.0);
+                const auto next = static_cast<uint64_t>(static_cast<double>(iterations) * multiplier);
+                iterations = std::min(std::max(next, iterations + 1), MAX_ITERATIONS);
+            }
+        }
+
+        Result Aggregate(const std::vector<Result>& arRuns, const char* apName)
+        {
+            auto combine = [&](auto aField) {
+                std::vector<double> values;
+                for (const auto& r_run : arRuns)
+                    values.push_back(r_run.*aField);
+
+                const double mean = std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+
+                if (std::strcmp(apName, "mean") == 0)
+                    return mean;
+
+                if (std::strcmp(apName, "median") == 0)
+                {
+                    std::sort(values.begin(), values.end());
+                    const auto middle = values.size() / 2;
+                    return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+                }
+
+                double variance = 0.0;
+                for (auto value : values)
+                    variance += (value - mean) * (value - mean);
+                return values.size() > 1 ? std::sqrt(variance / static_cast<double>(values.size() - 1)) : 0.0;
+            };
+
+            Result result = arRuns.front();
+            result.name = result.runName + "_" + apName;
+            result.aggregate = apName;
+            result.repetitionIndex = 0;
+            result.realTime = combine(&Result::realTime);
+            result.cpuTime = combine(&Result::cpuTime);
+            result.itemsPerSecond = combine(&Result::itemsPerSecond);
+            result.bytesPerSecond = combine(&Result::bytesPerSecond);
+            return result;
+        }
+
+        std::string HumanRate(double aValue)
+        {
+            static const char* UNITS[] = { "", "k", "M", "G", "T" };
+            size_t unit = 0;
+
+            while (aValue >= 1000.0 && unit + 1 < std::size(UNITS))
+            {
+                aValue /= 1000.0;
+                ++unit;
+            }
+
+            std::ostringstream text;
+            text << std::fixed << std::setprecision(aValue < 10 ? 2 : 1) << aValue << UNITS[unit];
+            return text.str();
+        }
+
+        void PrintHeader()
+        {
+            std::cout << std::left << std::setw(56) << "Benchmark"
+                      << std::right << std::setw(14) << "Time" << std::setw(14) << "CPU"
+                      << std::setw(14) << "Iterations" << "  Rates\n"
+                      << std::string(112, '-') << std::endl;
+        }
+
+        void Print(const Result& arResult)
+        {
+            std::cout << std::left << std::setw(56) << arResult.name << std::right;
+
+            if (!arResult.error.empty())
+            {
+                std::cout << "  ERROR: " << arResult.error << std::endl;
+                return;
+            }
+
+            std::cout << std::fixed << std::setprecision(1)
+                      << std::setw(11) << arResult.realTime << " ns"
+                      << std::setw(11) << arResult.cpuTime << " ns"
+                      << std::setw(14) << arResult.iterations << "  ";
+
+            if (arResult.itemsPerSecond > 0)
+                std::cout << "items/s=" << HumanRate(arResult.itemsPerSecond) << " ";
+            if (arResult.bytesPerSecond > 0)
+                std::cout << "bytes/s=" << HumanRate(arResult.bytesPerSecond) << " ";
+
+            std::cout << arResult.label << std::endl;
+        }
+
+        std::string Escape(const std::string& arText)
+        {
+            std::string escaped;
+
+            for (char c : arText)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    escaped += '\\';
+                    escaped += c;
+                }
+                else if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char code[8];
+                    std::snprintf(code, sizeof(code), "\\u%04x", c);
+                    escaped += code;
+                }
+                else
+                {
+                    escaped += c;
+                }
+            }
+
+            return escaped;
+        }
+
+        std::string LocalDate()
+        {
+            const auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+            std::tm local{};
+#ifdef _WIN32
+            localtime_s(&local, &now);
+#else
+            localtime_r(&now, &local);
+#endif
+            std::ostringstream text;
+            text << std::put_time(&local, "%Y-%m-%dT%H:%M:%S%z");
+            return text.str();
+        }
+
+        void WriteJson(const std::string& arPath, const char* apExecutable, const std::vector<Result>& arResults)
+        {
+            std::ofstream out(arPath);
+            if (!out)
+                throw std::runtime_error("cannot open " + arPath);
+
+            out << std::setprecision(17);
+            out << "{\n"
+                << "  \"context\": {\n"
+                << "    \"date\": \"" << LocalDate() << "\",\n"
+                << "    \"host_name\": \"" << Escape(boost::asio::ip::host_name()) << "\",\n"
+                << "    \"executable\": \"" << Escape(apExecutable) << "\",\n"
+                << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef NDEBUG
+                << "    \"library_build_type\": \"release\"\n"
+#else
+                << "    \"library_build_type\": \"debug\"\n"
+#endif
+                << "  },\n"
+                << "  \"benchmarks\": [";
+
+            for (size_t i = 0; i < arResults.size(); ++i)
+            {
+                const auto& r_result = arResults[i];
+
+                out << (i ? ",\n" : "\n") << "    {\n"
+                    << "      \"name\": \"" << Escape(r_result.name) << "\",\n"
+                    << "      \"run_name\": \"" << Escape(r_result.runName) << "\",\n"
+                    << "      \"run_type\": \"" << (r_result.aggregate.empty() ? "iteration" : "aggregate") << "\",\n"
+                    << "      \"repetitions\": " << r_result.repetitions << ",\n"
+                    << "      \"repetition_index\": " << r_result.repetitionIndex << ",\n"
+                    << "      \"threads\": 1,\n";
+
+                if (!r_result.aggregate.empty())
+                    out << "      \"aggregate_name\": \"" << r_result.aggregate << "\",\n";
+
+                if (!r_result.error.empty())
+                {
+                    out << "      \"error_occurred\": true,\n"
+                        << "      \"error_message\": \"" << Escape(r_result.error) << "\"\n"
+                        << "    }";
+                    continue;
+                }
+
+                out << "      \"iterations\": " << r_result.iterations << ",\n"
+                    << "      \"real_time\": " << r_result.realTime << ",\n"
+                    << "      \"cpu_time\": " << r_result.cpuTime << ",\n"
+                    << "      \"time_unit\": \"ns\"";
+
+                if (r_result.itemsPerSecond > 0)
+                    out << ",\n      \"items_per_second\": " << r_result.itemsPerSecond;
+                if (r_result.bytesPerSecond > 0)
+                    out << ",\n      \"bytes_per_second\": " << r_result.bytesPerSecond;
+                if (!r_result.label.empty())
+                    out << ",\n      \"label\": \"" << Escape(r_result.label) << "\"";
+
+                out << "\n    }";
+            }
+
+            out << "\n  ]\n}\n";
+        }
+    }
+
+    void State::StartTiming() noexcept
+    {
+        mRunning = true;
+        mRealStart = std::chrono::steady_clock::now();
+        mCpuStart = std::clock();
+    }
+
+    void State::StopTiming() noexcept
+    {
+        if (!mRunning)
+            return;
+
+        mReal += std::chrono::steady_clock::now() - mRealStart;
+        mCpu += std::clock() - mCpuStart;
+        mRunning = false;
+    }
+
+    void State::PauseTiming() noexcept
+    {
+        StopTiming();
+    }
+
+    void State::ResumeTiming() noexcept
+    {
+        StartTiming();
+    }
+
+    Benchmark* Register(std::string aName, Function apFunction)
+    {
+        Registry().push_back(std::make_unique<Benchmark>(std::move(aName), apFunction));
+        return Registry().back().get();
+    }
+
+    int RunAll(int argc, char* argv[])
+    {
+        const auto options = ReadArguments(argc, argv);
+        const std::regex filter(options.filter);
+        std::vector<Result> results;
+        bool failed = false;
+
+        if (!options.list)
+            PrintHeader();
+
+        for (const auto& p_benchmark : Registry())
+        {
+            auto args = p_benchmark->GetArgs();
+            if (args.empty())
+                args.emplace_back();
+
+            for (const auto& r_args : args)
+            {
+                const auto run_name = RunName(*p_benchmark, r_args);
+                if (!std::regex_search(run_name, filter))
+                    continue;
+
+                if (options.list)
+                {
+                    std::cout << run_name << std::endl;
+                    continue;
+                }
+
+                const double min_time = p_benchmark->GetMinTime() > 0 ? p_benchmark->GetMinTime() : options.minTime;
+                std::vector<Result> runs;
+
+                for (int i = 0; i < options.repetitions; ++i)
+                {
+                    Result run;
+
+                    try
+                    {
+                        run = Measure(*p_benchmark, r_args, min_time);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        run.error = e.what();
+                    }
+
+                    run.name = run_name;
+                    run.runName = run_name;
+                    run.repetitions = options.repetitions;
+                    run.repetitionIndex = i;
+                    failed |= !run.error.empty();
+
+                    Print(run);
+                    results.push_back(run);
+                    runs.push_back(run);
+
+                    if (!run.error.empty())
+                        break;
+                }
+
+                if (runs.size() > 1)
+                {
+                    for (const char* p_aggregate : { "mean", "median", "stddev" })
+                    {
+                        results.push_back(Aggregate(runs, p_aggregate));
+                        Print(results.back());
+                    }
+                }
+            }
+        }
+
+        if (!options.out.empty())
+            WriteJson(options.out, argv[0], results);
+
+        return failed ? 1 : 0;
+    }
+
+    namespace Detail
+    {
+        void UseCharPointer(const volatile char*) noexcept
+        {
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        return BENCH::RunAll(argc, argv);
+    }
+    catch (std::exception& e) { std::cout << "An unhandled error occured: " << e.what() << std::endl; }
+    catch (...)               { std::cout << "An unhandled and unknown error occured" << std::endl; }
+    return -1;
+}
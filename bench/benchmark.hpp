@@ -0,0 +1,175 @@
+#ifndef BENCH_BENCHMARK_HPP_
+#define BENCH_BENCHMARK_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Minimal micro-benchmark harness in the style of Google Benchmark
+ *
+ * A benchmark is a function, which runs its measured code once per iteration of the state:
+ * @code
+ *   static void BM_Example(BENCH::State& state)
+ *   {
+ *       for (auto _ : state)
+ *           BENCH::DoNotOptimize(Work());
+ *   }
+ *   VRTU_BENCHMARK(BM_Example)->Arg(1)->Arg(8);
+ * @endcode
+ *
+ * The runner grows the number of iterations until a run takes at least the minimum time.
+ * Results are printed as table and optionally written as JSON, which uses the field names of
+ * Google Benchmark. Thus its tools (e.g. compare.py) can compare the results of two releases.
+ */
+namespace BENCH
+{
+    class State
+    {
+    public:
+        // Value of an iteration. Never used, the loop only counts.
+        struct [[maybe_unused]] Value {};
+
+        class Iterator
+        {
+        public:
+            explicit Iterator(State* apState, uint64_t aRemaining) noexcept
+                : mpState(apState), mRemaining(aRemaining) {}
+
+            Value operator*() const noexcept { return Value(); }
+            Iterator& operator++() noexcept { --mRemaining; return *this; }
+
+            bool operator!=(const Iterator&) noexcept
+            {
+                if (mRemaining != 0)
+                    return true;
+
+                mpState->StopTiming();
+                return false;
+            }
+
+        private:
+            State* mpState;
+            uint64_t mRemaining;
+        };
+
+        explicit State(uint64_t aIterations, std::vector<int64_t> aArgs) noexcept
+            : mIterations(aIterations), mArgs(std::move(aArgs)) {}
+
+        // The timer starts with the first iteration and stops after the last one
+        Iterator begin() noexcept { StartTiming(); return Iterator(this, mIterations); }
+        Iterator end() noexcept { return Iterator(this, 0); }
+
+        uint64_t Iterations() const noexcept { return mIterations; }
+        int64_t Range(size_t aIndex = 0) const { return mArgs.at(aIndex); }
+
+        // Exclude setup within an iteration from the measurement
+        void PauseTiming() noexcept;
+        void ResumeTiming() noexcept;
+
+        // Rates are reported per second of real time
+        void SetItemsProcessed(uint64_t aItems) noexcept { mItems = aItems; }
+        void SetBytesProcessed(uint64_t aBytes) noexcept { mBytes = aBytes; }
+        void SetLabel(std::string aLabel) { mLabel = std::move(aLabel); }
+        // Mark the run as failed. The benchmark should return afterwards.
+        void SkipWithError(std::string aMessage) { mError = std::move(aMessage); }
+
+        std::chrono::nanoseconds RealTime() const noexcept { return mReal; }
+        double CpuSeconds() const noexcept { return static_cast<double>(mCpu) / CLOCKS_PER_SEC; }
+        uint64_t ItemsProcessed() const noexcept { return mItems; }
+        uint64_t BytesProcessed() const noexcept { return mBytes; }
+        const std::string& Label() const noexcept { return mLabel; }
+        const std::string& Error() const noexcept { return mError; }
+
+    private:
+        void StartTiming() noexcept;
+        void StopTiming() noexcept;
+
+        uint64_t mIterations;
+        std::vector<int64_t> mArgs;
+
+        bool mRunning = false;
+        std::chrono::steady_clock::time_point mRealStart;
+        std::clock_t mCpuStart = 0;
+        std::chrono::nanoseconds mReal{0};
+        std::clock_t mCpu = 0;
+
+        uint64_t mItems = 0;
+        uint64_t mBytes = 0;
+        std::string mLabel;
+        std::string mError;
+    };
+
+    using Function = void (*)(State&);
+
+    class Benchmark
+    {
+    public:
+        explicit Benchmark(std::string aName, Function apFunction)
+            : mName(std::move(aName)), mpFunction(apFunction) {}
+
+        // Run the benchmark once for every argument. Range(0) returns it.
+        Benchmark* Arg(int64_t aArg) { mArgs.push_back({aArg}); return this; }
+        // Run the benchmark once for every set of arguments. Range(i) returns the i-th one.
+        Benchmark* Args(std::vector<int64_t> aArgs) { mArgs.push_back(std::move(aArgs)); return this; }
+        // Override the minimum time of the command line, e.g. for expensive setups
+        Benchmark* MinTime(double aSeconds) noexcept { mMinTime = aSeconds; return this; }
+
+        const std::string& Name() const noexcept { return mName; }
+        Function GetFunction() const noexcept { return mpFunction; }
+        const std::vector<std::vector<int64_t>>& GetArgs() const noexcept { return mArgs; }
+        double GetMinTime() const noexcept { return mMinTime; }
+
+    private:
+        std::string mName;
+        Function mpFunction;
+        std::vector<std::vector<int64_t>> mArgs;
+        double mMinTime = 0.0;
+    };
+
+    // Register a benchmark. The registry owns it until the program ends.
+    Benchmark* Register(std::string aName, Function apFunction);
+
+    // Run all registered benchmarks, which match the command line. Returns the exit code.
+    int RunAll(int argc, char* argv[]);
+
+    namespace Detail
+    {
+        void UseCharPointer(const volatile char* apValue) noexcept;
+    }
+
+    // Keep the compiler from removing the computation of a value
+    template <typename T>
+    inline void DoNotOptimize(const T& arValue) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(arValue) : "memory");
+#else
+        Detail::UseCharPointer(&reinterpret_cast<const volatile char&>(arValue));
+#endif
+    }
+
+    // Force all pending writes to memory
+    inline void ClobberMemory() noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : : "memory");
+#else
+        Detail::UseCharPointer(nullptr);
+#endif
+    }
+}
+
+#define VRTU_BENCH_CONCAT_(a, b) a##b
+#define VRTU_BENCH_CONCAT(a, b) VRTU_BENCH_CONCAT_(a, b)
+
+#define VRTU_BENCHMARK(function) \
+    [[maybe_unused]] static BENCH::Benchmark* VRTU_BENCH_CONCAT(gBenchmark, __LINE__) = BENCH::Register(#function, function)
+
+#define VRTU_BENCHMARK_TEMPLATE(function, type) \
+    [[maybe_unused]] static BENCH::Benchmark* VRTU_BENCH_CONCAT(gBenchmark, __LINE__) = BENCH::Register(#function "<" #type ">", function<type>)
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef CORE_ALLOCATOR_HPP_
+#define CORE_ALLOCATOR_HPP_
+
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace CORE
+{
+    /**
+     * @brief Allocator, which default-initializes elements instead of value-initializing them
+     *
+     * std::vector<uint8_t>(n) writes n zeros, which touches every page of the buffer.
+     * With this allocator the memory of trivial types stays uninitialized until it is written.
+     */
+    template <typename T, typename Base = std::allocator<T>>
+    class DefaultInitAllocator : public Base
+    {
+        using Traits = std::allocator_traits<Base>;
+
+    public:
+        template <typename U>
+        struct rebind
+        {
+            using other = DefaultInitAllocator<U, typename Traits::template rebind_alloc<U>>;
+        };
+
+        using Base::Base;
+
+        template <typename U>
+        void construct(U* apTarget) noexcept(std::is_nothrow_default_constructible_v<U>)
+        {
+            ::new (static_cast<void*>(apTarget)) U;
+        }
+
+        template <typename U, typename... Args>
+        void construct(U* apTarget, Args&&... args)
+        {
+            Traits::construct(static_cast<Base&>(*this), apTarget, std::forward<Args>(args)...);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef CORE_BUFFERPOOL_HPP_
+#define CORE_BUFFERPOOL_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "core/bytestream.hpp"
+
+namespace CORE
+{
+    /**
+     * @brief Pool of equally sized byte streams, which are lent out only while they hold data
+     *
+     * Connections borrow a buffer for a pending read or an encode and give it back, once it is drained.
+     * Idle connections therefore do not hold any buffer memory.
+     *
+     * The pool is not synchronized. Use one pool per executor.
+     * It must outlive all of its leases.
+     */
+    class BufferPool
+    {
+    public:
+        // Borrowed buffer, which returns to its pool on destruction
+        class Lease
+        {
+        public:
+            Lease() noexcept = default;
+            ~Lease() noexcept { Release(); }
+
+            Lease(Lease&& arOther) noexcept
+                : mpPool(std::exchange(arOther.mpPool, nullptr)), mBuffer(std::move(arOther.mBuffer)) {}
+
+            Lease& operator=(Lease&& arOther) noexcept
+            {
+                if (this != &arOther)
+                {
+                    Release();
+                    mpPool = std::exchange(arOther.mpPool, nullptr);
+                    mBuffer = std::move(arOther.mBuffer);
+                }
+                return *this;
+            }
+
+            Lease(const Lease&)            = delete;
+            Lease& operator=(const Lease&) = delete;
+
+            explicit operator bool() const noexcept { return mBuffer != nullptr; }
+            ByteStream& operator*() const noexcept { return *mBuffer; }
+            ByteStream* operator->() const noexcept { return mBuffer.get(); }
+
+            // Give the buffer back to the pool early
+            void Release() noexcept
+            {
+                if (mBuffer)
+                    mpPool->GiveBack(std::move(mBuffer));
+                mpPool = nullptr;
+            }
+
+        private:
+            friend class BufferPool;
+
+            Lease(BufferPool& arPool, std::unique_ptr<ByteStream> apBuffer) noexcept
+                : mpPool(&arPool), mBuffer(std::move(apBuffer)) {}
+
+            BufferPool* mpPool = nullptr;
+            std::unique_ptr<ByteStream> mBuffer;
+        };
+
+        /**
+         * @param aBufferSize Capacity of each buffer
+         * @param aMaxIdle Number of returned buffers, which are kept for reuse. Further buffers are released.
+         */
+        explicit BufferPool(size_t aBufferSize, size_t aMaxIdle = 1024)
+            : mBufferSize(aBufferSize), mMaxIdle(aMaxIdle) {}
+
+        BufferPool(const BufferPool&)            = delete;
+        BufferPool& operator=(const BufferPool&) = delete;
+
+        // Borrow an empty buffer
+        Lease Borrow()
+        {
+            ++mLent;
+
+            if (mIdle.empty())
+                return Lease(*this, std::make_unique<ByteStream>(mBufferSize));
+
+            auto buffer = std::move(mIdle.back());
+            mIdle.pop_back();
+            return Lease(*this, std::move(buffer));
+        }
+
+        size_t BufferSize() const noexcept { return mBufferSize; }
+        // Number of buffers, which are ready for reuse
+        size_t Idle() const noexcept { return mIdle.size(); }
+        // Number of buffers, which are currently borrowed
+        size_t Lent() const noexcept { return mLent; }
+
+    private:
+        void GiveBack(std::unique_ptr<ByteStream> apBuffer) noexcept
+        {
+            --mLent;
+            apBuffer->Clear();
+
+            if (mIdle.size() < mMaxIdle)
+            {
+                try
+                {
+                    mIdle.push_back(std::move(apBuffer));
+                }
+                catch (...) {} // released instead
+            }
+        }
+
+    private:
+        size_t mBufferSize;
+        size_t mMaxIdle;
+        size_t mLent = 0;
+        std::vector<std::unique_ptr<ByteStream>> mIdle;
+    };
+}
+
+#endif
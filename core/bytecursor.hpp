@@ -0,0 +1,96 @@
+#ifndef CORE_BYTECURSOR_HPP_
+#define CORE_BYTECURSOR_HPP_
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace CORE
+{
+    // Load an integer or floating point value, which is encoded little-endian
+    template <typename T>
+    T LoadLE(const uint8_t* apSource) noexcept
+    {
+        static_assert(std::is_arithmetic_v<T>, "only integers and floating point values can be loaded");
+
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            using Bits = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+            return std::bit_cast<T>(LoadLE<Bits>(apSource));
+        }
+        else
+        {
+            // The fixed-size loop is reduced to a single load on little-endian targets
+            std::make_unsigned_t<T> result = 0;
+            for (size_t i = 0; i < sizeof(T); ++i)
+                result |= static_cast<std::make_unsigned_t<T>>(apSource[i]) << (8 * i);
+            return static_cast<T>(result);
+        }
+    }
+
+    // Load an integer, which is encoded big-endian (network byte order)
+    template <typename T>
+    T LoadBE(const uint8_t* apSource) noexcept
+    {
+        static_assert(std::is_integral_v<T>, "only integers can be loaded big-endian");
+
+        std::make_unsigned_t<T> result = 0;
+        for (size_t i = 0; i < sizeof(T); ++i)
+            result = static_cast<std::make_unsigned_t<T>>((result << 8) | apSource[i]);
+        return static_cast<T>(result);
+    }
+
+    // Store an integer little-endian
+    template <typename T>
+    void StoreLE(uint8_t* apDest, T aValue) noexcept
+    {
+        static_assert(std::is_integral_v<T>, "only integers can be stored");
+
+        auto bits = static_cast<std::make_unsigned_t<T>>(aValue);
+        for (size_t i = 0; i < sizeof(T); ++i)
+            apDest[i] = static_cast<uint8_t>(bits >> (8 * i));
+    }
+
+    /**
+     * @brief Unchecked reader for memory, which was validated before
+     *
+     * A cursor is handed out for a range, whose size has already been checked as a whole
+     * (e.g. by ByteStream::ReadCursor). Its reads do not check any bounds and never throw.
+     * Reading beyond the range is undefined behavior.
+     */
+    class ByteCursor
+    {
+    public:
+        constexpr ByteCursor(const uint8_t* apBegin, size_t aSize) noexcept
+            : mpPos(apBegin), mpEnd(apBegin + aSize) {}
+
+        const uint8_t* Position() const noexcept { return mpPos; }
+        size_t RemainingBytes() const noexcept { return static_cast<size_t>(mpEnd - mpPos); }
+
+        uint8_t ReadByte() noexcept { return *mpPos++; }
+
+        template <typename T>
+        T ReadLE() noexcept
+        {
+            T result = LoadLE<T>(mpPos);
+            mpPos += sizeof(T);
+            return result;
+        }
+
+        const uint8_t* ReadData(size_t aBytes) noexcept
+        {
+            const uint8_t* p_result = mpPos;
+            mpPos += aBytes;
+            return p_result;
+        }
+
+        void Skip(size_t aBytes) noexcept { mpPos += aBytes; }
+
+    private:
+        const uint8_t* mpPos;
+        const uint8_t* mpEnd;
+    };
+}
+
+#endif
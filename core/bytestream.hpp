@@ -2,19 +2,23 @@
 #define BYTESTREAM_HPP_
 
 #include <cstdint>
+#include <cstring>
 #include <stdexcept>
 #include <vector>
 
+#include "core/allocator.hpp"
+#include "core/bytecursor.hpp"
+
 class ByteStream
 {
 public:
     // initialize a bytestream with default capacity but no data
     explicit ByteStream() noexcept
-        : mBuffer(1024, 0), mBegin(0), mEnd(0) {}
+        : mBuffer(1024), mBegin(0), mEnd(0) {}
 
-    // initialize a bytestream with capacity but no data
+    // initialize a bytestream with capacity but no data. The capacity is not initialized.
     explicit ByteStream(size_t capacity) noexcept
-        : mBuffer(capacity, 0), mBegin(0), mEnd(0) {}
+        : mBuffer(capacity), mBegin(0), mEnd(0) {}
 
 
     // initialize the bytestream with available data
@@ -96,6 +100,7 @@ public:
         return mBuffer.data() + mEnd;
     }
 
+    // Move the remaining data to the start of the buffer
     void Flush() noexcept
     {
         if (mBegin < mEnd)
@@ -105,6 +110,33 @@ public:
         mBegin = 0;
     }
 
+    /*
+     * @brief Make room for further writes, while moving as little data as possible
+     *
+     * Consumed data is released for free, if nothing remains.
+     * Remaining data is only moved to the start, if less than aMinWritable bytes are left behind it.
+     * Thus a partial frame at the end of a large buffer is usually left in place.
+     */
+    void Reclaim(size_t aMinWritable) noexcept
+    {
+        if (mBegin == mEnd)
+        {
+            mBegin = 0;
+            mEnd = 0;
+        }
+        else if (WritableBytes() < aMinWritable)
+        {
+            Flush();
+        }
+    }
+
+    // Discard all data
+    inline void Clear() noexcept
+    {
+        mBegin = 0;
+        mEnd = 0;
+    }
+
     inline size_t RemainingBytes() const noexcept
     {
         return mEnd - mBegin;
@@ -159,6 +191,12 @@ public:
         return p_result;
     }
 
+    // Read aBytes with a single bound-check. The returned cursor reads them without further checks.
+    CORE::ByteCursor ReadCursor(size_t aBytes)
+    {
+        return CORE::ByteCursor(ReadData(aBytes), aBytes);
+    }
+
     void WriteData(const void* apData, size_t aBytes)
     {
         if (apData && aBytes > 0)
@@ -177,7 +215,8 @@ public:
     }
 
 private:
-    std::vector<uint8_t> mBuffer;
+    // Capacity is not value-initialized, bytes are only touched when written
+    std::vector<uint8_t, CORE::DefaultInitAllocator<uint8_t>> mBuffer;
     size_t mBegin = 0;
     size_t mEnd = 0;
 };
@@ -0,0 +1,128 @@
+#ifndef CORE_DELEGATE_HPP_
+#define CORE_DELEGATE_HPP_
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace CORE
+{
+    template <typename SIGNATURE, size_t CAPACITY = 4 * sizeof(void*)>
+    class Delegate;
+
+    /**
+     * @brief Callable of a fixed capacity, which never allocates
+     *
+     * The callable is stored inside the delegate. A callable, which does not fit, fails to compile.
+     * Lambdas capturing a few pointers, like [this] or [this, &arOther], always fit.
+     *
+     * Trivially copyable callables are moved as bytes and need no destruction.
+     * A call is a single indirect call, into which the callable is inlined.
+     */
+    template <typename R, typename... Args, size_t CAPACITY>
+    class Delegate<R(Args...), CAPACITY>
+    {
+    public:
+        Delegate() noexcept = default;
+
+        template <typename CALLABLE,
+                  typename = std::enable_if_t<!std::is_same_v<std::decay_t<CALLABLE>, Delegate>>>
+        Delegate(CALLABLE&& aCallable) noexcept(std::is_nothrow_constructible_v<std::decay_t<CALLABLE>, CALLABLE&&>)
+        {
+            using T = std::decay_t<CALLABLE>;
+
+            static_assert(std::is_invocable_r_v<R, T&, Args...>, "callable does not match the signature of the delegate");
+            static_assert(sizeof(T) <= CAPACITY, "callable exceeds the capacity of the delegate");
+            static_assert(alignof(T) <= alignof(std::max_align_t), "callable is over-aligned");
+            static_assert(std::is_nothrow_move_constructible_v<T>, "callable must be nothrow move constructible");
+
+            ::new (static_cast<void*>(mStorage)) T(std::forward<CALLABLE>(aCallable));
+            mInvoke = &Invoke<T>;
+
+            if constexpr (!std::is_trivially_copyable_v<T>)
+                mManage = &Manage<T>;
+        }
+
+        ~Delegate() noexcept { Reset(); }
+
+        Delegate(Delegate&& arOther) noexcept { MoveFrom(arOther); }
+
+        Delegate& operator=(Delegate&& arOther) noexcept
+        {
+            if (this != &arOther)
+            {
+                Reset();
+                MoveFrom(arOther);
+            }
+            return *this;
+        }
+
+        Delegate(const Delegate&)            = delete;
+        Delegate& operator=(const Delegate&) = delete;
+
+        R operator()(Args... args) const
+        {
+            return mInvoke(const_cast<unsigned char*>(mStorage), std::forward<Args>(args)...);
+        }
+
+        explicit operator bool() const noexcept { return mInvoke != nullptr; }
+
+        void Reset() noexcept
+        {
+            if (mManage)
+                mManage(Operation::DESTROY, mStorage, nullptr);
+
+            mInvoke = nullptr;
+            mManage = nullptr;
+        }
+
+    private:
+        enum class Operation
+        {
+            MOVE,
+            DESTROY
+        };
+
+        template <typename T>
+        static R Invoke(void* apStorage, Args... args)
+        {
+            return (*static_cast<T*>(apStorage))(std::forward<Args>(args)...);
+        }
+
+        template <typename T>
+        static void Manage(Operation aOperation, void* apStorage, void* apSource) noexcept
+        {
+            if (aOperation == Operation::MOVE)
+            {
+                auto& source = *static_cast<T*>(apSource);
+                ::new (apStorage) T(std::move(source));
+                source.~T();
+            }
+            else
+            {
+                static_cast<T*>(apStorage)->~T();
+            }
+        }
+
+        void MoveFrom(Delegate& arOther) noexcept
+        {
+            if (arOther.mManage)
+                arOther.mManage(Operation::MOVE, mStorage, arOther.mStorage);
+            else if (arOther.mInvoke)
+                std::memcpy(mStorage, arOther.mStorage, CAPACITY);
+
+            mInvoke = std::exchange(arOther.mInvoke, nullptr);
+            mManage = std::exchange(arOther.mManage, nullptr);
+        }
+
+    private:
+        alignas(std::max_align_t) unsigned char mStorage[CAPACITY];
+        R (*mInvoke)(void*, Args...) = nullptr;
+        // Only set for callables, which are not trivially copyable
+        void (*mManage)(Operation, void*, void*) noexcept = nullptr;
+    };
+}
+
+#endif
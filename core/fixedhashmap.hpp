@@ -0,0 +1,136 @@
+#ifndef CORE_FIXEDHASHMAP_HPP_
+#define CORE_FIXEDHASHMAP_HPP_
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace CORE
+{
+    /**
+     * @brief Hash map of integer keys with a fixed capacity
+     *
+     * All memory is allocated by the constructor. Entries are stored inline with linear probing.
+     * Erasing shifts the following entries back, so lookups never have to skip tombstones.
+     *
+     * @tparam KEY Unsigned integer
+     * @tparam VALUE Trivially copyable value
+     */
+    template <typename KEY, typename VALUE>
+    class FixedHashMap
+    {
+        static_assert(std::is_unsigned_v<KEY>, "keys must be unsigned integers");
+        static_assert(std::is_trivially_copyable_v<VALUE>, "values must be trivially copyable");
+
+    public:
+        // The table is kept at most half full
+        explicit FixedHashMap(size_t aCapacity)
+            : mCapacity(aCapacity)
+            , mSlots(std::bit_ceil(aCapacity * 2 + 1))
+            , mMask(mSlots.size() - 1)
+        {
+        }
+
+        VALUE* Find(KEY aKey) noexcept
+        {
+            for (size_t i = Home(aKey); mSlots[i].used; i = (i + 1) & mMask)
+            {
+                if (mSlots[i].key == aKey)
+                    return &mSlots[i].value;
+            }
+            return nullptr;
+        }
+
+        const VALUE* Find(KEY aKey) const noexcept
+        {
+            return const_cast<FixedHashMap&>(*this).Find(aKey);
+        }
+
+        // Insert or overwrite. false, if the key is new and the map is full.
+        bool Insert(KEY aKey, const VALUE& arValue) noexcept
+        {
+            size_t i = Home(aKey);
+
+            for (; mSlots[i].used; i = (i + 1) & mMask)
+            {
+                if (mSlots[i].key == aKey)
+                {
+                    mSlots[i].value = arValue;
+                    return true;
+                }
+            }
+
+            if (mSize == mCapacity)
+                return false;
+
+            mSlots[i] = Slot{aKey, arValue, true};
+            ++mSize;
+            return true;
+        }
+
+        bool Erase(KEY aKey) noexcept
+        {
+            size_t i = Home(aKey);
+
+            for (; mSlots[i].used; i = (i + 1) & mMask)
+            {
+                if (mSlots[i].key == aKey)
+                    break;
+            }
+
+            if (!mSlots[i].used)
+                return false;
+
+            // Move back entries, which would not be found behind the gap
+            for (size_t next = (i + 1) & mMask; mSlots[next].used; next = (next + 1) & mMask)
+            {
+                const size_t home = Home(mSlots[next].key);
+
+                // The entry stays, if its home lies cyclically within (i, next]
+                if (i <= next ? (i < home && home <= next) : (i < home || home <= next))
+                    continue;
+
+                mSlots[i] = mSlots[next];
+                i = next;
+            }
+
+            mSlots[i].used = false;
+            --mSize;
+            return true;
+        }
+
+        void Clear() noexcept
+        {
+            for (auto& slot : mSlots)
+                slot.used = false;
+            mSize = 0;
+        }
+
+        size_t Size() const noexcept { return mSize; }
+        size_t Capacity() const noexcept { return mCapacity; }
+
+    private:
+        struct Slot
+        {
+            KEY key = 0;
+            VALUE value{};
+            bool used = false;
+        };
+
+        size_t Home(KEY aKey) const noexcept
+        {
+            // Fibonacci hashing spreads consecutive keys, e.g. IOAs
+            return static_cast<size_t>((static_cast<uint64_t>(aKey) * 0x9E3779B97F4A7C15ull) >> 32) & mMask;
+        }
+
+    private:
+        size_t mCapacity;
+        size_t mSize = 0;
+        std::vector<Slot> mSlots;
+        size_t mMask;
+    };
+}
+
+#endif
@@ -0,0 +1,245 @@
+#ifndef CORE_METRICS_HPP_
+#define CORE_METRICS_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/**
+ * Lock-free metrics, which are written on the hot path and read from any other thread.
+ *
+ * All operations are relaxed: a reader sees every value eventually, but not necessarily
+ * a consistent state of several values at once. Metrics, which are only updated by the thread
+ * that owns them, use the single writer variants.
+ */
+namespace CORE
+{
+    // Size of a cache line on all supported targets
+    inline constexpr size_t CACHE_LINE = 64;
+
+    // Threads, which may update a metric
+    enum class Writers
+    {
+        // Updated by a single thread with a plain load and store. Cheaper than a locked read-modify-write.
+        SINGLE,
+        // Updated by any thread with an atomic read-modify-write
+        MANY
+    };
+
+    namespace Detail
+    {
+        template <Writers WRITERS>
+        void Add(std::atomic<uint64_t>& arValue, uint64_t aValue) noexcept
+        {
+            if constexpr (WRITERS == Writers::SINGLE)
+                arValue.store(arValue.load(std::memory_order_relaxed) + aValue, std::memory_order_relaxed);
+            else
+                arValue.fetch_add(aValue, std::memory_order_relaxed);
+        }
+    }
+
+    // Monotonic counter
+    template <Writers WRITERS>
+    class BasicCounter
+    {
+    public:
+        void Add(uint64_t aValue = 1) noexcept { Detail::Add<WRITERS>(mValue, aValue); }
+        uint64_t Load() const noexcept { return mValue.load(std::memory_order_relaxed); }
+        // Start over. Not atomic with respect to concurrent updates.
+        void Reset() noexcept { mValue.store(0, std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint64_t> mValue{0};
+    };
+
+    using Counter             = BasicCounter<Writers::MANY>;
+    using SingleWriterCounter = BasicCounter<Writers::SINGLE>;
+
+    // Value, which may go up and down
+    class Gauge
+    {
+    public:
+        void Add(int64_t aValue) noexcept { mValue.fetch_add(aValue, std::memory_order_relaxed); }
+        void Set(int64_t aValue) noexcept { mValue.store(aValue, std::memory_order_relaxed); }
+        int64_t Load() const noexcept { return mValue.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<int64_t> mValue{0};
+    };
+
+    /**
+     * @brief Distribution of values in power of 2 buckets
+     *
+     * Bucket 0 counts the value 0, bucket i the values in [2^(i-1), 2^i).
+     * The last bucket also counts all larger values.
+     */
+    class HistogramBuckets
+    {
+    public:
+        static constexpr size_t BUCKETS = 48;
+
+        // Values read at once. Used to sum up several histograms and to compute quantiles.
+        struct Snapshot
+        {
+            std::array<uint64_t, BUCKETS> buckets{};
+            uint64_t count = 0;
+            uint64_t sum = 0;
+            // Largest recorded value
+            uint64_t max = 0;
+
+            // Upper bound of the bucket, which holds the quantile (0.0 - 1.0)
+            uint64_t Quantile(double aQuantile) const noexcept
+            {
+                const auto rank = static_cast<uint64_t>(std::ceil(aQuantile * static_cast<double>(count)));
+                uint64_t seen = 0;
+
+                for (size_t i = 0; i < BUCKETS; ++i)
+                {
+                    seen += buckets[i];
+                    if (seen >= rank && seen > 0)
+                        return UpperBound(i);
+                }
+
+                return 0;
+            }
+
+            Snapshot& operator+=(const Snapshot& arOther) noexcept
+            {
+                for (size_t i = 0; i < BUCKETS; ++i)
+                    buckets[i] += arOther.buckets[i];
+                count += arOther.count;
+                sum += arOther.sum;
+                max = std::max(max, arOther.max);
+                return *this;
+            }
+        };
+
+        static constexpr size_t BucketOf(uint64_t aValue) noexcept
+        {
+            const auto bucket = static_cast<size_t>(std::bit_width(aValue));
+            return bucket < BUCKETS ? bucket : BUCKETS - 1;
+        }
+
+        // Largest value of a bucket
+        static constexpr uint64_t UpperBound(size_t aBucket) noexcept
+        {
+            return aBucket == 0 ? 0 : (uint64_t(1) << aBucket) - 1;
+        }
+    };
+
+    // Histogram, which is recorded and read without locks
+    template <Writers WRITERS>
+    class BasicHistogram : public HistogramBuckets
+    {
+    public:
+        void Record(uint64_t aValue) noexcept
+        {
+            Detail::Add<WRITERS>(mBuckets[BucketOf(aValue)], 1);
+            Detail::Add<WRITERS>(mCount, 1);
+            Detail::Add<WRITERS>(mSum, aValue);
+            RaiseMax(aValue);
+        }
+
+        // Add all values of another histogram
+        void Add(const Snapshot& arOther) noexcept
+        {
+            for (size_t i = 0; i < BUCKETS; ++i)
+                Detail::Add<WRITERS>(mBuckets[i], arOther.buckets[i]);
+            Detail::Add<WRITERS>(mCount, arOther.count);
+            Detail::Add<WRITERS>(mSum, arOther.sum);
+            RaiseMax(arOther.max);
+        }
+
+        // Start over. Not atomic with respect to concurrent updates.
+        void Reset() noexcept
+        {
+            for (auto& bucket : mBuckets)
+                bucket.store(0, std::memory_order_relaxed);
+            mCount.store(0, std::memory_order_relaxed);
+            mSum.store(0, std::memory_order_relaxed);
+            mMax.store(0, std::memory_order_relaxed);
+        }
+
+        uint64_t Count() const noexcept { return mCount.load(std::memory_order_relaxed); }
+        uint64_t Sum() const noexcept { return mSum.load(std::memory_order_relaxed); }
+
+        Snapshot Read() const noexcept
+        {
+            Snapshot result;
+            for (size_t i = 0; i < BUCKETS; ++i)
+                result.buckets[i] = mBuckets[i].load(std::memory_order_relaxed);
+            result.count = Count();
+            result.sum = Sum();
+            result.max = mMax.load(std::memory_order_relaxed);
+            return result;
+        }
+
+    private:
+        void RaiseMax(uint64_t aValue) noexcept
+        {
+            auto max = mMax.load(std::memory_order_relaxed);
+            if constexpr (WRITERS == Writers::SINGLE)
+            {
+                if (aValue > max)
+                    mMax.store(aValue, std::memory_order_relaxed);
+            }
+            else
+            {
+                while (aValue > max && !mMax.compare_exchange_weak(max, aValue, std::memory_order_relaxed)) {}
+            }
+        }
+
+    private:
+        std::array<std::atomic<uint64_t>, BUCKETS> mBuckets{};
+        std::atomic<uint64_t> mCount{0};
+        std::atomic<uint64_t> mSum{0};
+        std::atomic<uint64_t> mMax{0};
+    };
+
+    using Histogram             = BasicHistogram<Writers::MANY>;
+    using SingleWriterHistogram = BasicHistogram<Writers::SINGLE>;
+
+    /**
+     * @brief Metric on a cache line of its own
+     *
+     * Use it for metrics, which are written by several threads. Metrics, which are only written
+     * by a single thread, can share their lines. Pad the whole group of them instead.
+     */
+    template <typename METRIC>
+    struct alignas(CACHE_LINE) Padded : METRIC
+    {
+    };
+
+    /**
+     * @brief Measure the elapsed time of a scope
+     *
+     * @tparam RECORD Callable, which receives the elapsed time as std::chrono::nanoseconds
+     */
+    template <typename RECORD>
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(RECORD aRecord) noexcept
+            : mRecord(std::move(aRecord)), mStart(std::chrono::steady_clock::now()) {}
+
+        ~ScopedTimer() noexcept
+        {
+            mRecord(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mStart));
+        }
+
+        ScopedTimer(const ScopedTimer&)            = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        RECORD mRecord;
+        std::chrono::steady_clock::time_point mStart;
+    };
+}
+
+#endif
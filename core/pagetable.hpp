@@ -0,0 +1,135 @@
+#ifndef CORE_PAGETABLE_HPP_
+#define CORE_PAGETABLE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+namespace CORE
+{
+    /**
+     * @brief Sparse array over a fixed index range, which is directly indexed in two levels
+     *
+     * The index is split into a directory entry and an offset within a page. Pages are allocated on first
+     * access and are never released before the table, so element addresses stay stable.
+     *
+     * Find() is wait-free and may run concurrently to Get() from any thread. Concurrent allocations of the
+     * same page are resolved with a compare-exchange. Access to the elements themselves is not synchronized,
+     * so T is usually an atomic.
+     *
+     * @tparam T Element type, value-initialized on allocation
+     * @tparam INDEX_BITS Number of bits of the index
+     * @tparam PAGE_BITS Number of bits, which select the element within a page
+     */
+    template <typename T, unsigned INDEX_BITS, unsigned PAGE_BITS>
+    class PageTable
+    {
+        static_assert(PAGE_BITS <= INDEX_BITS, "a page cannot exceed the index range");
+
+    public:
+        static constexpr size_t PAGE_SIZE  = size_t(1) << PAGE_BITS;
+        static constexpr size_t PAGE_COUNT = size_t(1) << (INDEX_BITS - PAGE_BITS);
+        static constexpr size_t MAX_SIZE   = size_t(1) << INDEX_BITS;
+
+        PageTable()
+            : mDirectory(std::make_unique<std::atomic<T*>[]>(PAGE_COUNT)) {}
+
+        ~PageTable() noexcept
+        {
+            for (size_t i = 0; i < PAGE_COUNT; ++i)
+                delete[] mDirectory[i].load(std::memory_order_relaxed);
+        }
+
+        PageTable(const PageTable&)            = delete;
+        PageTable& operator=(const PageTable&) = delete;
+
+        // Element at aIndex. nullptr, if its page was not allocated yet or the index is out of range.
+        T* Find(size_t aIndex) const noexcept
+        {
+            if (aIndex >= MAX_SIZE)
+                return nullptr;
+
+            T* p_page = mDirectory[aIndex >> PAGE_BITS].load(std::memory_order_acquire);
+            return p_page ? p_page + (aIndex & (PAGE_SIZE - 1)) : nullptr;
+        }
+
+        // Element at aIndex. Allocates its page, if required.
+        T& Get(size_t aIndex)
+        {
+            if (aIndex >= MAX_SIZE)
+                throw std::out_of_range("index exceeds the range of the page table");
+
+            auto& entry = mDirectory[aIndex >> PAGE_BITS];
+            T* p_page = entry.load(std::memory_order_acquire);
+
+            if (!p_page)
+            {
+                auto p_new = std::make_unique<T[]>(PAGE_SIZE);
+
+                // Another thread may have won the race. Its page is used instead.
+                if (entry.compare_exchange_strong(p_page, p_new.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+                {
+                    p_page = p_new.release();
+                    mPages.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            return p_page[aIndex & (PAGE_SIZE - 1)];
+        }
+
+        // Visit the elements of all allocated pages in ascending order as aVisitor(size_t index, T&)
+        template <typename Visitor>
+        void ForEach(Visitor&& aVisitor) const
+        {
+            for (size_t page = 0; page < PAGE_COUNT; ++page)
+            {
+                T* p_page = mDirectory[page].load(std::memory_order_acquire);
+
+                if (!p_page)
+                    continue;
+
+                for (size_t i = 0; i < PAGE_SIZE; ++i)
+                    aVisitor((page << PAGE_BITS) | i, p_page[i]);
+            }
+        }
+
+        /**
+         * @brief Visit the elements of all allocated pages from aFirst on in ascending order
+         *
+         * aVisitor(size_t index, T&) returns false to stop the scan.
+         * @return false, if the visitor stopped the scan
+         */
+        template <typename Visitor>
+        bool Scan(size_t aFirst, Visitor&& aVisitor) const
+        {
+            for (size_t page = aFirst >> PAGE_BITS; page < PAGE_COUNT; ++page)
+            {
+                T* p_page = mDirectory[page].load(std::memory_order_acquire);
+
+                if (!p_page)
+                    continue;
+
+                const size_t first = (page == (aFirst >> PAGE_BITS)) ? (aFirst & (PAGE_SIZE - 1)) : 0;
+
+                for (size_t i = first; i < PAGE_SIZE; ++i)
+                {
+                    if (!aVisitor((page << PAGE_BITS) | i, p_page[i]))
+                        return false;
+                }
+            }
+
+            return true;
+        }
+
+        // Number of allocated pages
+        size_t Pages() const noexcept { return mPages.load(std::memory_order_relaxed); }
+
+    private:
+        std::unique_ptr<std::atomic<T*>[]> mDirectory;
+        std::atomic<size_t> mPages{0};
+    };
+}
+
+#endif
@@ -1,31 +1,89 @@
 #ifndef CORE_SIGNAL_HPP_
 #define CORE_SIGNAL_HPP_
 
-#include <functional>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
+#include "core/delegate.hpp"
+#include "core/spscring.hpp"
+
 namespace CORE
 {
-    // Signal which calls every callee and disgregards the return type
+    // Counts a call of a signal, also if a callee throws
+    class CallGuard
+    {
+    public:
+        explicit CallGuard(unsigned& arDepth) noexcept : mrDepth(arDepth) { ++mrDepth; }
+        ~CallGuard() noexcept { --mrDepth; }
+
+        CallGuard(const CallGuard&)            = delete;
+        CallGuard& operator=(const CallGuard&) = delete;
+
+    private:
+        unsigned& mrDepth;
+    };
+
+    /**
+     * @brief Signal which calls every callee and disgregards the return type
+     *
+     * Callees are called inline by the thread, which invokes the signal. They are stored as delegates,
+     * so neither registering a lambda with a few captures nor calling it allocates.
+     *
+     * A slow subscriber registers asynchronously instead. Each call is then turned into a message,
+     * which is published into a ring of the subscriber and handled on its own thread.
+     *
+     * No lock is held during a call, so callees may invoke the signal again, e.g. by closing the link,
+     * which they are called for. They must not register on the signal, which is calling them.
+     */
     template <typename ReturnType, typename... Args>
     class SignalEveryone
     {
     public:
+        using Callee = Delegate<ReturnType(Args...)>;
+
         explicit SignalEveryone() noexcept {}
 
-        void Register(const std::function<ReturnType(Args...)>& arCalleeFunction)
+        // Throws std::logic_error, if the signal is calling its callees right now
+        template <typename CALLEE>
+        void Register(CALLEE&& arCalleeFunction)
+        {
+            if (mCalling > 0)
+                throw std::logic_error("Callees must not register on the signal, which is calling them");
+
+            mCallees.emplace_back(std::forward<CALLEE>(arCalleeFunction));
+        }
+
+        /**
+         * @brief Publish every call into the ring of a subscriber, which outlives the signal
+         *
+         * The ring is the single producer side of its subscriber. The signal must not be invoked
+         * concurrently, e.g. it is invoked by a single thread or serialized by a lock.
+         * Calls are dropped, while the ring is full. The subscriber polls it with TryPop or Drain.
+         *
+         * @param aConvert Turns the arguments into the message. References are only valid during the call.
+         */
+        template <typename MESSAGE, typename CONVERT>
+        void RegisterAsync(SpscRing<MESSAGE>& arRing, CONVERT aConvert)
         {
-            mCallees.push_back(arCalleeFunction);
+            Register([&arRing, convert = std::move(aConvert)](Args... args) {
+                arRing.TryPush(convert(std::forward<Args>(args)...));
+            });
         }
 
         void operator()(Args... args) const
         {
+            CallGuard guard(mCalling);
             for (const auto& Call : mCallees)
                 Call(args...);
         }
 
+        bool Empty() const noexcept { return mCallees.empty(); }
+
     private:
-        std::vector<std::function<ReturnType(Args...)>> mCallees;
+        std::vector<Callee> mCallees;
+        // Depth of nested calls. Registering would move the callees, while they are running.
+        mutable unsigned mCalling = 0;
     };
 
     /// Special case for functions without parameters
@@ -33,21 +91,40 @@ namespace CORE
     class SignalEveryone<ReturnType, void>
     {
     public:
+        using Callee = Delegate<ReturnType()>;
+
         explicit SignalEveryone() noexcept {}
 
-        void Register(const std::function<ReturnType()>& arCalleeFunction)
+        // See SignalEveryone::Register
+        template <typename CALLEE>
+        void Register(CALLEE&& arCalleeFunction)
         {
-            mCallees.push_back(arCalleeFunction);
+            if (mCalling > 0)
+                throw std::logic_error("Callees must not register on the signal, which is calling them");
+
+            mCallees.emplace_back(std::forward<CALLEE>(arCalleeFunction));
+        }
+
+        // Publish every call into the ring of a subscriber, see SignalEveryone::RegisterAsync
+        template <typename MESSAGE, typename CONVERT>
+        void RegisterAsync(SpscRing<MESSAGE>& arRing, CONVERT aConvert)
+        {
+            Register([&arRing, convert = std::move(aConvert)]() { arRing.TryPush(convert()); });
         }
 
         void operator()() const
         {
+            CallGuard guard(mCalling);
             for (const auto& Call : mCallees)
                 Call();
         }
 
+        bool Empty() const noexcept { return mCallees.empty(); }
+
     private:
-        std::vector<std::function<ReturnType()>> mCallees;
+        std::vector<Callee> mCallees;
+        // Depth of nested calls. Registering would move the callees, while they are running.
+        mutable unsigned mCalling = 0;
     };
 }
 
@@ -0,0 +1,211 @@
+#ifndef CORE_SLOTMAP_HPP_
+#define CORE_SLOTMAP_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace CORE
+{
+    /**
+     * @brief Container with stable addresses and generation-checked handles
+     *
+     * Elements are constructed in place within fixed-size chunks, which are never moved or released
+     * before the container. Inserting or erasing an element is O(1) and never touches other elements.
+     *
+     * Erasing an element increments the generation of its slot, so handles to the erased element
+     * no longer resolve, even after the slot was reused.
+     *
+     * @tparam T Element type. Neither copyable nor movable types are required.
+     * @tparam CHUNK_SIZE Number of slots, which are allocated at once
+     */
+    template <typename T, size_t CHUNK_SIZE = 64>
+    class SlotMap
+    {
+    public:
+        class Handle
+        {
+        public:
+            constexpr Handle() noexcept = default;
+
+            constexpr bool IsValid() const noexcept { return mGeneration != 0; }
+            constexpr uint32_t Index() const noexcept { return mIndex; }
+            constexpr uint32_t Generation() const noexcept { return mGeneration; }
+
+            constexpr bool operator==(const Handle& arOther) const noexcept = default;
+
+        private:
+            friend class SlotMap;
+
+            constexpr Handle(uint32_t aIndex, uint32_t aGeneration) noexcept
+                : mIndex(aIndex), mGeneration(aGeneration) {}
+
+            uint32_t mIndex = 0;
+            // Generation 0 is never used by an occupied slot
+            uint32_t mGeneration = 0;
+        };
+
+        SlotMap() = default;
+
+        ~SlotMap() noexcept { Clear(); }
+
+        SlotMap(const SlotMap&)            = delete;
+        SlotMap& operator=(const SlotMap&) = delete;
+
+        // Construct a new element in place
+        template <typename... Args>
+        Handle Emplace(Args&&... args)
+        {
+            if (mFree == NONE)
+                Grow();
+
+            auto index = mFree;
+            auto& slot = SlotAt(index);
+
+            ::new (static_cast<void*>(slot.storage)) T(std::forward<Args>(args)...);
+
+            mFree = slot.nextFree;
+            slot.nextFree = OCCUPIED;
+            ++mSize;
+
+            return Handle(index, slot.generation);
+        }
+
+        // Resolve a handle. nullptr, if the element was erased.
+        T* Get(Handle aHandle) noexcept
+        {
+            if (aHandle.mIndex >= Capacity())
+                return nullptr;
+
+            auto& slot = SlotAt(aHandle.mIndex);
+            return (slot.nextFree == OCCUPIED && slot.generation == aHandle.mGeneration) ? slot.Value() : nullptr;
+        }
+
+        const T* Get(Handle aHandle) const noexcept
+        {
+            return const_cast<SlotMap&>(*this).Get(aHandle);
+        }
+
+        // Destroy an element. Returns false, if the handle did not resolve.
+        bool Erase(Handle aHandle) noexcept
+        {
+            if (!Get(aHandle))
+                return false;
+
+            Release(aHandle.mIndex);
+            return true;
+        }
+
+        // Destroy all elements, for which aPredicate(T&) returns true
+        template <typename Predicate>
+        size_t EraseIf(Predicate&& aPredicate)
+        {
+            size_t erased = 0;
+
+            for (uint32_t i = 0; i < Capacity(); ++i)
+            {
+                auto& slot = SlotAt(i);
+
+                if (slot.nextFree == OCCUPIED && aPredicate(*slot.Value()))
+                {
+                    Release(i);
+                    ++erased;
+                }
+            }
+
+            return erased;
+        }
+
+        // Visit every element as aVisitor(Handle, T&)
+        template <typename Visitor>
+        void ForEach(Visitor&& aVisitor)
+        {
+            for (uint32_t i = 0; i < Capacity(); ++i)
+            {
+                auto& slot = SlotAt(i);
+
+                if (slot.nextFree == OCCUPIED)
+                    aVisitor(Handle(i, slot.generation), *slot.Value());
+            }
+        }
+
+        // Visit every element as aVisitor(Handle, const T&)
+        template <typename Visitor>
+        void ForEach(Visitor&& aVisitor) const
+        {
+            const_cast<SlotMap&>(*this).ForEach([&aVisitor](Handle aHandle, const T& arValue) {
+                aVisitor(aHandle, arValue);
+            });
+        }
+
+        void Clear() noexcept
+        {
+            for (uint32_t i = 0; i < Capacity() && mSize > 0; ++i)
+            {
+                if (SlotAt(i).nextFree == OCCUPIED)
+                    Release(i);
+            }
+        }
+
+        size_t Size() const noexcept { return mSize; }
+        bool Empty() const noexcept { return mSize == 0; }
+        size_t Capacity() const noexcept { return mChunks.size() * CHUNK_SIZE; }
+
+    private:
+        static constexpr uint32_t NONE     = UINT32_MAX;
+        static constexpr uint32_t OCCUPIED = UINT32_MAX - 1;
+
+        struct Slot
+        {
+            alignas(T) std::byte storage[sizeof(T)];
+            uint32_t generation = 1;
+            // Next free slot, NONE at the end of the free list, or OCCUPIED
+            uint32_t nextFree = NONE;
+
+            T* Value() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+        };
+
+        Slot& SlotAt(uint32_t aIndex) noexcept
+        {
+            return mChunks[aIndex / CHUNK_SIZE][aIndex % CHUNK_SIZE];
+        }
+
+        void Grow()
+        {
+            auto first = static_cast<uint32_t>(Capacity());
+            mChunks.push_back(std::make_unique<Slot[]>(CHUNK_SIZE));
+
+            // Link the new slots in ascending order
+            for (uint32_t i = CHUNK_SIZE; i > 0; --i)
+            {
+                SlotAt(first + i - 1).nextFree = mFree;
+                mFree = first + i - 1;
+            }
+        }
+
+        void Release(uint32_t aIndex) noexcept
+        {
+            auto& slot = SlotAt(aIndex);
+
+            // Unlink the slot before destruction, so a destructor, which looks up its own handle, does not find it
+            slot.nextFree = mFree;
+            mFree = aIndex;
+            --mSize;
+
+            if (++slot.generation == 0)
+                slot.generation = 1;
+
+            slot.Value()->~T();
+        }
+
+    private:
+        std::vector<std::unique_ptr<Slot[]>> mChunks;
+        uint32_t mFree = NONE;
+        size_t mSize = 0;
+    };
+}
+
+#endif
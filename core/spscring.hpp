@@ -0,0 +1,171 @@
+#ifndef CORE_SPSCRING_HPP_
+#define CORE_SPSCRING_HPP_
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "core/metrics.hpp"
+
+namespace CORE
+{
+    /**
+     * @brief Bounded queue of a single producer and a single consumer thread
+     *
+     * Neither side ever waits. A full queue rejects further values, which are counted as dropped.
+     * Each side keeps its index and a cached copy of the other one on a cache line of its own,
+     * so the indices of the other side are only read, when the cached one says full or empty.
+     */
+    template <typename T>
+    class SpscRing
+    {
+    public:
+        // aCapacity is rounded up to the next power of 2
+        explicit SpscRing(size_t aCapacity)
+        {
+            if (aCapacity == 0)
+                throw std::invalid_argument("Capacity of a ring must not be 0");
+
+            mMask = std::bit_ceil(aCapacity) - 1;
+            mSlots = std::make_unique<Slot[]>(mMask + 1);
+        }
+
+        ~SpscRing() noexcept
+        {
+            while (TryPop()) {}
+        }
+
+        SpscRing(const SpscRing&)            = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        // Producer: false, if the ring is full
+        template <typename... ARGS>
+        bool TryEmplace(ARGS&&... args) noexcept(std::is_nothrow_constructible_v<T, ARGS&&...>)
+        {
+            const auto tail = mProducer.index.load(std::memory_order_relaxed);
+
+            if (tail - mProducer.cached > mMask)
+            {
+                mProducer.cached = mConsumer.index.load(std::memory_order_acquire);
+                if (tail - mProducer.cached > mMask)
+                {
+                    mDropped.Add();
+                    return false;
+                }
+            }
+
+            ::new (static_cast<void*>(mSlots[tail & mMask].data)) T(std::forward<ARGS>(args)...);
+            mProducer.index.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool TryPush(T&& aValue) noexcept(std::is_nothrow_move_constructible_v<T>) { return TryEmplace(std::move(aValue)); }
+
+        // Consumer: empty, if there is no value
+        std::optional<T> TryPop() noexcept(std::is_nothrow_move_constructible_v<T>)
+        {
+            const auto head = mConsumer.index.load(std::memory_order_relaxed);
+
+            if (head == mConsumer.cached)
+            {
+                mConsumer.cached = mProducer.index.load(std::memory_order_acquire);
+                if (head == mConsumer.cached)
+                    return std::nullopt;
+            }
+
+            auto& value = *std::launder(reinterpret_cast<T*>(mSlots[head & mMask].data));
+            std::optional<T> result(std::move(value));
+            value.~T();
+
+            mConsumer.index.store(head + 1, std::memory_order_release);
+            return result;
+        }
+
+        // Consumer: hand every available value to aHandler(T&&). Returns the number of handled values.
+        template <typename HANDLER>
+        size_t Drain(HANDLER&& aHandler)
+        {
+            size_t handled = 0;
+
+            while (auto value = TryPop())
+            {
+                aHandler(std::move(*value));
+                ++handled;
+            }
+
+            return handled;
+        }
+
+        size_t Capacity() const noexcept { return mMask + 1; }
+        // Values rejected, because the ring was full. May be read from any thread.
+        uint64_t Dropped() const noexcept { return mDropped.Load(); }
+
+    private:
+        struct Slot
+        {
+            alignas(T) unsigned char data[sizeof(T)];
+        };
+
+        // Index written by one side, and the latest index of the other side it has seen
+        struct alignas(CACHE_LINE) Side
+        {
+            std::atomic<size_t> index{0};
+            size_t cached = 0;
+        };
+
+        Side mProducer;
+        Side mConsumer;
+        Padded<SingleWriterCounter> mDropped;
+        size_t mMask = 0;
+        std::unique_ptr<Slot[]> mSlots;
+    };
+
+    /**
+     * @brief One ring per producer thread, which are all drained by the same consumer
+     *
+     * Lets several threads publish to one subscriber, while every ring keeps its single producer.
+     */
+    template <typename T>
+    class SpscRingSet
+    {
+    public:
+        SpscRingSet(size_t aProducers, size_t aCapacity)
+        {
+            for (size_t i = 0; i < aProducers; ++i)
+                mRings.push_back(std::make_unique<SpscRing<T>>(aCapacity));
+        }
+
+        SpscRing<T>& operator[](size_t aProducer) noexcept { return *mRings[aProducer]; }
+        size_t Size() const noexcept { return mRings.size(); }
+
+        // Consumer: drain every ring once. Values of a single producer keep their order.
+        template <typename HANDLER>
+        size_t Drain(HANDLER&& aHandler)
+        {
+            size_t handled = 0;
+            for (auto& p_ring : mRings)
+                handled += p_ring->Drain(aHandler);
+            return handled;
+        }
+
+        uint64_t Dropped() const noexcept
+        {
+            uint64_t dropped = 0;
+            for (const auto& p_ring : mRings)
+                dropped += p_ring->Dropped();
+            return dropped;
+        }
+
+    private:
+        std::vector<std::unique_ptr<SpscRing<T>>> mRings;
+    };
+}
+
+#endif
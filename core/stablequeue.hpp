@@ -0,0 +1,162 @@
+#ifndef CORE_STABLEQUEUE_HPP_
+#define CORE_STABLEQUEUE_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace CORE
+{
+    /**
+     * @brief FIFO queue with stable addresses, which reuses the memory of its elements
+     *
+     * Elements are constructed in place within slots, which are allocated in chunks and never released
+     * before the queue. Popped slots are reused by the next push, so a queue, which stays within its
+     * reserved capacity, never allocates. Their order is kept by a ring of pointers, so growing the queue
+     * only moves pointers, and an element keeps its address until it is popped or erased.
+     *
+     * @tparam T Element type. Neither copyable nor movable types are required.
+     */
+    template <typename T>
+    class StableQueue
+    {
+    public:
+        explicit StableQueue(size_t aCapacity = 0) { Reserve(aCapacity); }
+
+        ~StableQueue() noexcept { Clear(); }
+
+        StableQueue(const StableQueue&)            = delete;
+        StableQueue& operator=(const StableQueue&) = delete;
+
+        // Allocate slots for aCapacity elements in total
+        void Reserve(size_t aCapacity)
+        {
+            if (aCapacity > mSlots)
+                AddChunk(aCapacity - mSlots);
+            if (aCapacity > mOrder.size())
+                Reorder(std::bit_ceil(aCapacity));
+        }
+
+        template <typename... Args>
+        T& EmplaceBack(Args&&... args)
+        {
+            // Doubles the capacity, just like a vector
+            if (!mpFree)
+                AddChunk(std::max<size_t>(mSlots, 1));
+            if (mSize == mOrder.size())
+                Reorder(std::bit_ceil(mSize + 1));
+
+            auto* p_slot = mpFree;
+            ::new (static_cast<void*>(p_slot->storage)) T(std::forward<Args>(args)...);
+
+            mpFree = p_slot->pNext;
+            mOrder[(mHead + mSize) & (mOrder.size() - 1)] = p_slot;
+            ++mSize;
+
+            return *p_slot->Value();
+        }
+
+        // aIndex counts from the front of the queue
+        T& operator[](size_t aIndex) noexcept { return *SlotAt(aIndex)->Value(); }
+        const T& operator[](size_t aIndex) const noexcept { return *const_cast<StableQueue&>(*this).SlotAt(aIndex)->Value(); }
+
+        T& Front() noexcept { return (*this)[0]; }
+        const T& Front() const noexcept { return (*this)[0]; }
+
+        // Destroy the first aCount elements
+        void PopFront(size_t aCount = 1) noexcept
+        {
+            for (size_t i = 0; i < aCount; ++i)
+                Release(SlotAt(i));
+
+            mHead = (mHead + aCount) & (mOrder.size() - 1);
+            mSize -= aCount;
+        }
+
+        // Destroy all elements, for which aPredicate(const T&) returns true. The others keep their order.
+        template <typename Predicate>
+        size_t EraseIf(Predicate&& aPredicate)
+        {
+            size_t kept = 0;
+
+            for (size_t i = 0; i < mSize; ++i)
+            {
+                auto* p_slot = SlotAt(i);
+
+                if (aPredicate(std::as_const(*p_slot->Value())))
+                    Release(p_slot);
+                else
+                    mOrder[(mHead + kept++) & (mOrder.size() - 1)] = p_slot;
+            }
+
+            const auto erased = mSize - kept;
+            mSize = kept;
+            return erased;
+        }
+
+        void Clear() noexcept { PopFront(mSize); }
+
+        size_t Size() const noexcept { return mSize; }
+        bool Empty() const noexcept { return mSize == 0; }
+        // Number of elements, which fit without an allocation
+        size_t Capacity() const noexcept { return std::min(mSlots, mOrder.size()); }
+
+    private:
+        struct Slot
+        {
+            alignas(T) std::byte storage[sizeof(T)];
+            // Next free slot
+            Slot* pNext = nullptr;
+
+            T* Value() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+        };
+
+        Slot* SlotAt(size_t aIndex) noexcept { return mOrder[(mHead + aIndex) & (mOrder.size() - 1)]; }
+
+        void AddChunk(size_t aCount)
+        {
+            auto& chunk = mChunks.emplace_back(std::make_unique<Slot[]>(aCount));
+
+            for (size_t i = aCount; i > 0; --i)
+            {
+                chunk[i - 1].pNext = mpFree;
+                mpFree = &chunk[i - 1];
+            }
+
+            mSlots += aCount;
+        }
+
+        // Unroll the ring into a new one of aSize pointers, which is a power of 2
+        void Reorder(size_t aSize)
+        {
+            std::vector<Slot*> order(aSize, nullptr);
+            for (size_t i = 0; i < mSize; ++i)
+                order[i] = SlotAt(i);
+
+            mOrder = std::move(order);
+            mHead = 0;
+        }
+
+        void Release(Slot* apSlot) noexcept
+        {
+            apSlot->Value()->~T();
+            apSlot->pNext = mpFree;
+            mpFree = apSlot;
+        }
+
+    private:
+        std::vector<std::unique_ptr<Slot[]>> mChunks;
+        Slot* mpFree = nullptr;
+        size_t mSlots = 0;
+        // Ring of the occupied slots in the order of the queue
+        std::vector<Slot*> mOrder;
+        size_t mHead = 0;
+        size_t mSize = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,265 @@
+#ifndef CORE_TIMERWHEEL_HPP_
+#define CORE_TIMERWHEEL_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace CORE
+{
+    /**
+     * @brief Hashed timer wheel for a large number of deadlines
+     *
+     * Every scheduled object owns an intrusive Entry. Scheduling and cancelling an entry is O(1).
+     * Advancing the wheel only visits the slots passed since the previous advance,
+     * so the cost depends on the number of deadlines in these slots, not on the number of entries.
+     *
+     * Deadlines more than one revolution ahead stay in their slot, until their round has come.
+     *
+     * @tparam Owner Type of the scheduled object, which is passed to the expiry callback
+     */
+    template <typename Owner>
+    class TimerWheel
+    {
+    private:
+        // Node of a circular doubly-linked list. Each slot has one as sentinel.
+        class Hook
+        {
+        public:
+            Hook() noexcept : mPrev(this), mNext(this) {}
+
+            Hook(const Hook&)            = delete;
+            Hook& operator=(const Hook&) = delete;
+
+            bool IsLinked() const noexcept { return mNext != this; }
+
+            void InsertBefore(Hook& arPosition) noexcept
+            {
+                mNext = &arPosition;
+                mPrev = arPosition.mPrev;
+                mPrev->mNext = this;
+                arPosition.mPrev = this;
+            }
+
+            void Unlink() noexcept
+            {
+                mPrev->mNext = mNext;
+                mNext->mPrev = mPrev;
+                mPrev = mNext = this;
+            }
+
+            // Move all nodes of arOther into this empty list
+            void TakeAll(Hook& arOther) noexcept
+            {
+                if (!arOther.IsLinked())
+                    return;
+
+                mNext = arOther.mNext;
+                mPrev = arOther.mPrev;
+                mNext->mPrev = this;
+                mPrev->mNext = this;
+                arOther.mPrev = arOther.mNext = &arOther;
+            }
+
+            Hook* Next() const noexcept { return mNext; }
+
+        private:
+            Hook* mPrev;
+            Hook* mNext;
+        };
+
+    public:
+        class Entry : private Hook
+        {
+        public:
+            explicit Entry(Owner& arOwner) noexcept
+                : mOwner(arOwner) {}
+
+            ~Entry() noexcept { Cancel(); }
+
+            Entry(const Entry&)            = delete;
+            Entry& operator=(const Entry&) = delete;
+
+            bool IsScheduled() const noexcept { return mWheel != nullptr; }
+            std::chrono::milliseconds Deadline() const noexcept { return mDeadline; }
+
+            void Cancel() noexcept
+            {
+                if (mWheel)
+                    mWheel->Remove(*this);
+            }
+
+        private:
+            friend class TimerWheel;
+
+            Owner& mOwner;
+            TimerWheel* mWheel = nullptr;
+            std::chrono::milliseconds mDeadline{};
+        };
+
+        /**
+         * @param aResolution Time covered by a single slot
+         * @param aSlots Number of slots for one revolution
+         * @param aNow Start time of the wheel
+         */
+        explicit TimerWheel(std::chrono::milliseconds aResolution, size_t aSlots, std::chrono::milliseconds aNow)
+            : mResolution(aResolution), mSlots(aSlots), mNow(aNow), mCurrentTick(ToTick(aNow))
+        {
+            if (aResolution.count() <= 0 || aSlots == 0)
+                throw std::invalid_argument("timer wheel needs a positive resolution and at least one slot");
+        }
+
+        ~TimerWheel() noexcept
+        {
+            for (auto& slot : mSlots)
+            {
+                while (slot.IsLinked())
+                    Remove(static_cast<Entry&>(*slot.Next()));
+            }
+        }
+
+        TimerWheel(const TimerWheel&)            = delete;
+        TimerWheel& operator=(const TimerWheel&) = delete;
+
+        // Time of the last advance
+        std::chrono::milliseconds Now() const noexcept { return mNow; }
+
+        // Number of scheduled entries
+        size_t Size() const noexcept { return mSize; }
+
+        // Schedule or reschedule the entry. Deadlines in the past expire with the next advance.
+        void Schedule(Entry& arEntry, std::chrono::milliseconds aDeadline) noexcept
+        {
+            arEntry.Cancel();
+
+            auto tick = std::max(ToTick(aDeadline), mCurrentTick);
+            arEntry.mDeadline = aDeadline;
+            arEntry.mWheel = this;
+            arEntry.InsertBefore(mSlots[tick % mSlots.size()]);
+            ++mSize;
+        }
+
+        /**
+         * @brief Advance the wheel to aNow and report every expired entry
+         *
+         * Expired entries are unscheduled before aExpired(Owner&) is called for them.
+         * The callback may schedule or cancel any entry. If it throws, the entries, which were
+         * not reported yet, stay scheduled and expire with the next advance.
+         */
+        template <typename Callback>
+        void Advance(std::chrono::milliseconds aNow, Callback&& aExpired)
+        {
+            if (aNow < mNow)
+                return;
+
+            auto lastTick = ToTick(aNow);
+            // The current tick is visited again, as it may contain deadlines after the previous advance.
+            // A gap of more than one revolution has to visit each slot only once.
+            auto visits = std::min<long long>(lastTick - mCurrentTick + 1, static_cast<long long>(mSlots.size()));
+
+            mNow = aNow;
+            mCurrentTick = lastTick;
+
+            for (long long i = 0; i < visits; ++i)
+            {
+                try
+                {
+                    ExpireSlot(mSlots[(lastTick - i) % mSlots.size()], aExpired);
+                }
+                catch (...)
+                {
+                    // The slots, which were not visited, are not visited by the next advance either
+                    for (++i; i < visits; ++i)
+                    {
+                        auto& slot = mSlots[(lastTick - i) % mSlots.size()];
+                        Hook pending;
+                        pending.TakeAll(slot);
+                        Requeue(pending, slot);
+                    }
+                    throw;
+                }
+            }
+        }
+
+    private:
+        long long ToTick(std::chrono::milliseconds aTime) const noexcept
+        {
+            return aTime.count() / mResolution.count();
+        }
+
+        void Remove(Entry& arEntry) noexcept
+        {
+            arEntry.Unlink();
+            arEntry.mWheel = nullptr;
+            --mSize;
+        }
+
+        // Move all entries of arList: Due ones into the current slot, so they expire with the next advance,
+        // the others of a later revolution into arSlot
+        void Requeue(Hook& arList, Hook& arSlot) noexcept
+        {
+            auto& current = mSlots[mCurrentTick % mSlots.size()];
+
+            while (arList.IsLinked())
+            {
+                auto& entry = static_cast<Entry&>(*arList.Next());
+                entry.Unlink();
+                entry.InsertBefore(entry.mDeadline <= mNow ? current : arSlot);
+            }
+        }
+
+        // Requeues the entries of a detached slot, which were not visited, also if the callback throws
+        class RequeueGuard
+        {
+        public:
+            RequeueGuard(TimerWheel& arWheel, Hook& arPending, Hook& arSlot) noexcept
+                : mrWheel(arWheel), mrPending(arPending), mrSlot(arSlot) {}
+            ~RequeueGuard() noexcept { mrWheel.Requeue(mrPending, mrSlot); }
+
+            RequeueGuard(const RequeueGuard&)            = delete;
+            RequeueGuard& operator=(const RequeueGuard&) = delete;
+
+        private:
+            TimerWheel& mrWheel;
+            Hook& mrPending;
+            Hook& mrSlot;
+        };
+
+        template <typename Callback>
+        void ExpireSlot(Hook& arSlot, Callback& aExpired)
+        {
+            // Detach the slot, so the callback cannot modify the list being visited
+            Hook pending;
+            pending.TakeAll(arSlot);
+            RequeueGuard guard(*this, pending, arSlot);
+
+            while (pending.IsLinked())
+            {
+                auto& entry = static_cast<Entry&>(*pending.Next());
+
+                if (entry.mDeadline <= mNow)
+                {
+                    Remove(entry);
+                    aExpired(entry.mOwner);
+                }
+                else
+                {
+                    // a later revolution
+                    entry.Unlink();
+                    entry.InsertBefore(arSlot);
+                }
+            }
+        }
+
+    private:
+        std::chrono::milliseconds mResolution;
+        std::vector<Hook> mSlots;
+        std::chrono::milliseconds mNow;
+        long long mCurrentTick;
+        size_t mSize = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,243 @@
+#include "loadgen.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/asio/steady_timer.hpp>
+#include <boost/cobalt/join.hpp>
+#include <boost/cobalt/op.hpp>
+#include <boost/cobalt/this_thread.hpp>
+
+#include "protocols/iec104/apdu.hpp"
+#include "protocols/iec104/client.hpp"
+#include "protocols/iec104/infoobjects.hpp"
+#include "protocols/iec104/server.hpp"
+
+namespace asio = boost::asio;
+namespace async = boost::cobalt;
+
+// Changes are generated and flushed in steps of this length
+static constexpr std::chrono::milliseconds GENERATE_INTERVAL(10);
+// Timer supervision of server and client
+static constexpr std::chrono::milliseconds TICK_INTERVAL(100);
+static constexpr std::chrono::seconds REPORT_INTERVAL(1);
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        // All info objects are registered during static initialization
+        IEC104::InfoObjectFactory::Freeze();
+
+        LoadGen app(argc, argv);
+        app.Run();
+        return 0;
+    }
+    catch (std::exception& e) { std::cout << "An unhandled error occured: " << e.what() << std::endl; }
+    catch (...)               { std::cout << "An unhandled and unknown error occured" << std::endl; }
+    return -1;
+}
+
+LoadGen::LoadGen(int argc, char* argv[])
+    : mIP(asio::ip::make_address("127.0.0.1"))
+    , mRandom(std::random_device{}())
+{
+    ReadArguments(argc, argv);
+}
+
+void LoadGen::Run()
+{
+    PrintWelcomeMessage();
+    async::this_thread::set_executor(mContext.get_executor());
+
+    IEC104::Server server(mIP, mPort);
+    IEC104::Client client;
+
+    server.SignalLinkStateChanged.Register([this](auto& l)            { OnOutstationStateChanged(l); });
+    server.SignalApduSent        .Register([this](auto& l, auto& msg) { OnOutstationSent(l, msg);     });
+    server.SignalApduReceived    .Register([this](auto& l, auto& msg) { OnOutstationReceived(l, msg); });
+    client.SignalApduReceived    .Register([this](auto&, auto&)       { ++mApdusReceived;             });
+
+    server.Start();
+
+    for (size_t i = 0; i < mStations; ++i)
+        client.AddOutstation({ {mIP, mPort} });
+    client.Start();
+
+    // Destroying the promise would cancel the loop
+    [[maybe_unused]] auto drive = Drive(server, client);
+    mContext.run();
+}
+
+async::promise<void> LoadGen::Drive(IEC104::Server& arServer, IEC104::Client& arClient)
+{
+    asio::steady_timer timer(mContext);
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto cpu_start = std::clock();
+    auto next_tick = start;
+    auto next_report = start + REPORT_INTERVAL;
+
+    for (auto now = start; now - start < mDuration; now = std::chrono::steady_clock::now())
+    {
+        Generate(GENERATE_INTERVAL);
+
+        std::vector<async::promise<void>> flushes;
+        for (auto& [p_link, outstation] : mOutstations)
+            flushes.push_back([](IEC104::Link& l) -> async::promise<void> {
+                // A failed write closes the link with its next tick
+                try { co_await l.Flush(); } catch (...) {}
+            }(*p_link));
+
+        if (!flushes.empty())
+            co_await async::join(flushes);
+
+        if (now >= next_tick)
+        {
+            co_await arServer.Tick();
+            co_await arClient.Tick();
+            next_tick += TICK_INTERVAL;
+        }
+
+        if (now >= next_report)
+        {
+            const double cpu = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+            Report(arClient, now - start, cpu);
+            next_report += REPORT_INTERVAL;
+        }
+
+        timer.expires_after(GENERATE_INTERVAL);
+        co_await timer.async_wait(async::use_op);
+    }
+
+    const double cpu = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+    std::cout << "\nSummary\n";
+    Report(arClient, std::chrono::steady_clock::now() - start, cpu);
+
+    mContext.stop();
+}
+
+void LoadGen::Generate(std::chrono::duration<double> aInterval)
+{
+    std::uniform_int_distribution<uint32_t> address(0, mPoints - 1);
+    std::uniform_real_distribution<float> value(0.0f, 100.0f);
+
+    for (auto& [p_link, outstation] : mOutstations)
+    {
+        if (!p_link->IsActive())
+            continue;
+
+        // Fractions of a change are carried over to the next step
+        outstation.pendingChanges += mRate * aInterval.count();
+        const auto changes = static_cast<uint64_t>(outstation.pendingChanges);
+        outstation.pendingChanges -= static_cast<double>(changes);
+
+        for (uint64_t i = 0; i < changes; ++i)
+            p_link->Events().Push(1, IEC104::RecordMeasuredFloat{address(mRandom), value(mRandom), IEC104::Quality()});
+
+        mChanges += changes;
+    }
+}
+
+void LoadGen::Report(const IEC104::Client& arClient, std::chrono::duration<double> aElapsed, double aCpuSeconds) const
+{
+    const double seconds = std::max(aElapsed.count(), 1e-9);
+    const size_t links = std::max<size_t>(mOutstations.size(), 1);
+    const auto ackLatency = mAckLatency.Read();
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "t=" << seconds << "s"
+              << " links=" << mOutstations.size() << "/" << arClient.Outstations()
+              << " changes/s=" << mChanges / seconds
+              << " apdus/s sent=" << mApdusSent / seconds
+              << " received=" << mApdusReceived / seconds
+              << " ack p50=" << ackLatency.Quantile(0.5) << "us"
+              << " p99=" << ackLatency.Quantile(0.99) << "us"
+              << std::setprecision(3)
+              << " cpu/link=" << 100.0 * aCpuSeconds / seconds / static_cast<double>(links) << "%"
+              << std::endl;
+}
+
+void LoadGen::OnOutstationStateChanged(IEC104::Link& arLink)
+{
+    // Links are forgotten before they are removed by the server
+    if (arLink.IsConnected())
+        mOutstations.try_emplace(&arLink);
+    else
+        mOutstations.erase(&arLink);
+}
+
+void LoadGen::OnOutstationSent(IEC104::Link& arLink, const IEC104::Apdu& arApdu)
+{
+    ++mApdusSent;
+
+    auto found = mOutstations.find(&arLink);
+    auto send = arApdu.SendSequence();
+
+    if (found != mOutstations.end() && send)
+        found->second.unacked.emplace_back(*send, std::chrono::steady_clock::now());
+}
+
+void LoadGen::OnOutstationReceived(IEC104::Link& arLink, const IEC104::ApduView& arApdu)
+{
+    auto found = mOutstations.find(&arLink);
+    auto receive = arApdu.ReceiveSequence();
+
+    if (found == mOutstations.end() || !receive)
+        return;
+
+    // The receive sequence acknowledges all I-Frames before it
+    auto& unacked = found->second.unacked;
+    const auto now = std::chrono::steady_clock::now();
+
+    while (!unacked.empty() && unacked.front().first < *receive)
+    {
+        const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(now - unacked.front().second);
+        mAckLatency.Record(static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0)));
+        unacked.pop_front();
+    }
+}
+
+void LoadGen::PrintWelcomeMessage() const
+{
+    std::cout << "Welcome to the VRTU load generator\n"
+              << mStations << " outstations with " << mPoints << " points and "
+              << mRate << " changes/s each on " << mIP << ":" << mPort
+              << " for " << mDuration.count() << "s" << std::endl;
+}
+
+void LoadGen::ReadArguments(int argc, char* argv[])
+{
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const char* p_option = argv[i];
+        const char* p_value = argv[i + 1];
+
+        try
+        {
+            if (std::strcmp(p_option, "--ip") == 0)
+                mIP = asio::ip::make_address(p_value);
+            else if (std::strcmp(p_option, "--port") == 0)
+                mPort = static_cast<uint16_t>(std::stoul(p_value));
+            else if (std::strcmp(p_option, "--stations") == 0)
+                mStations = std::stoul(p_value);
+            else if (std::strcmp(p_option, "--points") == 0)
+                mPoints = std::max<uint32_t>(static_cast<uint32_t>(std::stoul(p_value)), 1);
+            else if (std::strcmp(p_option, "--rate") == 0)
+                mRate = std::stod(p_value);
+            else if (std::strcmp(p_option, "--duration") == 0)
+                mDuration = std::chrono::seconds(std::stoul(p_value));
+            else
+                std::cout << "unknown option " << p_option << std::endl;
+        }
+        catch (const std::exception&)
+        {
+            std::cout << p_value << " is not a valid value for " << p_option << std::endl;
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef LOADGEN_HPP_
+#define LOADGEN_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <unordered_map>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/address.hpp>
+#include <boost/cobalt/promise.hpp>
+
+#include "core/metrics.hpp"
+#include "protocols/iec104/sequence.hpp"
+
+namespace IEC104
+{
+    class Apdu;
+    class ApduView;
+    class Client;
+    class Link;
+    class Server;
+}
+
+/**
+ * @brief Simulates outstations on loopback and measures the achieved traffic
+ *
+ * A Server acts as N outstations, one slave link each. A Client connects to all of them as controlling station.
+ * Both run on a single thread. Every outstation pushes changes of its points into the event queue of its link,
+ * so the traffic takes the real path through EventQueue, Asdu and Link.
+ */
+class LoadGen
+{
+public:
+    explicit LoadGen(int aArgc, char* aArgv[]);
+
+    void Run();
+
+private:
+    struct Outstation
+    {
+        // Send time of every I-Frame, which is not acknowledged yet
+        std::deque<std::pair<IEC104::Sequence, std::chrono::steady_clock::time_point>> unacked;
+        double pendingChanges = 0;
+    };
+
+    void PrintWelcomeMessage() const;
+    void ReadArguments(int argc, char* argv[]);
+
+    // Single loop for changes, timer supervision and reports. Links are only removed between its steps.
+    boost::cobalt::promise<void> Drive(IEC104::Server& arServer, IEC104::Client& arClient);
+    void Generate(std::chrono::duration<double> aInterval);
+    void Report(const IEC104::Client& arClient, std::chrono::duration<double> aElapsed, double aCpuSeconds) const;
+
+    void OnOutstationStateChanged(IEC104::Link& arLink);
+    void OnOutstationSent(IEC104::Link& arLink, const IEC104::Apdu& arApdu);
+    void OnOutstationReceived(IEC104::Link& arLink, const IEC104::ApduView& arApdu);
+
+private:
+    boost::asio::io_context mContext;
+    boost::asio::ip::address mIP;
+    uint16_t mPort = 2404;
+
+    size_t mStations = 100;
+    uint32_t mPoints = 1000;
+    // Changes per second of a single outstation
+    double mRate = 10;
+    std::chrono::seconds mDuration{10};
+
+    // Connected slave links
+    std::unordered_map<IEC104::Link*, Outstation> mOutstations;
+
+    uint64_t mChanges = 0;
+    uint64_t mApdusSent = 0;
+    uint64_t mApdusReceived = 0;
+    // In microseconds
+    CORE::Histogram mAckLatency;
+    std::minstd_rand mRandom;
+};
+
+#endif
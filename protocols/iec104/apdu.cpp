@@ -1,57 +1,140 @@
 #include "protocols/iec104/apdu.hpp"
 
+#include <algorithm>
 #include <cstring>
 #include "core/bytestream.hpp"
 #include "protocols/iec104/sequence.hpp"
 
 namespace IEC104
 {
-    const Apdu Apdu::STARTDT_ACT = Apdu(Apdu::STARTDT_ACT_BYTE);
-    const Apdu Apdu::STOPDT_ACT  = Apdu(Apdu::STOPDT_ACT_BYTE);
-    const Apdu Apdu::TESTFR_ACT  = Apdu(Apdu::TESTFR_ACT_BYTE);
-    const Apdu Apdu::STARTDT_CON = Apdu(Apdu::STARTDT_CON_BYTE);
-    const Apdu Apdu::STOPDT_CON  = Apdu(Apdu::STOPDT_CON_BYTE);
-    const Apdu Apdu::TESTFR_CON  = Apdu(Apdu::TESTFR_CON_BYTE);
+    const Apdu Apdu::STARTDT_ACT = Apdu(ApduView::STARTDT_ACT_BYTE);
+    const Apdu Apdu::STOPDT_ACT  = Apdu(ApduView::STOPDT_ACT_BYTE);
+    const Apdu Apdu::TESTFR_ACT  = Apdu(ApduView::TESTFR_ACT_BYTE);
+    const Apdu Apdu::STARTDT_CON = Apdu(ApduView::STARTDT_CON_BYTE);
+    const Apdu Apdu::STOPDT_CON  = Apdu(ApduView::STOPDT_CON_BYTE);
+    const Apdu Apdu::TESTFR_CON  = Apdu(ApduView::TESTFR_CON_BYTE);
+
+    ApduView::ApduView(ByteStream& buf)
+        : mpFrame(nullptr)
+    {
+        if (!Apdu::IsFullyAvailable(buf))
+            throw std::invalid_argument("data is not ready to construct an apdu");
 
-    Apdu::Apdu(uint8_t service) noexcept
+        // The whole frame is available, so its length can be taken from the stream before reading
+        mpFrame = buf.ReadData(static_cast<size_t>(buf.PeekAt(1)) + 2);
+
+        if (!IsValid())
+            throw std::invalid_argument("apdu structure is unplausible");
+    }
+
+    size_t ApduView::PayloadLength() const noexcept
     {
-        mHeader[2] = service;
+        if (Length() > HEADER_SIZE)
+            return Length() - HEADER_SIZE;
+        else
+            return 0;
     }
 
-    Apdu::Apdu(ByteStream& buf)
+    bool ApduView::IsValid() const noexcept
     {
-        if (!IsFullyAvailable(buf))
-            throw std::invalid_argument("data is not ready to construct an apdu");
+        if (Length() > MAX_LENGTH)
+            return false;
 
-        buf.ReadInto(mHeader, HEADER_SIZE);
+        if (HasPayload())
+            return Length() > HEADER_SIZE;
+        else
+            return Length() == HEADER_SIZE;
+    }
 
-        if (PayloadLength() > 0)
-            buf.ReadInto(mPayload, PayloadLength());
+    void ApduView::WriteTo(std::vector<uint8_t>& dest) const
+    {
+        dest.insert(dest.end(), mpFrame, mpFrame + HEADER_SIZE);
 
-        if (!IsValid())
-            throw std::invalid_argument("apdu structure is unplausible");
+        if (HasPayload())
+            dest.insert(dest.end(), PayloadBegin(), PayloadEnd());
+    }
+
+    ServiceType ApduView::ServiceActivation() const noexcept
+    {
+        int service = mpFrame[2];
+
+        switch (service) {
+            case STARTDT_ACT_BYTE: return ServiceType::START;
+            case STOPDT_ACT_BYTE:  return ServiceType::STOP;
+            case TESTFR_ACT_BYTE:  return ServiceType::TEST;
+            default:               return ServiceType::NONE;
+        }
+    }
+
+    ServiceType ApduView::ServiceConfirmation() const noexcept
+    {
+        int service = mpFrame[2];
+
+        switch (service) {
+            case STARTDT_CON_BYTE: return ServiceType::START;
+            case STOPDT_CON_BYTE:  return ServiceType::STOP;
+            case TESTFR_CON_BYTE:  return ServiceType::TEST;
+            default:               return ServiceType::NONE;
+        }
+    }
+
+    std::optional<Sequence> ApduView::ReceiveSequence() const noexcept
+    {
+        if (HasPayload() || IsRecvAck())
+            return Sequence(mpFrame[4], mpFrame[5]);
+        else
+            return {};
+    }
+
+    std::optional<Sequence> ApduView::SendSequence() const noexcept
+    {
+        if (HasPayload())
+            return Sequence(mpFrame[2], mpFrame[3]);
+        else
+            return {};
+    }
+
+    Apdu::Apdu(uint8_t service) noexcept
+    {
+        mData[2] = service;
+    }
+
+    Apdu::Apdu(ByteStream& buf)
+        : Apdu(ApduView(buf))
+    {
+    }
+
+    Apdu::Apdu(const ApduView& view) noexcept
+    {
+        std::memcpy(mData, view.Data(), std::min(view.Length(), ApduView::MAX_LENGTH));
     }
 
     Apdu::Apdu(Sequence recv)
-        : mHeader{ 0x68, 0x04, 0x01, 0x00, recv.EncodedLowByte(), recv.EncodedHighByte() }
+        : mData{ 0x68, 0x04, 0x01, 0x00, recv.EncodedLowByte(), recv.EncodedHighByte() }
     {
     }
 
+    Apdu::Apdu(const uint8_t* apAsdu, size_t aSize)
+    {
+        if (!apAsdu || aSize == 0 || aSize > MAX_ASDU_SIZE)
+            throw std::invalid_argument("asdu size does not fit into an apdu");
+
+        mData[1] = static_cast<uint8_t>(aSize + HEADER_SIZE - 2);
+        std::memcpy(mData + HEADER_SIZE, apAsdu, aSize);
+    }
+
     Apdu::~Apdu()
     {
     }
 
     size_t Apdu::PayloadLength() const noexcept
     {
-        if (Length() > HEADER_SIZE)
-            return Length() - HEADER_SIZE;
-        else
-            return 0;
+        return View().PayloadLength();
     }
 
     size_t Apdu::Length() const noexcept
     {
-        return static_cast<size_t>(mHeader[1]) + 2;
+        return View().Length();
     }
 
     bool Apdu::IsFullyAvailable(const ByteStream& buf)
@@ -61,77 +144,60 @@ namespace IEC104
 
         auto reported_len = static_cast<size_t>(buf.PeekAt(1)) + 2;
 
-        if (reported_len > 255 || reported_len < 6)
+        if (reported_len > ApduView::MAX_LENGTH || reported_len < 6)
             throw std::runtime_error("reported apdu length is not in valid range");
 
         return buf.RemainingBytes() >= reported_len;
     }
 
-    bool Apdu::IsValid() const noexcept 
+    bool Apdu::IsValid() const noexcept
     {
-        if (Length() > 255)
-            return false;
-
-        if (HasPayload())
-            return Length() > HEADER_SIZE;
-        else
-            return Length() == HEADER_SIZE;
+        return View().IsValid();
     }
 
     bool Apdu::HasPayload() const noexcept
     {
-        return (mHeader[2] & 0x01) == 0;
+        return View().HasPayload();
     }
+
     bool Apdu::IsRecvAck() const noexcept
     {
-        return mHeader[2] == 0x01;
+        return View().IsRecvAck();
     }
 
     void Apdu::WriteTo(std::vector<uint8_t>& dest) const
     {
-        dest.insert(dest.end(), mHeader, mHeader + HEADER_SIZE);
-
-        if (HasPayload())
-            dest.insert(dest.end(), mPayload, mPayload + PayloadLength());
+        View().WriteTo(dest);
     }
 
     ServiceType Apdu::ServiceActivation() const noexcept
     {
-        int service = mHeader[2];
-
-        switch (service) {
-            case STARTDT_ACT_BYTE: return ServiceType::START;
-            case STOPDT_ACT_BYTE:  return ServiceType::STOP;
-            case TESTFR_ACT_BYTE:  return ServiceType::TEST;
-            default:               return ServiceType::NONE;
-        }
+        return View().ServiceActivation();
     }
 
     ServiceType Apdu::ServiceConfirmation() const noexcept
     {
-        int service = mHeader[2];
-
-        switch (service) {
-            case STARTDT_CON_BYTE: return ServiceType::START;
-            case STOPDT_CON_BYTE:  return ServiceType::STOP;
-            case TESTFR_CON_BYTE:  return ServiceType::TEST;
-            default:               return ServiceType::NONE;
-        }
+        return View().ServiceConfirmation();
     }
 
     std::optional<Sequence> Apdu::ReceiveSequence() const noexcept
     {
-        if (HasPayload() || IsRecvAck())
-            return Sequence(mHeader[4], mHeader[5]);
-        else
-            return {};
+        return View().ReceiveSequence();
     }
 
     std::optional<Sequence> Apdu::SendSequence() const noexcept
     {
-        if (HasPayload())
-            return Sequence(mHeader[2], mHeader[3]);
-        else
-            return {};
+        return View().SendSequence();
+    }
+
+    void Apdu::SetSequences(Sequence send, Sequence recv)
+    {
+        if (!HasPayload())
+            throw std::logic_error("only I-Frames have sequence numbers to set");
+
+        mData[2] = send.EncodedLowByte();
+        mData[3] = send.EncodedHighByte();
+        mData[4] = recv.EncodedLowByte();
+        mData[5] = recv.EncodedHighByte();
     }
-}
\ No newline at end of file
+}
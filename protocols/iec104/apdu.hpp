@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <optional>
+#include <vector>
 #include "protocols/iec104/sequence.hpp"
 #include "protocols/iec104/servicetype.hpp"
 
@@ -10,26 +11,88 @@ class ByteStream;
 
 namespace IEC104
 {
-    class Apdu
+    /**
+     * @brief Non-owning view of a complete APDU (header and payload)
+     *
+     * The view refers to the memory it was created from. It is only valid,
+     * as long as this memory is neither modified nor released.
+     * Use Apdu(const ApduView&) to retain a copy of the frame.
+     */
+    class ApduView
     {
     public:
         static constexpr size_t HEADER_SIZE = 6;
+        static constexpr size_t MAX_LENGTH  = 255;
+        static constexpr uint8_t START_BYTE = 0x68;
+
+        // Take the next APDU from a network stream, without copying it
+        explicit ApduView(ByteStream& buf);
+        // View an APDU in memory. The frame is not validated.
+        explicit ApduView(const uint8_t* apFrame) noexcept
+            : mpFrame(apFrame) {}
+
+        const uint8_t* Data() const noexcept { return mpFrame; }
+        const uint8_t* PayloadBegin() const noexcept { return mpFrame + HEADER_SIZE; }
+        const uint8_t* PayloadEnd() const noexcept { return PayloadBegin() + PayloadLength(); }
+
+        size_t Length() const noexcept { return static_cast<size_t>(mpFrame[1]) + 2; }
+        size_t PayloadLength() const noexcept;
+        size_t HeaderLength() const noexcept { return HEADER_SIZE; }
+
+        void WriteTo(std::vector<uint8_t>& dest) const;
+
+        bool IsValid() const noexcept;
+
+        bool HasPayload() const noexcept { return (mpFrame[2] & 0x01) == 0; }
+        bool IsRecvAck() const noexcept { return mpFrame[2] == 0x01; }
+
+        ServiceType ServiceActivation() const noexcept;
+        ServiceType ServiceConfirmation() const noexcept;
+
+        std::optional<Sequence> ReceiveSequence() const noexcept;
+        std::optional<Sequence> SendSequence() const noexcept;
+
+    private:
+        friend class Apdu;
+
+        static constexpr uint8_t STARTDT_ACT_BYTE = 0x07;
+        static constexpr uint8_t STARTDT_CON_BYTE = 0x0B;
+        static constexpr uint8_t STOPDT_ACT_BYTE  = 0x13;
+        static constexpr uint8_t STOPDT_CON_BYTE  = 0x23;
+        static constexpr uint8_t TESTFR_ACT_BYTE  = 0x43;
+        static constexpr uint8_t TESTFR_CON_BYTE  = 0x83;
+
+        const uint8_t* mpFrame;
+    };
+
+    // Owning APDU
+    class Apdu
+    {
+    public:
+        static constexpr size_t HEADER_SIZE = ApduView::HEADER_SIZE;
+        static constexpr size_t MAX_ASDU_SIZE = ApduView::MAX_LENGTH - HEADER_SIZE;
         static const Apdu STARTDT_ACT;
         static const Apdu STOPDT_ACT;
         static const Apdu TESTFR_ACT;
         static const Apdu STARTDT_CON;
         static const Apdu STOPDT_CON;
         static const Apdu TESTFR_CON;
-        
+
         static bool IsFullyAvailable(const ByteStream& buf);
 
         // create from network stream
         explicit Apdu(ByteStream& buf);
+        // create a copy of a viewed apdu
+        explicit Apdu(const ApduView& view) noexcept;
         // create Recv Ack APDU (S-Frame)
         explicit Apdu(Sequence recv);
+        // create an I-Frame, which carries an encoded ASDU. The sequence numbers are set on transmission.
+        explicit Apdu(const uint8_t* apAsdu, size_t aSize);
 
         ~Apdu();
 
+        ApduView View() const noexcept { return ApduView(mData); }
+
         size_t Length() const noexcept;
         size_t PayloadLength() const noexcept;
         size_t HeaderLength() const noexcept { return HEADER_SIZE; }
@@ -47,22 +110,16 @@ namespace IEC104
         std::optional<Sequence> ReceiveSequence() const noexcept;
         std::optional<Sequence> SendSequence() const noexcept;
 
-    private:
-        static constexpr uint8_t MAX_PAYLOAD_SIZE = 255;
-
-        static constexpr uint8_t STARTDT_ACT_BYTE = 0x07;
-        static constexpr uint8_t STARTDT_CON_BYTE = 0x0B;
-        static constexpr uint8_t STOPDT_ACT_BYTE  = 0x13;
-        static constexpr uint8_t STOPDT_CON_BYTE  = 0x23;
-        static constexpr uint8_t TESTFR_ACT_BYTE  = 0x43;
-        static constexpr uint8_t TESTFR_CON_BYTE  = 0x83;
+        // Set the sequence numbers of an I-Frame
+        void SetSequences(Sequence send, Sequence recv);
 
+    private:
         // construct a service Apdu
         explicit Apdu(uint8_t service) noexcept;
 
-        uint8_t mHeader[HEADER_SIZE] = { 0x68, 0x04, 0x00, 0x00, 0x00, 0x00 };
-        uint8_t mPayload[MAX_PAYLOAD_SIZE] = {};
+        // header and payload are stored contiguously, so the apdu can be viewed as a whole
+        uint8_t mData[ApduView::MAX_LENGTH] = { 0x68, 0x04, 0x00, 0x00, 0x00, 0x00 };
     };
 }
 
-#endif
\ No newline at end of file
+#endif
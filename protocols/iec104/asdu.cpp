@@ -2,6 +2,7 @@
 
 #include "core/util.hpp"
 #include "core/bytestream.hpp"
+#include "protocols/iec104/apdu.hpp"
 
 namespace IEC104
 {
@@ -34,120 +35,163 @@ namespace IEC104
         mReasonSize = aValue;
     }
 
-    Asdu::Asdu(const AsduConfig& arConfig)
-        : mConfig(arConfig)
+    void AsduHeader::ReadFrom(ByteStream& arBuffer, const AsduConfig& arConfig)
     {
+        Decode(arBuffer.ReadData(GetSize(arConfig)), arConfig);
     }
 
-    int Asdu::GetType() const
+    void AsduHeader::Decode(const uint8_t* apData, const AsduConfig& arConfig) noexcept
     {
-        return mType;
-    }
+        type = *apData++;
 
-    int Asdu::GetNumberOfInfoObjects() const noexcept
-    {
-        return mObjects.size();
+        uint8_t size_seq = *apData++;
+        size = (size_seq & 0x7F);
+        isSequence = (size_seq & 0x80);
+
+        reason = static_cast<ReasonCode>(*apData & 0x3F);
+        isNegative = (*apData & 0x40);
+        isTest = (*apData++ & 0x80);
+
+        if (arConfig.GetReasonSize() == 2)
+            origin = *apData++;
+
+        commonAddress = *apData++;
+
+        if (arConfig.GetCASize() == 2)
+            commonAddress += (*apData << 8);
     }
 
-    void Asdu::ReadFrom(ByteStream& arBuffer)
+    void AsduHeader::WriteTo(ByteStream& arBuffer, const AsduConfig& arConfig) const
     {
-        ReadHeader(arBuffer);
-        mObjects.clear();
+        arBuffer.WriteByte(type);
 
-        /*
-            * the standard defines 2 cases:
-            * 1. ASDU sequence-optimization is DISABLED -> each info object has its own address
-            * 2. ASDU sequence-optimization is ENABLED  -> only the 1st info object has an address
-            *    subsequent objects have an implicit address, which is incremented
-            */
-        int ioa_size = mConfig.GetIOASize(); // 1st address is always present
+        uint8_t size_seq = (size & 0x7F);
 
-        while (arBuffer.RemainingBytes() != 0)
-        {
-            if (mObjects.size() == mSize)
-                throw std::runtime_error("More data available than expected");
+        if (isSequence)
+            size_seq |= 0x80;
 
-            auto p_data = InfoObjectFactory::Create(mType);
-            mObjects.push_back(p_data);
-            p_data->ReadFrom(arBuffer, ioa_size);
+        arBuffer.WriteByte(size_seq);
 
-            if (mIsSequence)
-                ioa_size = 0;
-        }
+        uint8_t cause_neg_test = static_cast<uint8_t> (reason.GetValue());
+
+        if (isNegative)
+            cause_neg_test |= 0x40;
+        if (isTest)
+            cause_neg_test |= 0x80;
+
+        arBuffer.WriteByte(cause_neg_test);
+
+        if (arConfig.GetReasonSize() == 2)
+            arBuffer.WriteByte((origin & 0xFF));
+
+        arBuffer.WriteByte(commonAddress & 0xFF);
+
+        if (arConfig.GetCASize() == 2)
+            arBuffer.WriteByte(((commonAddress >> 8) & 0xFF));
     }
-    
-    void Asdu::WriteTo(ByteStream& arBuffer) const 
-    {
-        WriteHeader(arBuffer);
 
-        for (const auto& obj : mObjects) {
-            obj->WriteTo(arBuffer);
-        }
+    unsigned AsduHeader::GetSize(const AsduConfig& arConfig) noexcept
+    {
+        return 2 + arConfig.GetReasonSize() + arConfig.GetCASize();
     }
 
-    void Asdu::ReadHeader(ByteStream& arBuffer)
+    unsigned AsduHeader::GetExpectedSize(const AsduConfig& arConfig, int aDataSize) const noexcept
     {
-        mType = static_cast<IEC104::Type> (arBuffer.ReadByte());
+        unsigned result = GetSize(arConfig) + aDataSize * size;
 
-        if (!InfoObjectFactory::HasType(mType))
-            throw std::runtime_error("data type is not registered");
+        if (isSequence)
+            result += arConfig.GetIOASize();
+        else
+            result += arConfig.GetIOASize() * size;
 
-        uint8_t size_seq = arBuffer.ReadByte();
-        mSize = (size_seq & 0x7F);
-        mIsSequence = (size_seq & 0x80);
+        return result;
+    }
 
-        if (GetExpectedSize() != (arBuffer.RemainingBytes() + 2))
-            throw std::runtime_error("data size does not match the expected asdu size");
+    Asdu::Asdu(const AsduConfig& arConfig)
+        : mConfig(arConfig)
+    {
+    }
 
-        mReason = static_cast<ReasonCode>(arBuffer.ReadByte() & 0x3F);
+    int Asdu::GetType() const
+    {
+        return mHeader.type;
+    }
 
-        if (mConfig.GetReasonSize() == 2)
-            mOrigin = arBuffer.ReadByte();
+    int Asdu::GetNumberOfInfoObjects() const noexcept
+    {
+        return mObjects.size();
+    }
 
-        mCommonAddress = arBuffer.ReadByte();
+    void Asdu::ReadFrom(ByteStream& arBuffer)
+    {
+        // The ASDU spans all remaining bytes
+        const auto available = arBuffer.RemainingBytes();
+        Decode(arBuffer.DataBegin(), available);
+        arBuffer.ReadData(available);
+    }
+    
+    void Asdu::ReadFrom(const ApduView& arApdu)
+    {
+        if (!arApdu.HasPayload())
+            throw std::invalid_argument("apdu does not contain an asdu");
 
-        if (mConfig.GetCASize() == 2)
-            mCommonAddress += (arBuffer.ReadByte() << 8);
+        Decode(arApdu.PayloadBegin(), arApdu.PayloadLength());
     }
 
-    void Asdu::WriteHeader(ByteStream& arBuffer) const
+    void Asdu::WriteTo(ByteStream& arBuffer) const 
     {
-        arBuffer.WriteByte(mType);
-
-        uint8_t size_seq = (mSize & 0x7F);
+        mHeader.WriteTo(arBuffer, mConfig);
 
-        if (mIsSequence)
-            size_seq |= 0x80;
+        for (const auto& obj : mObjects) {
+            obj->WriteTo(arBuffer);
+        }
+    }
 
-        arBuffer.WriteByte(size_seq);
+    void Asdu::Decode(const uint8_t* apData, size_t aSize)
+    {
+        if (aSize < AsduHeader::GetSize(mConfig))
+            throw std::runtime_error("data size does not match the expected asdu size");
 
-        uint8_t cause_neg_test = static_cast<uint8_t> (mReason.GetValue());
-        // TODO negative, test...
-        arBuffer.WriteByte(cause_neg_test);
+        CORE::ByteCursor input(apData, aSize);
+        mHeader.Decode(input.ReadData(AsduHeader::GetSize(mConfig)), mConfig);
 
-        if (mConfig.GetReasonSize() == 2)
-            arBuffer.WriteByte((mOrigin & 0xFF));
+        if (!InfoObjectFactory::HasType(mHeader.type))
+            throw std::runtime_error("data type is not registered");
 
-        arBuffer.WriteByte(mCommonAddress & 0xFF);
+        // The only bound-check of the frame. Info objects decode without further checks.
+        if (mHeader.GetExpectedSize(mConfig, InfoObjectFactory::GetSize(mHeader.type)) != aSize)
+            throw std::runtime_error("data size does not match the expected asdu size");
 
-        if (mConfig.GetCASize() == 2)
-            arBuffer.WriteByte(((mCommonAddress >> 8) & 0xFF));
-    }
+        mObjects.clear();
+        mObjects.reserve(mHeader.size);
 
-    unsigned Asdu::GetExpectedSize() const
-    {
-        int result = 2 + mConfig.GetReasonSize() + mConfig.GetCASize();
+        /*
+            * the standard defines 2 cases:
+            * 1. ASDU sequence-optimization is DISABLED -> each info object has its own address
+            * 2. ASDU sequence-optimization is ENABLED  -> only the 1st info object has an address
+            *    subsequent objects have an implicit address, which is incremented
+            */
+        int ioa_size = mConfig.GetIOASize(); // 1st address is always present
 
-        if (InfoObjectFactory::HasType(mType))
+        for (int i = 0; i < mHeader.size; ++i)
         {
-            result += InfoObjectFactory::GetSize(mType) * mSize;
+            auto p_data = InfoObjectFactory::Create(mHeader.type);
+            p_data->Decode(input, ioa_size);
 
-            if (mIsSequence)
-                result += mConfig.GetIOASize();
-            else
-                result += mConfig.GetIOASize() * mSize;
+            // Implicit addresses are not encoded (size 0), but continue from the 1st address
+            if (mHeader.isSequence && !mObjects.empty())
+            {
+                auto implicit = mObjects.front()->GetAddress().GetInt() + static_cast<int>(mObjects.size());
+                p_data->SetAddress(InfoAddress(InfoAddress::Force::UNSTRUCTURED, implicit, 0));
+            }
+
+            mObjects.push_back(p_data);
+
+            if (mHeader.isSequence)
+                ioa_size = 0;
         }
 
-        return result;
+        if (input.RemainingBytes() != 0)
+            throw std::runtime_error("More data available than expected");
     }
 }
@@ -3,12 +3,16 @@
 
 
 #include <iterator>
+#include <vector>
+
 #include "protocols/iec104/infoobjects.hpp"
 
 class ByteStream;
 
 namespace IEC104
 {
+    class ApduView;
+
     class AsduConfig
     {
     public:
@@ -36,39 +40,64 @@ namespace IEC104
         int mIOASize;
     };
 
+    // Data unit identifier, which precedes the info objects of every ASDU
+    class AsduHeader
+    {
+    public:
+        void ReadFrom(ByteStream& arBuffer, const AsduConfig& arConfig);
+        // Decode from memory, which holds at least GetSize(arConfig) bytes
+        void Decode(const uint8_t* apData, const AsduConfig& arConfig) noexcept;
+        void WriteTo(ByteStream& arBuffer, const AsduConfig& arConfig) const;
+
+        // Encoded size of the header alone
+        static unsigned GetSize(const AsduConfig& arConfig) noexcept;
+        // Encoded size of the whole ASDU, if every info object has aDataSize bytes excluding its IOA
+        unsigned GetExpectedSize(const AsduConfig& arConfig, int aDataSize) const noexcept;
+
+        int type = Type::UNDEFINED;
+        int size = 0;
+        bool isSequence = false;
+        ReasonCodeEnum reason = ReasonCode::SPONTANEOUS;
+        // P/N bit: the requested activation was rejected
+        bool isNegative = false;
+        bool isTest = false;
+        int origin = 0;
+        int commonAddress = 0;
+    };
+
     class Asdu
     {
     public:
         Asdu(const AsduConfig& arConfig = AsduConfig::Defaults);
 
         void ReadFrom(ByteStream& arBuffer);
+        // Decode the payload of a received I-frame
+        void ReadFrom(const ApduView& arApdu);
         void WriteTo(ByteStream& arBuffer) const;
 
         int GetType() const;
         int GetNumberOfInfoObjects() const noexcept;
 
-        bool IsSequence() const {return mIsSequence;}
-        int GetObjectCount() const {return mSize;}
-        ReasonCodeEnum GetReason() const {return mReason;}
-        int GetAddress() const {return mCommonAddress;}
+        bool IsSequence() const {return mHeader.isSequence;}
+        int GetObjectCount() const {return mHeader.size;}
+        ReasonCodeEnum GetReason() const {return mHeader.reason;}
+        int GetAddress() const {return mHeader.commonAddress;}
+        const AsduHeader& GetHeader() const noexcept { return mHeader; }
+
+        // Info objects in their encoded order
+        std::vector<SharedInfoObject>::const_iterator begin() const noexcept { return mObjects.begin(); }
+        std::vector<SharedInfoObject>::const_iterator end() const noexcept { return mObjects.end(); }
 
         // TODO
         bool HasMoreSpace() const;
         int Append(const SharedInfoObject& arInfoObj);
 
     private:
-        void ReadHeader(ByteStream& arBuffer);
-        void WriteHeader(ByteStream& arBuffer) const;
-        unsigned GetExpectedSize() const;
+        // Decode a complete ASDU of aSize bytes
+        void Decode(const uint8_t* apData, size_t aSize);
     private:
         AsduConfig mConfig;
-
-        int mType = Type::UNDEFINED;
-        int mSize = 0;
-        bool mIsSequence = false;
-        ReasonCodeEnum mReason = ReasonCode::SPONTANEOUS;
-        int mOrigin = 0;
-        int mCommonAddress = 0;
+        AsduHeader mHeader;
         std::vector<SharedInfoObject> mObjects;
     };
 }
@@ -0,0 +1,165 @@
+#include "protocols/iec104/capture.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include "core/bytecursor.hpp"
+#include "core/clockwrapper.hpp"
+
+namespace ipc = boost::interprocess;
+
+namespace IEC104
+{
+    CaptureWriter::CaptureWriter(const std::string& arPath, size_t aChunkSize)
+        : mPath(arPath)
+    {
+        // A region starts up to a page before the next record, which has to fit in completely
+        const size_t page = ipc::mapped_region::get_page_size();
+        const size_t minimum = page + CaptureFormat::MAX_RECORD_SIZE;
+        mChunkSize = (std::max(aChunkSize, minimum) + page - 1) / page * page;
+
+        {
+            std::ofstream create(mPath, std::ios::binary | std::ios::trunc);
+            if (!create)
+                throw std::runtime_error("cannot create capture file " + mPath);
+        }
+
+        mOpen = true;
+        MapChunk(0);
+
+        auto* p_header = static_cast<uint8_t*>(mRegion.get_address());
+        std::memcpy(p_header, CaptureFormat::MAGIC, sizeof(CaptureFormat::MAGIC));
+        CORE::StoreLE<uint32_t>(p_header + 8, CaptureFormat::VERSION);
+        CORE::StoreLE<uint32_t>(p_header + 12, 0);
+        CORE::StoreLE<int64_t>(p_header + 16, VRTU::ClockWrapper::UtcNow().count());
+        mSize = CaptureFormat::FILE_HEADER_SIZE;
+    }
+
+    CaptureWriter::~CaptureWriter()
+    {
+        try
+        {
+            Close();
+        }
+        catch (...) {}
+    }
+
+    void CaptureWriter::Append(uint32_t aLink, CaptureDirection aDirection, std::span<const uint8_t> aFrame)
+    {
+        Append(aLink, aDirection, aFrame, std::chrono::steady_clock::now().time_since_epoch());
+    }
+
+    void CaptureWriter::Append(uint32_t aLink, CaptureDirection aDirection, std::span<const uint8_t> aFrame,
+                               std::chrono::nanoseconds aTimestamp)
+    {
+        if (!mOpen)
+            throw std::logic_error("capture is closed");
+
+        if (aFrame.empty() || aFrame.size() > CaptureFormat::MAX_RECORD_SIZE - CaptureFormat::RECORD_HEADER_SIZE)
+            throw std::invalid_argument("frame does not fit into a capture record");
+
+        const size_t record_size = CaptureFormat::RECORD_HEADER_SIZE + aFrame.size();
+
+        if (mSize + record_size > mRegionOffset + mRegion.get_size())
+            MapChunk(mSize);
+
+        auto* p_record = static_cast<uint8_t*>(mRegion.get_address()) + (mSize - mRegionOffset);
+
+        // The length is stored last. A reader never sees a record with a length, but without its frame.
+        std::memcpy(p_record + CaptureFormat::RECORD_HEADER_SIZE, aFrame.data(), aFrame.size());
+        CORE::StoreLE<int64_t>(p_record, aTimestamp.count());
+        CORE::StoreLE<uint32_t>(p_record + 8, aLink);
+        p_record[12] = static_cast<uint8_t>(aDirection);
+        p_record[13] = 0;
+        CORE::StoreLE<uint16_t>(p_record + 14, static_cast<uint16_t>(aFrame.size()));
+
+        mSize += record_size;
+        ++mRecords;
+    }
+
+    void CaptureWriter::Flush()
+    {
+        if (mOpen)
+            mRegion.flush();
+    }
+
+    void CaptureWriter::Close()
+    {
+        if (!mOpen)
+            return;
+
+        mOpen = false;
+        mRegion = ipc::mapped_region();
+        std::filesystem::resize_file(mPath, mSize);
+    }
+
+    void CaptureWriter::MapChunk(uint64_t aOffset)
+    {
+        // Regions start at a page boundary. The new region also covers the partially used page.
+        const size_t page = ipc::mapped_region::get_page_size();
+        const uint64_t region_offset = aOffset / page * page;
+
+        mRegion = ipc::mapped_region();
+        std::filesystem::resize_file(mPath, region_offset + mChunkSize);
+
+        ipc::file_mapping file(mPath.c_str(), ipc::read_write);
+        mRegion = ipc::mapped_region(file, ipc::read_write, region_offset, mChunkSize);
+        mRegionOffset = region_offset;
+    }
+
+    uint32_t CaptureWriter::LinkId(const Link& arLink)
+    {
+        auto [it, inserted] = mLinkIds.try_emplace(&arLink, mNextLinkId);
+        if (inserted)
+            ++mNextLinkId;
+
+        return it->second;
+    }
+
+    CaptureReader::CaptureReader(const std::string& arPath)
+    {
+        if (std::filesystem::file_size(arPath) < CaptureFormat::FILE_HEADER_SIZE)
+            throw std::runtime_error("capture file " + arPath + " is too small");
+
+        mFile = ipc::file_mapping(arPath.c_str(), ipc::read_only);
+        mRegion = ipc::mapped_region(mFile, ipc::read_only);
+
+        const auto* p_header = static_cast<const uint8_t*>(mRegion.get_address());
+
+        if (std::memcmp(p_header, CaptureFormat::MAGIC, sizeof(CaptureFormat::MAGIC)) != 0)
+            throw std::runtime_error(arPath + " is not a capture file");
+
+        if (CORE::LoadLE<uint32_t>(p_header + 8) != CaptureFormat::VERSION)
+            throw std::runtime_error("unsupported version of capture file " + arPath);
+
+        mCreated = std::chrono::milliseconds(CORE::LoadLE<int64_t>(p_header + 16));
+    }
+
+    bool CaptureReader::Next(size_t& arOffset, CaptureRecord& arRecord) const noexcept
+    {
+        if (arOffset + CaptureFormat::RECORD_HEADER_SIZE > Size())
+            return false;
+
+        CORE::ByteCursor input(static_cast<const uint8_t*>(mRegion.get_address()) + arOffset, Size() - arOffset);
+
+        const auto timestamp = input.ReadLE<int64_t>();
+        const auto link = input.ReadLE<uint32_t>();
+        const auto direction = input.ReadByte();
+        input.Skip(1);
+        const auto length = input.ReadLE<uint16_t>();
+
+        if (length == 0 || length > input.RemainingBytes() || direction > static_cast<uint8_t>(CaptureDirection::SENT))
+            return false;
+
+        arRecord.timestamp = std::chrono::nanoseconds(timestamp);
+        arRecord.link = link;
+        arRecord.direction = static_cast<CaptureDirection>(direction);
+        arRecord.frame = {input.ReadData(length), length};
+
+        arOffset += CaptureFormat::RECORD_HEADER_SIZE + length;
+        return true;
+    }
+}
@@ -0,0 +1,174 @@
+#ifndef IEC104_CAPTURE_HPP_
+#define IEC104_CAPTURE_HPP_
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#include "protocols/iec104/apdu.hpp"
+#include "protocols/iec104/link.hpp"
+
+namespace IEC104
+{
+    enum class CaptureDirection : uint8_t
+    {
+        // Frame received by the recorded link
+        RECEIVED = 0,
+        // Frame sent by the recorded link
+        SENT = 1
+    };
+
+    struct CaptureRecord
+    {
+        // Monotonic time of the capture
+        std::chrono::nanoseconds timestamp{};
+        uint32_t link = 0;
+        CaptureDirection direction = CaptureDirection::RECEIVED;
+        // Raw APDU. Points into the mapped file.
+        std::span<const uint8_t> frame;
+    };
+
+    /**
+     * @brief Layout of a capture file
+     *
+     * All integers are little-endian.
+     *   File header:   magic "VRTUCAP\0", u32 version, u32 reserved, u64 UTC of creation in ms
+     *   Record header: u64 monotonic timestamp in ns, u32 link, u8 direction, u8 reserved, u16 frame length
+     * Each record header is followed by its frame.
+     *
+     * The file is grown in chunks and truncated when it is closed. A record with length 0 ends the file,
+     * which happens, if the writer was not closed properly.
+     */
+    struct CaptureFormat
+    {
+        static constexpr uint8_t MAGIC[8] = { 'V', 'R', 'T', 'U', 'C', 'A', 'P', 0 };
+        static constexpr uint32_t VERSION = 1;
+        static constexpr size_t FILE_HEADER_SIZE = 24;
+        static constexpr size_t RECORD_HEADER_SIZE = 16;
+        static constexpr size_t MAX_RECORD_SIZE = RECORD_HEADER_SIZE + ApduView::MAX_LENGTH;
+    };
+
+    /**
+     * @brief Append-only, memory-mapped log of raw APDUs
+     *
+     * Appending copies the frame into the mapped file. It only calls into the system, when another chunk
+     * has to be mapped. Frames are visible to the system right away, so they survive a crash of the process.
+     *
+     * The writer is not synchronized. It can be attached to a Client or to a Server without workers,
+     * whose links all run on a single thread.
+     */
+    class CaptureWriter
+    {
+    public:
+        /**
+         * @param arPath File to be created or overwritten
+         * @param aChunkSize Size, by which the file is grown. Rounded up to whole pages, at least two.
+         */
+        explicit CaptureWriter(const std::string& arPath, size_t aChunkSize = 16 * 1024 * 1024);
+        ~CaptureWriter();
+
+        CaptureWriter(const CaptureWriter&)            = delete;
+        CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+        // Append a frame with the current monotonic time
+        void Append(uint32_t aLink, CaptureDirection aDirection, std::span<const uint8_t> aFrame);
+        void Append(uint32_t aLink, CaptureDirection aDirection, std::span<const uint8_t> aFrame,
+                    std::chrono::nanoseconds aTimestamp);
+
+        // Record the traffic of all links of a Server or Client. Each connection gets its own link id.
+        template <typename SOURCE>
+        void Attach(SOURCE& arSource)
+        {
+            if constexpr (requires { arSource.Workers(); })
+                if (arSource.Workers() > 0)
+                    throw std::invalid_argument("A capture can not be attached to the links of several workers");
+
+            arSource.SignalApduReceived.Register([this](Link& l, const ApduView& msg) {
+                Append(LinkId(l), CaptureDirection::RECEIVED, {msg.Data(), msg.Length()});
+            });
+            arSource.SignalApduSent.Register([this](Link& l, const Apdu& msg) {
+                Append(LinkId(l), CaptureDirection::SENT, {msg.View().Data(), msg.Length()});
+            });
+            arSource.SignalLinkStateChanged.Register([this](Link& l) {
+                if (!l.IsConnected())
+                    mLinkIds.erase(&l);
+            });
+        }
+
+        // Write the mapped pages to disk
+        void Flush();
+        // Truncate the file to its records and unmap it. Further appends throw.
+        void Close();
+
+        // Bytes written, including the file header
+        uint64_t Size() const noexcept { return mSize; }
+        uint64_t Records() const noexcept { return mRecords; }
+
+    private:
+        void MapChunk(uint64_t aOffset);
+        uint32_t LinkId(const Link& arLink);
+
+    private:
+        std::string mPath;
+        size_t mChunkSize;
+        boost::interprocess::mapped_region mRegion;
+        // File offset of the mapped region
+        uint64_t mRegionOffset = 0;
+        uint64_t mSize = 0;
+        uint64_t mRecords = 0;
+        bool mOpen = false;
+
+        std::unordered_map<const Link*, uint32_t> mLinkIds;
+        uint32_t mNextLinkId = 0;
+    };
+
+    // Read-only view of a capture file, which is mapped as a whole
+    class CaptureReader
+    {
+    public:
+        explicit CaptureReader(const std::string& arPath);
+
+        CaptureReader(const CaptureReader&)            = delete;
+        CaptureReader& operator=(const CaptureReader&) = delete;
+
+        // Offset of the first record
+        static constexpr size_t Begin() noexcept { return CaptureFormat::FILE_HEADER_SIZE; }
+
+        /**
+         * @brief Read the record at arOffset and advance the offset to the next one
+         * @return false at the end of the records, or if the record is truncated or malformed
+         */
+        bool Next(size_t& arOffset, CaptureRecord& arRecord) const noexcept;
+
+        // Visit every record as aVisitor(const CaptureRecord&). Returns the number of records.
+        template <typename VISITOR>
+        size_t ForEach(VISITOR&& aVisitor) const
+        {
+            size_t count = 0;
+            CaptureRecord record;
+
+            for (size_t offset = Begin(); Next(offset, record); ++count)
+                aVisitor(record);
+
+            return count;
+        }
+
+        std::chrono::milliseconds Created() const noexcept { return mCreated; }
+        size_t Size() const noexcept { return mRegion.get_size(); }
+
+    private:
+        boost::interprocess::file_mapping mFile;
+        boost::interprocess::mapped_region mRegion;
+        std::chrono::milliseconds mCreated{};
+    };
+}
+
+#endif
@@ -0,0 +1,261 @@
+#include "protocols/iec104/client.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/cobalt/join.hpp>
+#include <boost/cobalt/op.hpp>
+
+#include "core/clockwrapper.hpp"
+
+namespace IEC104
+{
+    // Backoff delays of up to a minute are covered within a single revolution
+    static constexpr std::chrono::milliseconds RETRY_RESOLUTION(100);
+    static constexpr size_t RETRY_SLOTS = 1024;
+
+    Backoff::Backoff(std::chrono::milliseconds aInitial, std::chrono::milliseconds aMaximum)
+        : mInitial(aInitial), mMaximum(aMaximum)
+    {
+        if (aInitial.count() <= 0 || aMaximum < aInitial)
+            throw std::invalid_argument("backoff needs a positive initial delay, which does not exceed the maximum");
+    }
+
+    std::chrono::milliseconds Backoff::Limit() const noexcept
+    {
+        // Doubling stops, once the maximum is reached. This also keeps the shift in range.
+        auto limit = mInitial;
+        for (unsigned i = 0; i < mAttempts && limit < mMaximum; ++i)
+            limit *= 2;
+
+        return std::min(limit, mMaximum);
+    }
+
+    // Free of members: a cancelled attempt completes after its outstation may be gone
+    static async::promise<asio::ip::tcp::socket> ConnectTo(asio::ip::tcp::endpoint aEndpoint)
+    {
+        asio::ip::tcp::socket socket(co_await asio::this_coro::executor);
+        co_await socket.async_connect(aEndpoint, async::use_op);
+        co_return socket;
+    }
+
+    // Failures are handled by the timer supervision of the link
+    static async::promise<void> Activate(Link& arLink)
+    {
+        try
+        {
+            co_await arLink.Start();
+        }
+        catch (...) {}
+    }
+
+    Client::Client(std::chrono::milliseconds aMinBackoff, std::chrono::milliseconds aMaxBackoff)
+        : mBackoff(aMinBackoff, aMaxBackoff)
+        , mRandom(std::random_device{}())
+        , mRetries(RETRY_RESOLUTION, RETRY_SLOTS, VRTU::ClockWrapper::UtcNow())
+        , mLinks(VRTU::ClockWrapper::UtcNow())
+    {
+    }
+
+    Client::~Client()
+    {
+        // The links run on the executor of the current thread, which cannot be run from here.
+        // Their pending operations complete with operation_aborted after the client is gone,
+        // and neither touch the links nor the client, see Link::Flush and Tick.
+        mLinks.Abort();
+    }
+
+    Client::OutstationId Client::AddOutstation(std::vector<asio::ip::tcp::endpoint> aEndpoints, const ConnectionConfig& arConfig)
+    {
+        if (aEndpoints.empty())
+            throw std::invalid_argument("an outstation needs at least one endpoint");
+
+        mOutstations.push_back(std::make_unique<Outstation>(std::move(aEndpoints), arConfig, mBackoff));
+
+        if (mStarted)
+            mRetries.Schedule(mOutstations.back()->retry, VRTU::ClockWrapper::UtcNow());
+
+        return mOutstations.size() - 1;
+    }
+
+    void Client::Start()
+    {
+        if (mStarted)
+            return;
+
+        mStarted = true;
+        auto now = VRTU::ClockWrapper::UtcNow();
+
+        for (auto& p_outstation : mOutstations)
+            mRetries.Schedule(p_outstation->retry, now);
+    }
+
+    async::promise<void> Client::Tick()
+    {
+        // Held by the coroutine, which may resume after the client was destroyed
+        std::weak_ptr<Client*> alive = mAlive;
+
+        try
+        {
+            auto now = VRTU::ClockWrapper::UtcNow();
+
+            mLinks.RemoveDisconnected();
+            mRetries.Advance(now, [this, now](Outstation& o) { BeginConnect(o, now); });
+
+            // New links are started within the tick, so they are not removed while STARTDT is written
+            auto established = CompleteConnects(now);
+            if (!established.empty())
+            {
+                std::vector<async::promise<void>> promises;
+                for (auto* p_link : established)
+                    promises.push_back(Activate(*p_link));
+
+                co_await async::join(promises);
+
+                // Activate swallows all failures, also those of links, which were aborted by the destruction of the client
+                if (alive.expired())
+                    co_return;
+            }
+
+            co_await mLinks.Tick();
+        }
+        catch (...) {}
+        co_return;
+    }
+
+    Link* Client::Find(OutstationId aId)
+    {
+        return mLinks.Find(Get(aId).link);
+    }
+
+    const asio::ip::tcp::endpoint& Client::ActiveEndpoint(OutstationId aId) const
+    {
+        const auto& outstation = Get(aId);
+        return outstation.endpoints[outstation.active];
+    }
+
+    void Client::Switchover(OutstationId aId)
+    {
+        auto& outstation = Get(aId);
+        auto now = VRTU::ClockWrapper::UtcNow();
+
+        // Switching over is not a failure of the next endpoint
+        outstation.failures = 0;
+
+        if (auto* p_link = mLinks.Find(outstation.link))
+        {
+            // Notifies OnLinkStateChanged, which moves on to the next endpoint
+            p_link->Close();
+        }
+        else if (outstation.connecting)
+        {
+            outstation.connecting.reset();
+            std::erase(mConnecting, &outstation);
+            Failed(outstation, now);
+        }
+        else if (outstation.retry.IsScheduled())
+        {
+            outstation.active = (outstation.active + 1) % outstation.endpoints.size();
+            mRetries.Schedule(outstation.retry, now);
+        }
+    }
+
+    Client::Outstation& Client::Get(OutstationId aId) const
+    {
+        if (aId >= mOutstations.size())
+            throw std::out_of_range("unknown outstation");
+
+        return *mOutstations[aId];
+    }
+
+    void Client::BeginConnect(Outstation& arOutstation, std::chrono::milliseconds aNow)
+    {
+        arOutstation.connecting.emplace(ConnectTo(arOutstation.endpoints[arOutstation.active]));
+        arOutstation.connectingSince = aNow;
+        mConnecting.push_back(&arOutstation);
+    }
+
+    std::vector<Link*> Client::CompleteConnects(std::chrono::milliseconds aNow)
+    {
+        std::vector<Link*> established;
+
+        std::erase_if(mConnecting, [&](Outstation* p_outstation) {
+            auto& outstation = *p_outstation;
+
+            if (outstation.connecting->ready())
+            {
+                try
+                {
+                    auto socket = outstation.connecting->get();
+                    outstation.connecting.reset();
+                    established.push_back(&Connect(outstation, std::move(socket)));
+                }
+                catch (...)
+                {
+                    outstation.connecting.reset();
+                    Failed(outstation, aNow);
+                }
+                return true;
+            }
+
+            // T0 expired. Destroying the attempt cancels it.
+            if (aNow - outstation.connectingSince >= std::chrono::seconds(outstation.config.GetT0()))
+            {
+                outstation.connecting.reset();
+                Failed(outstation, aNow);
+                return true;
+            }
+
+            return false;
+        });
+
+        return established;
+    }
+
+    Link& Client::Connect(Outstation& arOutstation, asio::ip::tcp::socket&& arSocket)
+    {
+        arOutstation.link = mLinks.Add(std::move(arSocket), Link::Mode::Master, arOutstation.config);
+        auto& link = *mLinks.Find(arOutstation.link);
+
+        link.SignalApduReceived.Register([this](auto& l, auto& msg) { SignalApduReceived(l, msg); });
+        link.SignalApduSent    .Register([this](auto& l, auto& msg) { SignalApduSent(l, msg);     });
+        link.SignalTickFinished.Register([this](auto& l)            { SignalLinkTickFinished(l);  });
+        link.SignalStateChanged.Register([this, &arOutstation](auto& l) { OnLinkStateChanged(arOutstation, l); });
+
+        link.Run();
+        return link;
+    }
+
+    void Client::Failed(Outstation& arOutstation, std::chrono::milliseconds aNow)
+    {
+        arOutstation.active = (arOutstation.active + 1) % arOutstation.endpoints.size();
+
+        // The remaining endpoints of the group are tried right away
+        if (++arOutstation.failures < arOutstation.endpoints.size())
+        {
+            mRetries.Schedule(arOutstation.retry, aNow);
+            return;
+        }
+
+        arOutstation.failures = 0;
+        mRetries.Schedule(arOutstation.retry, aNow + arOutstation.backoff.Next(mRandom));
+    }
+
+    void Client::OnLinkStateChanged(Outstation& arOutstation, Link& l)
+    {
+        // Only a connection, which was confirmed by STARTDT_CON, counts as success
+        if (l.IsActive())
+        {
+            arOutstation.backoff.Reset();
+            arOutstation.failures = 0;
+        }
+        else if (!l.IsConnected() && arOutstation.link.IsValid())
+        {
+            // The link is removed with the next tick
+            arOutstation.link = LinkGroup::Handle();
+            Failed(arOutstation, VRTU::ClockWrapper::UtcNow());
+        }
+
+        SignalLinkStateChanged(l);
+    }
+}
@@ -0,0 +1,172 @@
+#ifndef IEC104_CLIENT_HPP_
+#define IEC104_CLIENT_HPP_
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/cobalt/promise.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "core/timerwheel.hpp"
+#include "protocols/iec104/connectionconfig.hpp"
+#include "protocols/iec104/link.hpp"
+#include "protocols/iec104/server.hpp"
+
+namespace asio = boost::asio;
+namespace async = boost::cobalt;
+
+namespace IEC104
+{
+    class Apdu;
+    class ApduView;
+
+    /**
+     * @brief Delays between connection attempts
+     *
+     * The delay doubles with every attempt up to a limit. Each delay is drawn from the upper half of its range,
+     * so outstations, which were lost at the same time, do not reconnect in lockstep.
+     */
+    class Backoff
+    {
+    public:
+        explicit Backoff(std::chrono::milliseconds aInitial, std::chrono::milliseconds aMaximum);
+
+        // Delay before the next attempt
+        template <typename RANDOM>
+        std::chrono::milliseconds Next(RANDOM& arRandom)
+        {
+            const auto limit = Limit();
+            ++mAttempts;
+
+            std::uniform_int_distribution<std::chrono::milliseconds::rep> jitter(limit.count() / 2, limit.count());
+            return std::chrono::milliseconds(jitter(arRandom));
+        }
+
+        // Start over with the initial delay, e.g. after a successful connection
+        void Reset() noexcept { mAttempts = 0; }
+
+        unsigned Attempts() const noexcept { return mAttempts; }
+        // Upper bound of the next delay
+        std::chrono::milliseconds Limit() const noexcept;
+
+    private:
+        std::chrono::milliseconds mInitial;
+        std::chrono::milliseconds mMaximum;
+        unsigned mAttempts = 0;
+    };
+
+    /**
+     * @brief Controlling station, which keeps connections to any number of outstations
+     *
+     * Each outstation is reached by a redundancy group of endpoints. Only one of them is connected at a time.
+     * A failed attempt or a lost connection switches over to the next endpoint of the group.
+     * Once every endpoint has failed, the next round waits for a jittered exponential backoff.
+     * Data transfer is started with STARTDT as soon as a connection is established.
+     *
+     * All connections run on the executor of the current thread. Connection attempts, backoff and
+     * timer supervision are driven by Tick, so no thread or timer is needed per outstation.
+     */
+    class Client
+    {
+    public:
+        using OutstationId = size_t;
+
+        // Forwarded from child links
+        CORE::SignalEveryone<void, Link&> SignalLinkStateChanged;
+        // Forwarded from child links
+        CORE::SignalEveryone<void, Link&> SignalLinkTickFinished;
+        // Forwarded from child links
+        CORE::SignalEveryone<void, Link&, const Apdu&> SignalApduSent;
+        // Forwarded from child links
+        CORE::SignalEveryone<void, Link&, const ApduView&> SignalApduReceived;
+
+        /**
+         * @param aMinBackoff Delay after the first round of failed attempts
+         * @param aMaxBackoff Limit of the delay
+         */
+        explicit Client(std::chrono::milliseconds aMinBackoff = std::chrono::seconds(1),
+                        std::chrono::milliseconds aMaxBackoff = std::chrono::seconds(60));
+        ~Client();
+
+        Client(const Client&)            = delete;
+        Client& operator=(const Client&) = delete;
+
+        // Links refer to the client
+        Client(Client&&)                 = delete;
+        Client& operator=(Client&&)      = delete;
+
+        /**
+         * @brief Add an outstation with its redundancy group
+         * @param aEndpoints Endpoints of the outstation in the order of preference
+         * @param arConfig Configuration of its links. T0 limits each connection attempt.
+         */
+        OutstationId AddOutstation(std::vector<asio::ip::tcp::endpoint> aEndpoints,
+                                   const ConnectionConfig& arConfig = ConnectionConfig());
+
+        // Start connecting all outstations, including those added later
+        void Start();
+
+        // Single tick of connection management and timer supervision for all links
+        async::promise<void> Tick();
+
+        // Link of the outstation. nullptr, while it is not connected.
+        Link* Find(OutstationId aId);
+        // Endpoint of the current connection or the next attempt
+        const asio::ip::tcp::endpoint& ActiveEndpoint(OutstationId aId) const;
+        // Drop the connection of the outstation and connect to the next endpoint of its group
+        void Switchover(OutstationId aId);
+
+        size_t Outstations() const noexcept { return mOutstations.size(); }
+        size_t Connected() const noexcept { return mLinks.Size(); }
+
+    private:
+        struct Outstation
+        {
+            Outstation(std::vector<asio::ip::tcp::endpoint>&& arEndpoints, const ConnectionConfig& arConfig, const Backoff& arBackoff)
+                : endpoints(std::move(arEndpoints)), config(arConfig), backoff(arBackoff) {}
+
+            std::vector<asio::ip::tcp::endpoint> endpoints;
+            ConnectionConfig config;
+            Backoff backoff;
+            // Index of the endpoint in use
+            size_t active = 0;
+            // Endpoints, which failed in the current round
+            size_t failures = 0;
+            LinkGroup::Handle link;
+
+            std::optional<async::promise<asio::ip::tcp::socket>> connecting;
+            std::chrono::milliseconds connectingSince{};
+            // Time of the next attempt
+            CORE::TimerWheel<Outstation>::Entry retry{*this};
+        };
+
+        Outstation& Get(OutstationId aId) const;
+
+        void BeginConnect(Outstation& arOutstation, std::chrono::milliseconds aNow);
+        // Connection attempts, which completed or timed out. Returns the links to be started.
+        std::vector<Link*> CompleteConnects(std::chrono::milliseconds aNow);
+        Link& Connect(Outstation& arOutstation, asio::ip::tcp::socket&& arSocket);
+        void Failed(Outstation& arOutstation, std::chrono::milliseconds aNow);
+        void OnLinkStateChanged(Outstation& arOutstation, Link& l);
+
+    private:
+        Backoff mBackoff;
+        std::minstd_rand mRandom;
+        bool mStarted = false;
+
+        // Declared before the outstations, which unregister themselves on destruction.
+        CORE::TimerWheel<Outstation> mRetries;
+        std::vector<std::unique_ptr<Outstation>> mOutstations;
+        std::vector<Outstation*> mConnecting;
+
+        // Declared after the outstations, which are referred to by the signals of the links
+        LinkGroup mLinks;
+        // Expires with the client, so a tick, which resumes afterwards, does not touch it
+        std::shared_ptr<Client*> mAlive = std::make_shared<Client*>(this);
+    };
+}
+#endif
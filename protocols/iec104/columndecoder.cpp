@@ -0,0 +1,213 @@
+#include "protocols/iec104/columndecoder.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "protocols/iec104/inforecords.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace IEC104
+{
+    namespace ColumnDecoder
+    {
+        namespace
+        {
+            template <typename RECORD, typename VALUE, typename Kernel>
+            size_t DecodeSequence(const uint8_t* apAsdu, size_t aSize, const AsduConfig& arConfig,
+                                  AsduHeader& arHeader, const Columns<VALUE>& arColumns, Kernel aKernel)
+            {
+                const auto header_size = AsduHeader::GetSize(arConfig);
+
+                if (aSize < header_size)
+                    throw std::runtime_error("data size does not match the expected asdu size");
+
+                AsduHeader header;
+                header.Decode(apAsdu, arConfig);
+
+                if (header.type != RECORD::TYPE_ID)
+                    throw std::invalid_argument("asdu type does not match the column type");
+
+                if (!header.isSequence)
+                    throw std::invalid_argument("column decoding requires a sequence asdu");
+
+                if (header.GetExpectedSize(arConfig, RECORD::DATA_SIZE) != aSize)
+                    throw std::runtime_error("data size does not match the expected asdu size");
+
+                const auto count = static_cast<size_t>(header.size);
+
+                if (count > arColumns.capacity)
+                    throw std::invalid_argument("columns are too small for the asdu");
+
+                const uint8_t* p_objects = apAsdu + header_size;
+                const int ioa_size = arConfig.GetIOASize();
+
+                if (arColumns.addresses)
+                    FillAddresses(ReadRecordAddress(p_objects, ioa_size), count, arColumns.addresses);
+
+                aKernel(p_objects + ioa_size, count, arColumns.values, arColumns.qualities);
+                arHeader = header;
+                return count;
+            }
+
+            void DeinterleaveFloatScalar(const uint8_t* apSource, size_t aCount, float* apValues, uint8_t* apQualities) noexcept
+            {
+                RecordMeasuredFloat record;
+
+                for (size_t i = 0; i < aCount; ++i, apSource += RecordMeasuredFloat::DATA_SIZE)
+                {
+                    record.Decode(apSource);
+                    apValues[i] = record.val;
+                    apQualities[i] = record.q.GetEncoded();
+                }
+            }
+
+            void DeinterleaveScaledScalar(const uint8_t* apSource, size_t aCount, int16_t* apValues, uint8_t* apQualities) noexcept
+            {
+                RecordMeasuredScaled record;
+
+                for (size_t i = 0; i < aCount; ++i, apSource += RecordMeasuredScaled::DATA_SIZE)
+                {
+                    record.Decode(apSource);
+                    apValues[i] = record.val;
+                    apQualities[i] = record.q.GetEncoded();
+                }
+            }
+
+#if defined(__SSSE3__)
+            // The masks gather value and quality bytes of consecutive elements. 0x80 clears a byte.
+            // Float: 4 elements (20 bytes) are covered by two loads at offset 0 and 4.
+            inline __m128i FloatValuesLow()   { return _mm_setr_epi8(0, 1, 2, 3, 5, 6, 7, 8, 10, 11, 12, 13, -128, -128, -128, -128); }
+            inline __m128i FloatValuesHigh()  { return _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 11, 12, 13, 14); }
+            inline __m128i FloatQualityLow()  { return _mm_setr_epi8(4, 9, 14, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128); }
+            inline __m128i FloatQualityHigh() { return _mm_setr_epi8(-128, -128, -128, 15, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128); }
+            // Scaled: 4 elements (12 bytes) from a single load. Values in bytes 0-7, qualities in bytes 8-11.
+            inline __m128i ScaledShuffle()    { return _mm_setr_epi8(0, 1, 3, 4, 6, 7, 9, 10, 2, 5, 8, 11, -128, -128, -128, -128); }
+
+            inline void StoreQualities(uint8_t* apDest, int aPacked) noexcept
+            {
+                std::memcpy(apDest, &aPacked, sizeof(aPacked));
+            }
+#endif
+        }
+
+        void DeinterleaveFloat(const uint8_t* apSource, size_t aCount, float* apValues, uint8_t* apQualities) noexcept
+        {
+            size_t i = 0;
+
+#if defined(__AVX2__)
+            {
+                const __m256i values_low   = _mm256_broadcastsi128_si256(FloatValuesLow());
+                const __m256i values_high  = _mm256_broadcastsi128_si256(FloatValuesHigh());
+                const __m256i quality_low  = _mm256_broadcastsi128_si256(FloatQualityLow());
+                const __m256i quality_high = _mm256_broadcastsi128_si256(FloatQualityHigh());
+
+                // 8 elements (40 bytes) per iteration, 4 in each lane
+                for (; i + 8 <= aCount; i += 8, apSource += 40)
+                {
+                    const __m256i low  = _mm256_loadu2_m128i(reinterpret_cast<const __m128i*>(apSource + 20),
+                                                             reinterpret_cast<const __m128i*>(apSource));
+                    const __m256i high = _mm256_loadu2_m128i(reinterpret_cast<const __m128i*>(apSource + 24),
+                                                             reinterpret_cast<const __m128i*>(apSource + 4));
+
+                    const __m256i values = _mm256_or_si256(_mm256_shuffle_epi8(low, values_low), _mm256_shuffle_epi8(high, values_high));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(apValues + i), values);
+
+                    const __m256i quality = _mm256_or_si256(_mm256_shuffle_epi8(low, quality_low), _mm256_shuffle_epi8(high, quality_high));
+                    StoreQualities(apQualities + i,     _mm256_extract_epi32(quality, 0));
+                    StoreQualities(apQualities + i + 4, _mm256_extract_epi32(quality, 4));
+                }
+            }
+#endif
+
+#if defined(__SSSE3__)
+            {
+                const __m128i values_low   = FloatValuesLow();
+                const __m128i values_high  = FloatValuesHigh();
+                const __m128i quality_low  = FloatQualityLow();
+                const __m128i quality_high = FloatQualityHigh();
+
+                // 4 elements (20 bytes) per iteration
+                for (; i + 4 <= aCount; i += 4, apSource += 20)
+                {
+                    const __m128i low  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(apSource));
+                    const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(apSource + 4));
+
+                    const __m128i values = _mm_or_si128(_mm_shuffle_epi8(low, values_low), _mm_shuffle_epi8(high, values_high));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(apValues + i), values);
+
+                    const __m128i quality = _mm_or_si128(_mm_shuffle_epi8(low, quality_low), _mm_shuffle_epi8(high, quality_high));
+                    StoreQualities(apQualities + i, _mm_cvtsi128_si32(quality));
+                }
+            }
+#endif
+
+            DeinterleaveFloatScalar(apSource, aCount - i, apValues + i, apQualities + i);
+        }
+
+        void DeinterleaveScaled(const uint8_t* apSource, size_t aCount, int16_t* apValues, uint8_t* apQualities) noexcept
+        {
+            size_t i = 0;
+
+#if defined(__AVX2__)
+            {
+                const __m256i shuffle = _mm256_broadcastsi128_si256(ScaledShuffle());
+
+                // 8 elements (24 bytes) per iteration. The upper lane loads up to byte 28, which must stay inside the elements.
+                for (; (aCount - i) * 3 >= 28; i += 8, apSource += 24)
+                {
+                    const __m256i data = _mm256_loadu2_m128i(reinterpret_cast<const __m128i*>(apSource + 12),
+                                                             reinterpret_cast<const __m128i*>(apSource));
+                    const __m256i gathered = _mm256_shuffle_epi8(data, shuffle);
+
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(apValues + i),     _mm256_castsi256_si128(gathered));
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(apValues + i + 4), _mm256_extracti128_si256(gathered, 1));
+                    StoreQualities(apQualities + i,     _mm256_extract_epi32(gathered, 2));
+                    StoreQualities(apQualities + i + 4, _mm256_extract_epi32(gathered, 6));
+                }
+            }
+#endif
+
+#if defined(__SSSE3__)
+            {
+                const __m128i shuffle = ScaledShuffle();
+
+                // 4 elements (12 bytes) per iteration. The load of 16 bytes must stay inside the elements.
+                for (; (aCount - i) * 3 >= 16; i += 4, apSource += 12)
+                {
+                    const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(apSource));
+                    const __m128i gathered = _mm_shuffle_epi8(data, shuffle);
+
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(apValues + i), gathered);
+                    StoreQualities(apQualities + i, _mm_cvtsi128_si32(_mm_srli_si128(gathered, 8)));
+                }
+            }
+#endif
+
+            DeinterleaveScaledScalar(apSource, aCount - i, apValues + i, apQualities + i);
+        }
+
+        void FillAddresses(uint32_t aFirst, size_t aCount, uint32_t* apAddresses) noexcept
+        {
+            // simple enough to be vectorized by the compiler
+            for (size_t i = 0; i < aCount; ++i)
+                apAddresses[i] = aFirst + static_cast<uint32_t>(i);
+        }
+
+        size_t Decode(const uint8_t* apAsdu, size_t aSize, const AsduConfig& arConfig,
+                      AsduHeader& arHeader, const Columns<float>& arColumns)
+        {
+            return DecodeSequence<RecordMeasuredFloat>(apAsdu, aSize, arConfig, arHeader, arColumns, DeinterleaveFloat);
+        }
+
+        size_t Decode(const uint8_t* apAsdu, size_t aSize, const AsduConfig& arConfig,
+                      AsduHeader& arHeader, const Columns<int16_t>& arColumns)
+        {
+            return DecodeSequence<RecordMeasuredScaled>(apAsdu, aSize, arConfig, arHeader, arColumns, DeinterleaveScaled);
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef IEC104_COLUMNDECODER_HPP_
+#define IEC104_COLUMNDECODER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "protocols/iec104/asdu.hpp"
+
+namespace IEC104
+{
+    /**
+     * @brief Bulk decoder for measured value ASDUs in sequence mode (SQ=1)
+     *
+     * In sequence mode the info elements of M_ME_NB_1 and M_ME_NC_1 form a dense array with a fixed stride.
+     * The decoder deinterleaves it into separate columns for values, qualities and implicit addresses.
+     *
+     * The kernels use SSSE3 or AVX2, if the library is compiled for it (see VRTU_NATIVE),
+     * and a scalar loop otherwise.
+     */
+    namespace ColumnDecoder
+    {
+        // The number of objects is encoded with 7 bits
+        static constexpr size_t MAX_OBJECTS = 127;
+
+        // Caller provided columns. Each must hold at least the number of objects of the ASDU.
+        template <typename VALUE>
+        struct Columns
+        {
+            VALUE* values       = nullptr;
+            uint8_t* qualities  = nullptr;
+            // optional
+            uint32_t* addresses = nullptr;
+            size_t capacity     = 0;
+        };
+
+        /**
+         * @brief Decode a complete M_ME_NC_1 or M_ME_NB_1 ASDU with SQ=1
+         *
+         * @param apAsdu Encoded ASDU, starting with the type id
+         * @param aSize Size of the encoded ASDU
+         * @param arHeader Receives the decoded header
+         * @return Number of decoded objects
+         * @throw std::invalid_argument if the ASDU has another type, is not a sequence or exceeds the capacity
+         * @throw std::runtime_error if the size does not match the header
+         */
+        size_t Decode(const uint8_t* apAsdu, size_t aSize, const AsduConfig& arConfig,
+                      AsduHeader& arHeader, const Columns<float>& arColumns);
+        size_t Decode(const uint8_t* apAsdu, size_t aSize, const AsduConfig& arConfig,
+                      AsduHeader& arHeader, const Columns<int16_t>& arColumns);
+
+        // Kernels: Deinterleave aCount elements without any checks
+        void DeinterleaveFloat(const uint8_t* apSource, size_t aCount, float* apValues, uint8_t* apQualities) noexcept;
+        void DeinterleaveScaled(const uint8_t* apSource, size_t aCount, int16_t* apValues, uint8_t* apQualities) noexcept;
+        void FillAddresses(uint32_t aFirst, size_t aCount, uint32_t* apAddresses) noexcept;
+    }
+}
+
+#endif
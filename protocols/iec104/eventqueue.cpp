@@ -0,0 +1,159 @@
+#include "protocols/iec104/eventqueue.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "core/bytestream.hpp"
+#include "protocols/iec104/apdu.hpp"
+#include "protocols/iec104/typedasdu.hpp"
+
+namespace IEC104
+{
+    EventQueue::EventQueue(size_t aCapacity)
+        : mCapacity(aCapacity)
+        , mColumns(Column<RecordSinglePoint>(aCapacity, EventPolicy::KEEP_ALL),
+                   Column<RecordDoublePoint>(aCapacity, EventPolicy::KEEP_ALL),
+                   Column<RecordMeasuredScaled>(aCapacity, EventPolicy::KEEP_LATEST),
+                   Column<RecordMeasuredFloat>(aCapacity, EventPolicy::KEEP_LATEST))
+    {
+        if (aCapacity == 0 || aCapacity > std::numeric_limits<uint32_t>::max())
+            throw std::invalid_argument("capacity of the event queue is out of range");
+    }
+
+    bool EventQueue::Next(ByteStream& arOutput, const AsduConfig& arConfig)
+    {
+        // The column with the oldest change is encoded, until it reaches the oldest change of another column
+        std::optional<uint64_t> oldest;
+        std::optional<uint64_t> second;
+
+        std::apply([&](auto&... columns) {
+            auto consider = [&](const std::optional<uint64_t>& arCandidate) {
+                if (!arCandidate)
+                    return;
+
+                if (!oldest || *arCandidate < *oldest)
+                {
+                    second = oldest;
+                    oldest = arCandidate;
+                }
+                else if (!second || *arCandidate < *second)
+                {
+                    second = arCandidate;
+                }
+            };
+            (consider(columns.Oldest()), ...);
+        }, mColumns);
+
+        if (!oldest)
+            return false;
+
+        const uint64_t limit = second.value_or(std::numeric_limits<uint64_t>::max());
+        size_t encoded = 0;
+
+        std::apply([&](auto&... columns) {
+            auto encode = [&](auto& arColumn) {
+                if (encoded == 0 && arColumn.Oldest() == oldest)
+                    encoded = arColumn.Encode(arOutput, arConfig, limit);
+            };
+            (encode(columns), ...);
+        }, mColumns);
+
+        mCounters.sent += encoded;
+        return true;
+    }
+
+    size_t EventQueue::Size() const noexcept
+    {
+        return std::apply([](const auto&... columns) { return (columns.Size() + ...); }, mColumns);
+    }
+
+    void EventQueue::Clear() noexcept
+    {
+        std::apply([](auto&... columns) { (columns.Clear(), ...); }, mColumns);
+    }
+
+    template <typename RECORD>
+    bool EventQueue::Column<RECORD>::Push(int aCommonAddress, const RECORD& arRecord, uint64_t aSequence, EventCounters& arCounters)
+    {
+        if (mRing.empty())
+            mRing.resize(mCapacity);
+
+        const auto key = Key(aCommonAddress, arRecord.address);
+
+        if (mPolicy == EventPolicy::KEEP_LATEST)
+        {
+            if (!mPending)
+                mPending.emplace(mCapacity);
+
+            if (auto* p_slot = mPending->Find(key))
+            {
+                mRing[*p_slot].record = arRecord;
+                ++arCounters.queued;
+                ++arCounters.coalesced;
+                return true;
+            }
+        }
+
+        if (mSize == mCapacity)
+        {
+            ++arCounters.overflowed;
+            return false;
+        }
+
+        const auto slot = Slot(mSize++);
+        mRing[slot] = Event{aSequence, aCommonAddress, arRecord};
+
+        if (mPolicy == EventPolicy::KEEP_LATEST)
+            mPending->Insert(key, static_cast<uint32_t>(slot));
+
+        ++arCounters.queued;
+        return true;
+    }
+
+    template <typename RECORD>
+    size_t EventQueue::Column<RECORD>::Encode(ByteStream& arOutput, const AsduConfig& arConfig, uint64_t aLimit)
+    {
+        if (mSize == 0)
+            return 0;
+
+        TypedAsdu<RECORD> asdu(arConfig);
+        auto& header = asdu.GetHeader();
+        header.reason = ReasonCode::SPONTANEOUS;
+        header.commonAddress = mRing[mHead].commonAddress;
+
+        // Changes are sent with their own IOA (SQ=0)
+        while (mSize > 0 && asdu.HasMoreSpace())
+        {
+            const auto& event = mRing[mHead];
+
+            if (event.sequence >= aLimit || event.commonAddress != header.commonAddress)
+                break;
+
+            asdu.Append(event.record);
+
+            if (mPending && mPolicy == EventPolicy::KEEP_LATEST)
+                mPending->Erase(Key(event.commonAddress, event.record.address));
+
+            mHead = Slot(1);
+            --mSize;
+        }
+
+        asdu.WriteTo(arOutput);
+        return asdu.Size();
+    }
+
+    template <typename RECORD>
+    void EventQueue::Column<RECORD>::Clear() noexcept
+    {
+        mHead = 0;
+        mSize = 0;
+
+        if (mPending)
+            mPending->Clear();
+    }
+
+    template class EventQueue::Column<RecordSinglePoint>;
+    template class EventQueue::Column<RecordDoublePoint>;
+    template class EventQueue::Column<RecordMeasuredScaled>;
+    template class EventQueue::Column<RecordMeasuredFloat>;
+}
@@ -0,0 +1,162 @@
+#ifndef IEC104_EVENTQUEUE_HPP_
+#define IEC104_EVENTQUEUE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "core/fixedhashmap.hpp"
+#include "protocols/iec104/asdu.hpp"
+#include "protocols/iec104/inforecords.hpp"
+
+class ByteStream;
+
+namespace IEC104
+{
+    enum class EventPolicy
+    {
+        // Every change is sent in order
+        KEEP_ALL,
+        // A pending change of a point is overwritten by its next change. It keeps its place in the queue.
+        KEEP_LATEST
+    };
+
+    struct EventCounters
+    {
+        // Accepted changes, including coalesced ones
+        uint64_t queued = 0;
+        // Changes, which overwrote a pending change of the same point
+        uint64_t coalesced = 0;
+        // Changes, which were dropped, because the queue of their type was full
+        uint64_t overflowed = 0;
+        // Changes, which were encoded for transmission
+        uint64_t sent = 0;
+    };
+
+    /**
+     * @brief Bounded queue of spontaneous changes (COT 3) of a single link
+     *
+     * Each type has its own queue with a fixed capacity and policy. By default measured values keep only
+     * their latest change, while single and double points keep every change.
+     * Memory for a type is allocated, when its first change is pushed. Afterwards pushing never allocates.
+     *
+     * Changes are packed into ASDUs only when they are about to be sent, so a link pulls as many
+     * as its k-window allows. The order of changes is kept across all types.
+     *
+     * The queue is not synchronized. Use it from the thread of its link.
+     */
+    class EventQueue
+    {
+    public:
+        // Capacity of each type
+        explicit EventQueue(size_t aCapacity = 1024);
+
+        template <typename RECORD>
+        void SetPolicy(EventPolicy aPolicy) { Get<RECORD>().SetPolicy(aPolicy); }
+
+        template <typename RECORD>
+        EventPolicy GetPolicy() const noexcept { return Get<RECORD>().GetPolicy(); }
+
+        // Queue a change. false, if it was dropped because of an overflow.
+        template <typename RECORD>
+        bool Push(int aCommonAddress, const RECORD& arRecord)
+        {
+            return Get<RECORD>().Push(aCommonAddress, arRecord, mNextSequence++, mCounters);
+        }
+
+        /**
+         * @brief Encode the oldest changes into the next ASDU
+         *
+         * An ASDU holds changes of a single type and station with SQ=0, as many as fit into an APDU.
+         * @return false, if no change is pending
+         */
+        bool Next(ByteStream& arOutput, const AsduConfig& arConfig);
+
+        // Number of pending changes
+        size_t Size() const noexcept;
+        bool Empty() const noexcept { return Size() == 0; }
+        // Drop all pending changes, e.g. when the connection is lost. A general interrogation restores the state.
+        void Clear() noexcept;
+
+        size_t Capacity() const noexcept { return mCapacity; }
+        const EventCounters& Counters() const noexcept { return mCounters; }
+
+    private:
+        // Queue of a single type. A ring, which is allocated on first use.
+        template <typename RECORD>
+        class Column
+        {
+        public:
+            explicit Column(size_t aCapacity, EventPolicy aPolicy)
+                : mCapacity(aCapacity), mPolicy(aPolicy) {}
+
+            void SetPolicy(EventPolicy aPolicy)
+            {
+                if (mSize != 0)
+                    throw std::logic_error("cannot change the policy of a queue with pending events");
+                mPolicy = aPolicy;
+            }
+
+            EventPolicy GetPolicy() const noexcept { return mPolicy; }
+
+            bool Push(int aCommonAddress, const RECORD& arRecord, uint64_t aSequence, EventCounters& arCounters);
+            // Encode pending changes up to the change with sequence aLimit. Returns the number of encoded changes.
+            size_t Encode(ByteStream& arOutput, const AsduConfig& arConfig, uint64_t aLimit);
+
+            // Sequence of the oldest pending change
+            std::optional<uint64_t> Oldest() const noexcept
+            {
+                return mSize ? std::optional<uint64_t>(mRing[mHead].sequence) : std::nullopt;
+            }
+
+            size_t Size() const noexcept { return mSize; }
+            void Clear() noexcept;
+
+        private:
+            struct Event
+            {
+                uint64_t sequence = 0;
+                int commonAddress = 0;
+                RECORD record;
+            };
+
+            // Points are identified by station and IOA
+            static uint64_t Key(int aCommonAddress, uint32_t aAddress) noexcept
+            {
+                return (static_cast<uint64_t>(aCommonAddress) << 24) | aAddress;
+            }
+
+            size_t Slot(size_t aIndex) const noexcept { return (mHead + aIndex) % mCapacity; }
+
+            size_t mCapacity;
+            EventPolicy mPolicy;
+            std::vector<Event> mRing;
+            size_t mHead = 0;
+            size_t mSize = 0;
+            // Ring slot of each pending point, if the latest change is kept
+            std::optional<CORE::FixedHashMap<uint64_t, uint32_t>> mPending;
+        };
+
+        using Columns = std::tuple<Column<RecordSinglePoint>,
+                                   Column<RecordDoublePoint>,
+                                   Column<RecordMeasuredScaled>,
+                                   Column<RecordMeasuredFloat>>;
+
+        template <typename RECORD>
+        Column<RECORD>& Get() noexcept { return std::get<Column<RECORD>>(mColumns); }
+
+        template <typename RECORD>
+        const Column<RECORD>& Get() const noexcept { return std::get<Column<RECORD>>(mColumns); }
+
+    private:
+        size_t mCapacity;
+        Columns mColumns;
+        uint64_t mNextSequence = 0;
+        EventCounters mCounters;
+    };
+}
+
+#endif
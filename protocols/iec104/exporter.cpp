@@ -0,0 +1,447 @@
+#include "protocols/iec104/exporter.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <string_view>
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/cobalt/op.hpp>
+#include <boost/cobalt/this_thread.hpp>
+
+namespace IEC104
+{
+    namespace
+    {
+        // Requests are only read up to the end of their header
+        constexpr size_t REQUEST_LIMIT = 8 * 1024;
+
+        constexpr std::string_view FORMAT_LABELS[LinkMetrics::FORMATS] = { "i", "s", "u" };
+
+        enum Family : size_t
+        {
+            CONNECTIONS_ACCEPTED,
+            CONNECTIONS_CLOSED,
+            LINKS,
+            LINKS_ACTIVE,
+            APDUS_RECEIVED,
+            RECEIVED_BYTES,
+            APDUS_SENT,
+            SENT_BYTES,
+            DECODE_ERRORS,
+            T1_EXPIRED,
+            T2_ACKS,
+            SEND_QUEUE,
+            SEND_QUEUE_DEPTH,
+            RECEIVE_SECONDS,
+            TIMER_SECONDS,
+            LINK_ACTIVE,
+            LINK_K,
+            LINK_W,
+            LINK_SEND_QUEUE,
+            LINK_APDUS_RECEIVED,
+            LINK_RECEIVED_BYTES,
+            LINK_APDUS_SENT,
+            LINK_SENT_BYTES,
+            LINK_DECODE_ERRORS,
+            LINK_T1_EXPIRED,
+            FAMILY_COUNT
+        };
+
+        struct FamilyInfo
+        {
+            std::string_view name;
+            std::string_view type;
+            std::string_view unit;
+            std::string_view help;
+            // Rendered once per link, otherwise once for the totals
+            bool perLink;
+        };
+
+        constexpr FamilyInfo FAMILIES[FAMILY_COUNT] = {
+            { "vrtu_connections_accepted", "counter",   "",        "Connections accepted by the listener", false },
+            { "vrtu_connections_closed",   "counter",   "",        "Connections closed by either side", false },
+            { "vrtu_links",                "gauge",     "",        "Connected links", false },
+            { "vrtu_links_active",         "gauge",     "",        "Links with started data transfer", false },
+            { "vrtu_apdus_received",       "counter",   "",        "APDUs received by all links", false },
+            { "vrtu_received_bytes",       "counter",   "bytes",   "Bytes of APDUs received by all links", false },
+            { "vrtu_apdus_sent",           "counter",   "",        "APDUs sent by all links", false },
+            { "vrtu_sent_bytes",           "counter",   "bytes",   "Bytes of APDUs sent by all links", false },
+            { "vrtu_decode_errors",        "counter",   "",        "Received data, which could not be handled", false },
+            { "vrtu_t1_expired",           "counter",   "",        "Links closed, because the peer did not acknowledge in time", false },
+            { "vrtu_t2_acks",              "counter",   "",        "Acknowledges sent, because T2 expired", false },
+            { "vrtu_send_queue",           "gauge",     "",        "I-Frames waiting for transmission on all links", false },
+            { "vrtu_send_queue_depth",     "histogram", "",        "Send queue depth of a link after each change", false },
+            { "vrtu_receive_seconds",      "histogram", "seconds", "Time spent to handle a single read", false },
+            { "vrtu_timer_seconds",        "histogram", "seconds", "Time spent to check the timers of a link", false },
+            { "vrtu_link_active",          "gauge",     "",        "Data transfer of the link is started", true },
+            { "vrtu_link_k",               "gauge",     "",        "Sent I-Frames, which are not acknowledged by the peer", true },
+            { "vrtu_link_w",               "gauge",     "",        "Received I-Frames, which are not acknowledged yet", true },
+            { "vrtu_link_send_queue",      "gauge",     "",        "I-Frames waiting for transmission", true },
+            { "vrtu_link_apdus_received",  "counter",   "",        "APDUs received by the link", true },
+            { "vrtu_link_received_bytes",  "counter",   "bytes",   "Bytes of APDUs received by the link", true },
+            { "vrtu_link_apdus_sent",      "counter",   "",        "APDUs sent by the link", true },
+            { "vrtu_link_sent_bytes",      "counter",   "bytes",   "Bytes of APDUs sent by the link", true },
+            { "vrtu_link_decode_errors",   "counter",   "",        "Received data, which could not be handled", true },
+            { "vrtu_link_t1_expired",      "counter",   "",        "The peer did not acknowledge in time", true },
+        };
+
+        template <typename T>
+        void AppendNumber(std::string& arOut, T aValue)
+        {
+            char buf[32];
+            auto result = std::to_chars(buf, buf + sizeof(buf), aValue);
+            arOut.append(buf, result.ptr);
+        }
+
+        // Label values escape backslash, double quote and line feed
+        void AppendEscaped(std::string& arOut, std::string_view aValue)
+        {
+            for (char c : aValue)
+            {
+                switch (c)
+                {
+                case '\\': arOut += "\\\\"; break;
+                case '"':  arOut += "\\\""; break;
+                case '\n': arOut += "\\n";  break;
+                default:   arOut += c;
+                }
+            }
+        }
+
+        void AppendHeader(std::string& arOut, const FamilyInfo& arFamily)
+        {
+            arOut.append("# TYPE ").append(arFamily.name).append(" ").append(arFamily.type).append("\n");
+            if (!arFamily.unit.empty())
+                arOut.append("# UNIT ").append(arFamily.name).append(" ").append(arFamily.unit).append("\n");
+            arOut.append("# HELP ").append(arFamily.name).append(" ").append(arFamily.help).append("\n");
+        }
+
+        template <typename T>
+        void AppendSample(std::string& arOut, const FamilyInfo& arFamily, std::string_view aSuffix, std::string_view aLabels, T aValue)
+        {
+            arOut.append(arFamily.name).append(aSuffix);
+            if (!aLabels.empty())
+                arOut.append("{").append(aLabels).append("}");
+            arOut += ' ';
+            AppendNumber(arOut, aValue);
+            arOut += '\n';
+        }
+
+        // Counter sample per frame format
+        void AppendFormats(std::string& arOut, const FamilyInfo& arFamily, std::string_view aLabels,
+                           const std::array<uint64_t, LinkMetrics::FORMATS>& arValues)
+        {
+            std::string labels(aLabels);
+            if (!labels.empty())
+                labels += ',';
+            const size_t prefix = labels.size();
+
+            for (size_t i = 0; i < LinkMetrics::FORMATS; ++i)
+            {
+                labels.resize(prefix);
+                labels.append("format=\"").append(FORMAT_LABELS[i]).append("\"");
+                AppendSample(arOut, arFamily, "_total", labels, arValues[i]);
+            }
+        }
+
+        // Buckets up to the last one in use. aDivisor converts the recorded values into the unit of the family.
+        void AppendHistogram(std::string& arOut, const FamilyInfo& arFamily, const CORE::Histogram::Snapshot& arHistogram, double aDivisor)
+        {
+            size_t used = CORE::Histogram::BUCKETS;
+            while (used > 0 && arHistogram.buckets[used - 1] == 0)
+                --used;
+
+            std::string labels;
+            uint64_t cumulative = 0;
+
+            for (size_t i = 0; i < used; ++i)
+            {
+                cumulative += arHistogram.buckets[i];
+                labels = "le=\"";
+                AppendNumber(labels, static_cast<double>(CORE::Histogram::UpperBound(i)) / aDivisor);
+                labels += '"';
+                AppendSample(arOut, arFamily, "_bucket", labels, cumulative);
+            }
+
+            AppendSample(arOut, arFamily, "_bucket", "le=\"+Inf\"", arHistogram.count);
+            AppendSample(arOut, arFamily, "_count", "", arHistogram.count);
+            AppendSample(arOut, arFamily, "_sum", "", static_cast<double>(arHistogram.sum) / aDivisor);
+        }
+
+        void AppendTotals(std::string& arOut, Family aFamily, const ExportStatus& arTotals, const std::vector<const LinkStatus*>& arLinks)
+        {
+            const auto& family = FAMILIES[aFamily];
+            const auto& metrics = arTotals.totals;
+
+            switch (aFamily)
+            {
+            case CONNECTIONS_ACCEPTED: AppendSample(arOut, family, "_total", "", arTotals.accepted); break;
+            case CONNECTIONS_CLOSED:   AppendSample(arOut, family, "_total", "", arTotals.closed); break;
+            case LINKS:                AppendSample(arOut, family, "", "", arLinks.size()); break;
+            case LINKS_ACTIVE:
+                AppendSample(arOut, family, "", "", std::count_if(arLinks.begin(), arLinks.end(), [](auto* p) { return p->active; }));
+                break;
+            case APDUS_RECEIVED:       AppendFormats(arOut, family, "", metrics.apdusReceived); break;
+            case RECEIVED_BYTES:       AppendFormats(arOut, family, "", metrics.bytesReceived); break;
+            case APDUS_SENT:           AppendFormats(arOut, family, "", metrics.apdusSent); break;
+            case SENT_BYTES:           AppendFormats(arOut, family, "", metrics.bytesSent); break;
+            case DECODE_ERRORS:        AppendSample(arOut, family, "_total", "", metrics.decodeErrors); break;
+            case T1_EXPIRED:           AppendSample(arOut, family, "_total", "", metrics.t1Expired); break;
+            case T2_ACKS:              AppendSample(arOut, family, "_total", "", metrics.t2Acks); break;
+            case SEND_QUEUE:           AppendSample(arOut, family, "", "", metrics.sendQueue); break;
+            case SEND_QUEUE_DEPTH:     AppendHistogram(arOut, family, metrics.sendQueueDepth, 1.0); break;
+            case RECEIVE_SECONDS:      AppendHistogram(arOut, family, metrics.receiveTime, 1e9); break;
+            case TIMER_SECONDS:        AppendHistogram(arOut, family, metrics.timerTime, 1e9); break;
+            default:                   break;
+            }
+        }
+
+        void AppendLink(std::string& arOut, Family aFamily, const LinkStatus& arLink)
+        {
+            const auto& family = FAMILIES[aFamily];
+            const auto& metrics = arLink.metrics;
+
+            std::string labels = "peer=\"";
+            AppendEscaped(labels, arLink.peer);
+            labels += '"';
+
+            switch (aFamily)
+            {
+            case LINK_ACTIVE:          AppendSample(arOut, family, "", labels, arLink.active ? 1 : 0); break;
+            case LINK_K:               AppendSample(arOut, family, "", labels, arLink.k); break;
+            case LINK_W:               AppendSample(arOut, family, "", labels, arLink.w); break;
+            case LINK_SEND_QUEUE:      AppendSample(arOut, family, "", labels, arLink.queued); break;
+            case LINK_APDUS_RECEIVED:  AppendFormats(arOut, family, labels, metrics.apdusReceived); break;
+            case LINK_RECEIVED_BYTES:  AppendFormats(arOut, family, labels, metrics.bytesReceived); break;
+            case LINK_APDUS_SENT:      AppendFormats(arOut, family, labels, metrics.apdusSent); break;
+            case LINK_SENT_BYTES:      AppendFormats(arOut, family, labels, metrics.bytesSent); break;
+            case LINK_DECODE_ERRORS:   AppendSample(arOut, family, "_total", labels, metrics.decodeErrors); break;
+            case LINK_T1_EXPIRED:      AppendSample(arOut, family, "_total", labels, metrics.t1Expired); break;
+            default:                   break;
+            }
+        }
+    }
+
+    OpenMetricsRenderer::OpenMetricsRenderer(std::vector<std::shared_ptr<const ExportStatus>> aStatus)
+        : mStatus(std::move(aStatus))
+    {
+        for (const auto& p_status : mStatus)
+        {
+            mTotals.totals += p_status->totals;
+            mTotals.accepted += p_status->accepted;
+            mTotals.closed += p_status->closed;
+
+            for (const auto& r_link : p_status->links)
+                mLinks.push_back(&r_link);
+        }
+    }
+
+    bool OpenMetricsRenderer::Next(std::string& arOut, size_t aChunkSize)
+    {
+        if (mFamily > FAMILY_COUNT)
+            return false;
+
+        const size_t limit = arOut.size() + aChunkSize;
+
+        while (mFamily < FAMILY_COUNT && arOut.size() < limit)
+        {
+            const auto family = static_cast<Family>(mFamily);
+
+            if (mHeader)
+            {
+                AppendHeader(arOut, FAMILIES[family]);
+                mHeader = false;
+            }
+
+            if (FAMILIES[family].perLink && mLink < mLinks.size())
+            {
+                AppendLink(arOut, family, *mLinks[mLink++]);
+                continue;
+            }
+
+            if (!FAMILIES[family].perLink)
+                AppendTotals(arOut, family, mTotals, mLinks);
+
+            ++mFamily;
+            mLink = 0;
+            mHeader = true;
+        }
+
+        if (mFamily == FAMILY_COUNT && arOut.size() < limit)
+        {
+            arOut += "# EOF\n";
+            ++mFamily;
+        }
+
+        return true;
+    }
+
+    bool MetricsExporter::Source::Due(std::chrono::milliseconds aNow) noexcept
+    {
+        if (aNow < mNext)
+            return false;
+
+        mNext = aNow + mInterval;
+        return true;
+    }
+
+    void MetricsExporter::Source::Publish(std::shared_ptr<const ExportStatus> aStatus) noexcept
+    {
+        mStatus.store(std::move(aStatus), std::memory_order_release);
+    }
+
+    std::shared_ptr<const ExportStatus> MetricsExporter::Source::Latest() const noexcept
+    {
+        return mStatus.load(std::memory_order_acquire);
+    }
+
+    MetricsExporter::MetricsExporter(const asio::ip::address& arIp, uint16_t aPort, std::chrono::milliseconds aInterval,
+                                     std::chrono::milliseconds aScrapeTimeout)
+        : mInterval(aInterval)
+        , mScrapeTimeout(aScrapeTimeout)
+        , mListener(mContext, {arIp, aPort})
+        , mLocalPort(mListener.local_endpoint().port())
+        , mThread([this] { Run(); })
+    {
+    }
+
+    MetricsExporter::~MetricsExporter()
+    {
+        // The context runs out of work, once the aborted scrape has completed
+        asio::post(mContext, [this] {
+            mAcceptLoop.reset();
+            boost::system::error_code ec;
+            mListener.close(ec);
+            mWork.reset();
+        });
+
+        mThread.join();
+    }
+
+    MetricsExporter::Source& MetricsExporter::AddSource()
+    {
+        std::lock_guard lock(mSourceMutex);
+        return mSources.emplace_back(mInterval);
+    }
+
+    std::vector<std::shared_ptr<const ExportStatus>> MetricsExporter::Latest() const
+    {
+        std::vector<std::shared_ptr<const ExportStatus>> result;
+        std::lock_guard lock(mSourceMutex);
+
+        for (const auto& r_source : mSources)
+        {
+            if (auto p_status = r_source.Latest())
+                result.push_back(std::move(p_status));
+        }
+
+        return result;
+    }
+
+    void MetricsExporter::Run()
+    {
+        async::this_thread::set_executor(mContext.get_executor());
+        mAcceptLoop.emplace(AcceptLoop());
+        mContext.run();
+    }
+
+    async::promise<void> MetricsExporter::AcceptLoop()
+    {
+        try
+        {
+            for (;;)
+            {
+                auto peer = co_await mListener.async_accept(async::use_op);
+
+                try
+                {
+                    co_await Serve(std::move(peer));
+                }
+                // The scraper went away. Serve the next one, unless the exporter shuts down.
+                catch (const boost::system::system_error& e)
+                {
+                    if (e.code() == asio::error::operation_aborted)
+                        throw;
+                }
+            }
+        }
+        // Cancelled by the shutdown of the exporter. Do not touch any member.
+        catch (...) {}
+    }
+
+    async::promise<void> MetricsExporter::Serve(asio::ip::tcp::socket aSocket)
+    {
+        // Shared with the deadline, whose handler may still be queued, when the scrape has already ended
+        struct Scrape
+        {
+            asio::ip::tcp::socket socket;
+            bool expired = false;
+        };
+
+        auto p_scrape = std::make_shared<Scrape>(std::move(aSocket));
+
+        // Closing the socket aborts the pending read or write of the scrape
+        asio::steady_timer deadline(p_scrape->socket.get_executor(), mScrapeTimeout);
+        deadline.async_wait([wp_scrape = std::weak_ptr<Scrape>(p_scrape)](const boost::system::error_code& ec) {
+            auto p_expired = wp_scrape.lock();
+            if (ec || !p_expired)
+                return;
+
+            p_expired->expired = true;
+            boost::system::error_code ignored;
+            p_expired->socket.close(ignored);
+        });
+
+        try
+        {
+            co_await Respond(p_scrape->socket);
+        }
+        catch (const boost::system::system_error&)
+        {
+            if (!p_scrape->expired)
+                throw;
+        }
+    }
+
+    async::promise<void> MetricsExporter::Respond(asio::ip::tcp::socket& arSocket)
+    {
+        std::string request;
+        char buf[1024];
+
+        while (request.find("\r\n\r\n") == std::string::npos)
+        {
+            if (request.size() > REQUEST_LIMIT)
+                co_return;
+
+            auto read = co_await arSocket.async_read_some(asio::buffer(buf), async::use_op);
+            request.append(buf, read);
+        }
+
+        constexpr std::string_view PATH = "GET /metrics";
+        const bool found = request.starts_with(PATH) && (request[PATH.size()] == ' ' || request[PATH.size()] == '?');
+
+        if (!found)
+        {
+            constexpr std::string_view NOT_FOUND = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+            co_await asio::async_write(arSocket, asio::buffer(NOT_FOUND), async::use_op);
+            co_return;
+        }
+
+        // The length is unknown, while the body is rendered. It ends with the connection.
+        std::string chunk = "HTTP/1.1 200 OK\r\n"
+                            "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+                            "Connection: close\r\n\r\n";
+
+        OpenMetricsRenderer renderer(Latest());
+        while (renderer.Next(chunk))
+        {
+            co_await asio::async_write(arSocket, asio::buffer(chunk), async::use_op);
+            chunk.clear();
+        }
+
+        boost::system::error_code ec;
+        arSocket.shutdown(asio::socket_base::shutdown_send, ec);
+    }
+}
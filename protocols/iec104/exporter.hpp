@@ -0,0 +1,159 @@
+#ifndef IEC104_EXPORTER_HPP_
+#define IEC104_EXPORTER_HPP_
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/cobalt/promise.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "protocols/iec104/linkmetrics.hpp"
+
+namespace asio = boost::asio;
+namespace async = boost::cobalt;
+
+namespace IEC104
+{
+    // State of a single link at the time of a snapshot
+    struct LinkStatus
+    {
+        // Remote endpoint as "ip:port"
+        std::string peer;
+        bool active = false;
+        int k = 0;
+        int w = 0;
+        size_t queued = 0;
+        LinkMetrics::Snapshot metrics;
+    };
+
+    /**
+     * @brief Snapshot of a group of links
+     *
+     * Taken by the thread, which runs the links, and never modified once it was published.
+     */
+    struct ExportStatus
+    {
+        // Links, which were connected at the time of the snapshot
+        std::vector<LinkStatus> links;
+        // Sum of all links of the group, including the removed ones
+        LinkMetrics::Snapshot totals;
+        // Connections of the listener. Only set by the group, which accepts them.
+        uint64_t accepted = 0;
+        uint64_t closed = 0;
+    };
+
+    /**
+     * @brief Renders snapshots in the OpenMetrics text format, a chunk at a time
+     *
+     * Totals are rendered as vrtu_* families, each link as vrtu_link_* families with a peer label.
+     * Only a chunk of text is held at any time, regardless of the number of links.
+     */
+    class OpenMetricsRenderer
+    {
+    public:
+        explicit OpenMetricsRenderer(std::vector<std::shared_ptr<const ExportStatus>> aStatus);
+
+        // Append at least aChunkSize bytes, unless the end is reached. False, once everything was rendered.
+        bool Next(std::string& arOut, size_t aChunkSize = 16 * 1024);
+
+    private:
+        std::vector<std::shared_ptr<const ExportStatus>> mStatus;
+        std::vector<const LinkStatus*> mLinks;
+        ExportStatus mTotals;
+        size_t mFamily = 0;
+        // Next link of a per-link family
+        size_t mLink = 0;
+        bool mHeader = true;
+    };
+
+    /**
+     * @brief Serves the published snapshots over HTTP in the OpenMetrics text format
+     *
+     * The exporter runs on a thread of its own. Protocol threads only swap the pointer of their latest snapshot,
+     * they never wait for a scrape. A scrape is served from the snapshots, which were current at its start.
+     *
+     * Scrapes are answered one after another, so it is meant to listen on localhost for a single scraper.
+     * A scrape, which is not answered within its timeout, is closed, so a stalled client can not hold up the next one.
+     */
+    class MetricsExporter
+    {
+    public:
+        static constexpr uint16_t DEFAULT_PORT = 9104;
+
+        // Latest snapshot of a single publisher
+        class Source
+        {
+        public:
+            explicit Source(std::chrono::milliseconds aInterval) noexcept
+                : mInterval(aInterval) {}
+
+            // True, if the interval has elapsed since the last publication. Only called by the publisher.
+            bool Due(std::chrono::milliseconds aNow) noexcept;
+            void Publish(std::shared_ptr<const ExportStatus> aStatus) noexcept;
+            // nullptr, if nothing was published yet
+            std::shared_ptr<const ExportStatus> Latest() const noexcept;
+
+        private:
+            std::atomic<std::shared_ptr<const ExportStatus>> mStatus;
+            const std::chrono::milliseconds mInterval;
+            std::chrono::milliseconds mNext{0};
+        };
+
+        /**
+         * @param arIp Local address to listen on
+         * @param aPort Local port to listen on. With 0, any free port is used.
+         * @param aInterval Minimum time between two snapshots of a publisher
+         * @param aScrapeTimeout Maximum time from the accept of a scrape until its response was sent
+         */
+        explicit MetricsExporter(const asio::ip::address& arIp = asio::ip::address_v4::loopback(),
+                                 uint16_t aPort = DEFAULT_PORT,
+                                 std::chrono::milliseconds aInterval = std::chrono::seconds(1),
+                                 std::chrono::milliseconds aScrapeTimeout = std::chrono::seconds(5));
+        ~MetricsExporter();
+
+        MetricsExporter(const MetricsExporter&)            = delete;
+        MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+        // Add a publisher. The source lives as long as the exporter.
+        Source& AddSource();
+        // Latest snapshots of all publishers
+        std::vector<std::shared_ptr<const ExportStatus>> Latest() const;
+
+        uint16_t LocalPort() const noexcept { return mLocalPort; }
+
+    private:
+        void Run();
+        async::promise<void> AcceptLoop();
+        // Respond within the scrape timeout
+        async::promise<void> Serve(asio::ip::tcp::socket aSocket);
+        async::promise<void> Respond(asio::ip::tcp::socket& arSocket);
+
+    private:
+        const std::chrono::milliseconds mInterval;
+        const std::chrono::milliseconds mScrapeTimeout;
+        mutable std::mutex mSourceMutex;
+        // A deque keeps the sources in place
+        std::deque<Source> mSources;
+
+        asio::io_context mContext;
+        asio::executor_work_guard<asio::io_context::executor_type> mWork{mContext.get_executor()};
+        asio::ip::tcp::acceptor mListener;
+        uint16_t mLocalPort = 0;
+        std::optional<async::promise<void>> mAcceptLoop;
+        // declared last: started after all other members are initialized
+        std::thread mThread;
+    };
+}
+
+#endif
@@ -4,55 +4,42 @@
 #include <stdexcept>
 
 #include "core/bytestream.hpp"
+#include "core/util.hpp"
 #include "protocols/iec104/quality.hpp"
 
 namespace IEC104
 {
-    // Static initialization
-    std::map<InfoObjectFactory::LookupKey, int>        InfoObjectFactory::msRegistered;
-    std::vector<std::function<SharedInfoObject(void)>> InfoObjectFactory::msFunctions;
-    std::vector<int>                                   InfoObjectFactory::msSizes;
+    // Static initialization: zero-initialized, before any dynamic initialization takes place
+    std::array<InfoObjectFactory::Entry, 256> InfoObjectFactory::msEntries;
+    std::atomic<bool>                         InfoObjectFactory::msFrozen{false};
 
     SharedInfoObject
     InfoObjectFactory::Create(uint8_t aType)
     {
-        auto it_found = msRegistered.find(LookupKey(aType, LookupKey::ANY_PRIORITY));
+        auto create = msEntries[aType].create;
 
-        if (it_found == msRegistered.end())
+        if (!create)
             throw std::out_of_range("Creation function not found");
 
-        auto& CreateFunction = msFunctions[it_found->second];
-        return CreateFunction();
+        return create();
     }
 
     void
-    InfoObjectFactory::RegisterInfoObject(int aType, int aPriority, int aInfoElementSize,
-                                          const std::function<SharedInfoObject(void)>& arCreateFunction)
+    InfoObjectFactory::RegisterInfoObject(int aType, int aPriority, int aInfoElementSize, CreateFunction apCreateFunction)
     {
-        auto it_found = msRegistered.find(LookupKey(aType, LookupKey::ANY_PRIORITY));
+        if (IsFrozen())
+            throw std::logic_error("info objects cannot be registered after the factory was frozen");
 
-        if (it_found == msRegistered.end() || 
-            it_found->first.GetPriority() < aPriority)
-        {
-            msFunctions.push_back(arCreateFunction);
-            msSizes.push_back(aInfoElementSize);
-            msRegistered[LookupKey(aType, aPriority)] = msFunctions.size() - 1;
-        }
-    }
+        UTIL::AssertRange(0, 255, aType);
 
-    int InfoObjectFactory::GetSize(uint8_t aType) noexcept
-    {
-        auto it_found = msRegistered.find(LookupKey(aType, LookupKey::ANY_PRIORITY));
+        if (!apCreateFunction)
+            throw std::invalid_argument("nullptr creation function");
 
-        if (it_found == msRegistered.cend())
-            return 0;
-        else
-            return msSizes[it_found->second];
-    }
+        auto& entry = msEntries[aType];
 
-    bool InfoObjectFactory::HasType(uint8_t aType) noexcept
-    {
-        return msRegistered.find(LookupKey(aType, LookupKey::ANY_PRIORITY)) != msRegistered.cend();
+        // Higher priorities override existing registrations (EXTERNAL over INTERNAL)
+        if (!entry.create || entry.priority < aPriority)
+            entry = Entry{apCreateFunction, aInfoElementSize, aPriority};
     }
 
     BaseInfoObject::BaseInfoObject(int aTypeId)
@@ -89,115 +76,146 @@ namespace IEC104
         mAddress.WriteTo(arOutput);
     }
 
+    void BaseInfoObject::Decode(CORE::ByteCursor& arInput, int aAddressSize)
+    {
+        // Slow path for types, which only implement ReadFrom
+        const auto size = static_cast<size_t>(aAddressSize + InfoObjectFactory::GetSize(static_cast<uint8_t>(mType)));
+        const uint8_t* p_encoded = arInput.ReadData(size);
+
+        ByteStream input(p_encoded, p_encoded + size);
+        ReadFrom(input, aAddressSize);
+    }
+
+    void BaseInfoObject::DecodeAddress(CORE::ByteCursor& arInput, int aAddressSize) noexcept
+    {
+        if (aAddressSize == 0)
+            mAddress = InfoAddress();
+        else
+            mAddress = InfoAddress(InfoAddress::Force::UNSTRUCTURED,
+                                   static_cast<int>(ReadRecordAddress(arInput.ReadData(aAddressSize), aAddressSize)),
+                                   aAddressSize);
+    }
+
+    namespace
+    {
+        // Decode an info element from a validated frame, using the layout of its record
+        template <typename RECORD>
+        RECORD ReadRecord(CORE::ByteCursor& arInput) noexcept
+        {
+            RECORD record;
+            record.Decode(arInput.ReadData(RECORD::DATA_SIZE));
+            return record;
+        }
+
+        template <typename RECORD>
+        void WriteRecord(ByteStream& arOutput, const RECORD& arRecord)
+        {
+            uint8_t encoded[RECORD::DATA_SIZE];
+            arRecord.Encode(encoded);
+            arOutput.WriteData(encoded, RECORD::DATA_SIZE);
+        }
+    }
+
     // Type 1: M_SP_NA_1 ////////////////////////////////////////////////////////////
     void DataSinglePoint::ReadFrom(ByteStream& arInput, int aAddressSize)
     {
-        BaseInfoObject::ReadFrom(arInput, aAddressSize);
+        auto input = arInput.ReadCursor(static_cast<size_t>(aAddressSize + DATA_SIZE));
+        Decode(input, aAddressSize);
+    }
 
-        uint8_t encoded = arInput.ReadByte();
-        val = (encoded & 0x01);
-        q = Quality(encoded & 0xF0);
+    void DataSinglePoint::Decode(CORE::ByteCursor& arInput, int aAddressSize) noexcept
+    {
+        DecodeAddress(arInput, aAddressSize);
+        auto record = ReadRecord<Record>(arInput);
+        val = record.val;
+        q = record.q;
     }
 
     void DataSinglePoint::WriteTo(ByteStream& arOutput) const
     {
         BaseInfoObject::WriteTo(arOutput);
-
-        uint8_t encoded = val;
-        encoded |= (q.GetEncoded() & 0xF0);
-        arOutput.WriteByte(encoded);
+        WriteRecord(arOutput, Record{0, val, q});
     }
 
     // Type 3: M_DP_NA_1 ////////////////////////////////////////////////////////////
     void DataDoublePoint::ReadFrom(ByteStream& arInput, int aAddressSize)
     {
-        BaseInfoObject::ReadFrom(arInput, aAddressSize);
+        auto input = arInput.ReadCursor(static_cast<size_t>(aAddressSize + DATA_SIZE));
+        Decode(input, aAddressSize);
+    }
 
-        uint8_t encoded = arInput.ReadByte();
-        val = DoublePoint(encoded & 0x03);
-        q = Quality(encoded & 0xF0);
+    void DataDoublePoint::Decode(CORE::ByteCursor& arInput, int aAddressSize) noexcept
+    {
+        DecodeAddress(arInput, aAddressSize);
+        auto record = ReadRecord<Record>(arInput);
+        val = record.val;
+        q = record.q;
     }
 
     void DataDoublePoint::WriteTo(ByteStream& arOutput) const
     {
         BaseInfoObject::WriteTo(arOutput);
-
-        uint8_t encoded = static_cast<uint8_t>(val.GetValue());
-        encoded |= (q.GetEncoded() & 0xF0);
-        arOutput.WriteByte(encoded);
+        WriteRecord(arOutput, Record{0, val.GetValue(), q});
     }
 
     // Type 11: M_ME_NB_1 ////////////////////////////////////////////////////////////
     void DataMeasuredScaled::ReadFrom(ByteStream& arInput, int aAddressSize)
     {
-        BaseInfoObject::ReadFrom(arInput, aAddressSize);
-
-        {
-            // TODO warning implementation defined if > INT_MAX
-            uint16_t encoded;
-            encoded = arInput.ReadByte();
-            encoded |= (arInput.ReadByte() << 8);
+        auto input = arInput.ReadCursor(static_cast<size_t>(aAddressSize + DATA_SIZE));
+        Decode(input, aAddressSize);
+    }
 
-            const int16_t result = static_cast<int16_t>(encoded);
-            val = result;
-        }
-        // TODO ValueQuality
+    void DataMeasuredScaled::Decode(CORE::ByteCursor& arInput, int aAddressSize) noexcept
+    {
+        DecodeAddress(arInput, aAddressSize);
+        auto record = ReadRecord<Record>(arInput);
+        val = record.val;
+        q = record.q;
     }
 
     void DataMeasuredScaled::WriteTo(ByteStream& arOutput) const
     {
         BaseInfoObject::WriteTo(arOutput);
-
-        const int16_t value = static_cast<int16_t>(val);
-        const uint16_t bytes = *reinterpret_cast<const uint16_t*>(&value);
-
-        arOutput.WriteByte(bytes & 0xFF); // Start with LSB
-        arOutput.WriteByte((bytes >> 8) & 0xFF);
-
-        // TODO ValueQuality
+        WriteRecord(arOutput, Record{0, static_cast<int16_t>(val), q});
     }
 
     // Type 13: M_ME_NC_1 ////////////////////////////////////////////////////////////
     void DataMeasuredFloat::ReadFrom(ByteStream& arInput, int aAddressSize)
     {
-        BaseInfoObject::ReadFrom(arInput, aAddressSize);
-
-        uint32_t encoded;
-        encoded = arInput.ReadByte();
-        encoded |= (arInput.ReadByte() << 8);
-        encoded |= (arInput.ReadByte() << 16);
-        encoded |= (arInput.ReadByte() << 24);
-
-        val = *reinterpret_cast<float*>(&encoded);
-
+        auto input = arInput.ReadCursor(static_cast<size_t>(aAddressSize + DATA_SIZE));
+        Decode(input, aAddressSize);
+    }
 
-        // TODO ValueQuality
+    void DataMeasuredFloat::Decode(CORE::ByteCursor& arInput, int aAddressSize) noexcept
+    {
+        DecodeAddress(arInput, aAddressSize);
+        auto record = ReadRecord<Record>(arInput);
+        val = record.val;
+        q = record.q;
     }
 
     void DataMeasuredFloat::WriteTo(ByteStream& arOutput) const
     {
         BaseInfoObject::WriteTo(arOutput);
-
-        // Interpret 32bit float value as integer for encoding operations
-        const uint32_t bytes = *reinterpret_cast<const uint32_t*>(&val);
-        arOutput.WriteByte(bytes & 0xFF); // Start with LSB
-        arOutput.WriteByte((bytes >> 8)  & 0xFF);
-        arOutput.WriteByte((bytes >> 16) & 0xFF);
-        arOutput.WriteByte((bytes >> 24) & 0xFF);
-
-        // TODO ValueQuality
+        WriteRecord(arOutput, Record{0, val, q});
     }
 
     // Type 100: C_IC_NA_1 ////////////////////////////////////////////////////////////
     void DataInterrogationCommand::ReadFrom(ByteStream& arInput, int aAddressSize)
     {
-        BaseInfoObject::ReadFrom(arInput, aAddressSize);
-        val = InterrogationQualifier(arInput.ReadByte());
+        auto input = arInput.ReadCursor(static_cast<size_t>(aAddressSize + DATA_SIZE));
+        Decode(input, aAddressSize);
+    }
+
+    void DataInterrogationCommand::Decode(CORE::ByteCursor& arInput, int aAddressSize) noexcept
+    {
+        DecodeAddress(arInput, aAddressSize);
+        val = ReadRecord<Record>(arInput).val;
     }
 
     void DataInterrogationCommand::WriteTo(ByteStream& arOutput) const
     {
         BaseInfoObject::WriteTo(arOutput);
-        arOutput.WriteByte(static_cast<uint8_t>(val.GetValue()));
+        WriteRecord(arOutput, Record{0, val.GetValue()});
     }
 }
@@ -1,13 +1,16 @@
 #ifndef IEC104_INFOOBJECTS_HPP_
 #define IEC104_INFOOBJECTS_HPP_
 
-#include <functional>
-#include <map>
+#include <array>
+#include <atomic>
 #include <memory>
 #include <string>
 
+#include "core/bytecursor.hpp"
+
 #include "protocols/iec104/104enums.hpp"
 #include "protocols/iec104/infoaddress.hpp"
+#include "protocols/iec104/inforecords.hpp"
 #include "protocols/iec104/quality.hpp"
 
 namespace IEC104
@@ -15,39 +18,44 @@ namespace IEC104
 	class BaseInfoObject;
 
     using SharedInfoObject = std::shared_ptr<BaseInfoObject>;
+
+    /**
+     * @brief Registry of all info object types, indexed by type id
+     *
+     * Registrations happen during static initialization (see StaticRegistration).
+     * The table is a plain array without dynamic initialization, so registrations never depend on the
+     * initialization order of translation units. Every lookup is a single indexed load.
+     *
+     * The application calls Freeze() once, after its own registrations and before any thread starts decoding.
+     * Afterwards the table is read-only and may be used from any thread without synchronization.
+     * Constructing servers, clients or importers never freezes it, so registrations do not depend on their order.
+     */
     class InfoObjectFactory
     {
     public:
+        using CreateFunction = SharedInfoObject(*)();
+
         static SharedInfoObject Create(uint8_t aType);
-        static void RegisterInfoObject(int aType, int aPriority, int aInfoElementSize, 
-                                       const std::function<SharedInfoObject(void)>& arCreationFunction);
-        static int GetSize(uint8_t aType) noexcept;
-        static bool HasType(uint8_t aType) noexcept;
+        static void RegisterInfoObject(int aType, int aPriority, int aInfoElementSize, CreateFunction apCreateFunction);
+        static int GetSize(uint8_t aType) noexcept { return msEntries[aType].size; }
+        static bool HasType(uint8_t aType) noexcept { return msEntries[aType].create != nullptr; }
+
+        // Reject further registrations
+        static void Freeze() noexcept { msFrozen.store(true, std::memory_order_release); }
+        static bool IsFrozen() noexcept { return msFrozen.load(std::memory_order_acquire); }
 
     private:
-        class LookupKey
+        struct Entry
         {
-        public:
-            enum {ANY_PRIORITY = 0};
-
-            LookupKey(int aType, int aPriority)
-                : mType(aType), mPriority(aPriority) {}
-
-            // Compare type id only
-            bool operator==(const LookupKey& arOther) const noexcept { return mType == arOther.mType; }
-            bool operator<(const LookupKey& arOther) const noexcept { return mType < arOther.mType; }
-            int GetPriority() const noexcept { return mPriority; }
-
-        private:
-            int mType, mPriority;
+            CreateFunction create;
+            int size;
+            int priority;
         };
 
-
         InfoObjectFactory(); // No instance
 
-        static std::map<LookupKey, int> msRegistered;
-        static std::vector<std::function<SharedInfoObject(void)>> msFunctions;
-        static std::vector<int> msSizes;
+        static std::array<Entry, 256> msEntries;
+        static std::atomic<bool> msFrozen;
     };
     
     /**
@@ -77,8 +85,13 @@ namespace IEC104
     class StaticRegistration
     {
     public:
-        explicit StaticRegistration() noexcept
+        // Throws std::logic_error, if the factory was frozen already. Static instances are constructed before.
+        explicit StaticRegistration()
         {
+            // Info objects with a record layout are decoded with it. The registered size has to match.
+            if constexpr (requires { typename INFOOBJECT::Record; })
+                static_assert(INFOOBJECT::Record::DATA_SIZE == SIZE, "registered size does not match the record layout");
+
 			InfoObjectFactory::RegisterInfoObject(TYPE_ID, static_cast<int> (aPriority), SIZE,
 				[]() -> SharedInfoObject
 				{
@@ -92,10 +105,20 @@ namespace IEC104
     public:
         int GetTypeId() const;
         IEC104::InfoAddress GetAddress() const;
+        void SetAddress(const InfoAddress& arAddress) noexcept { mAddress = arAddress; }
 
         virtual void ReadFrom(ByteStream& arInput, int aAddressSize);
         virtual void WriteTo(ByteStream& arOutput) const;
 
+        /**
+         * @brief Decode from a validated frame
+         *
+         * The cursor must hold at least aAddressSize + the registered info element size.
+         * Built-in types decode without any checks. The default implementation takes the slower
+         * path through ReadFrom, so external types do not need to implement it.
+         */
+        virtual void Decode(CORE::ByteCursor& arInput, int aAddressSize);
+
         template <typename INFOOBJECT>
         INFOOBJECT& As()
         {
@@ -115,6 +138,10 @@ namespace IEC104
         // Standalone info object. Can be added to an ASDU via append
         BaseInfoObject(int aTypeId);
 
+    protected:
+        // Decode the encoded address of aAddressSize bytes (0 if implicit)
+        void DecodeAddress(CORE::ByteCursor& arInput, int aAddressSize) noexcept;
+
     private:
         int mType;
         InfoAddress mAddress;
@@ -125,12 +152,19 @@ namespace IEC104
     class DataSinglePoint : public BaseInfoObject
     {
     public:
+        // Encoded layout of the info element
+        using Record = RecordSinglePoint;
+
         static constexpr int TYPE_ID   = Type::M_SP_NA_1;
-        static constexpr int DATA_SIZE = 1;
+        static constexpr int DATA_SIZE = Record::DATA_SIZE;
 
         DataSinglePoint() : BaseInfoObject(TYPE_ID) {}
         void ReadFrom(ByteStream& arInput, int aAddressSize) override;
         void WriteTo(ByteStream& arOutput) const override;
+        void Decode(CORE::ByteCursor& arInput, int aAddressSize) noexcept override;
+
+        // Current state in the encoded layout
+        Record ToRecord() const noexcept { return Record{static_cast<uint32_t>(GetAddress().GetInt()), val, q}; }
 
         bool val = false;
         Quality q = Quality();
@@ -140,12 +174,19 @@ namespace IEC104
     class DataDoublePoint : public BaseInfoObject
     {
     public:
+        // Encoded layout of the info element
+        using Record = RecordDoublePoint;
+
         static constexpr int TYPE_ID   = Type::M_DP_NA_1;
-        static constexpr int DATA_SIZE = 1;
+        static constexpr int DATA_SIZE = Record::DATA_SIZE;
 
         DataDoublePoint() : BaseInfoObject(TYPE_ID) {}
         void ReadFrom(ByteStream& arInput, int aAddressSize) override;
         void WriteTo(ByteStream& arOutput) const override;
+        void Decode(CORE::ByteCursor& arInput, int aAddressSize) noexcept override;
+
+        // Current state in the encoded layout
+        Record ToRecord() const noexcept { return Record{static_cast<uint32_t>(GetAddress().GetInt()), val.GetValue(), q}; }
 
         DoublePointEnum val = DoublePoint::OFF;
         Quality q = Quality();
@@ -155,42 +196,63 @@ namespace IEC104
     class DataMeasuredScaled : public BaseInfoObject
     {
     public:
+        // Encoded layout of the info element
+        using Record = RecordMeasuredScaled;
+
         static constexpr int TYPE_ID = Type::M_ME_NB_1;
-        static constexpr int DATA_SIZE = 3;
+        static constexpr int DATA_SIZE = Record::DATA_SIZE;
 
         DataMeasuredScaled() : BaseInfoObject(TYPE_ID) {}
         void ReadFrom(ByteStream& arInput, int aAddressSize) override;
         void WriteTo(ByteStream& arOutput) const override;
+        void Decode(CORE::ByteCursor& arInput, int aAddressSize) noexcept override;
+
+        // Current state in the encoded layout
+        Record ToRecord() const noexcept { return Record{static_cast<uint32_t>(GetAddress().GetInt()), static_cast<int16_t>(val), q}; }
 
         int val = 0;
-        // TODO ValueQuality
+        Quality q = Quality();
     };
 
     // Type 13: M_ME_NC_1 ////////////////////////////////////////////////////////////
     class DataMeasuredFloat : public BaseInfoObject
     {
     public:
+        // Encoded layout of the info element
+        using Record = RecordMeasuredFloat;
+
         static constexpr int TYPE_ID = Type::M_ME_NC_1;
-        static constexpr int DATA_SIZE = 5;
+        static constexpr int DATA_SIZE = Record::DATA_SIZE;
 
         DataMeasuredFloat() : BaseInfoObject(TYPE_ID) {}
         void ReadFrom(ByteStream& arInput, int aAddressSize) override;
         void WriteTo(ByteStream& arOutput) const override;
+        void Decode(CORE::ByteCursor& arInput, int aAddressSize) noexcept override;
+
+        // Current state in the encoded layout
+        Record ToRecord() const noexcept { return Record{static_cast<uint32_t>(GetAddress().GetInt()), val, q}; }
 
         float val = 0.0;
-        // TODO ValueQuality
+        Quality q = Quality();
     };
 
     // Type 100: C_IC_NA_1 ////////////////////////////////////////////////////////////
     class DataInterrogationCommand : public BaseInfoObject
     {
     public:
+        // Encoded layout of the info element
+        using Record = RecordInterrogationCommand;
+
         static constexpr int TYPE_ID = Type::C_IC_NA_1;
-        static constexpr int DATA_SIZE = 1;
+        static constexpr int DATA_SIZE = Record::DATA_SIZE;
 
         DataInterrogationCommand() : BaseInfoObject(TYPE_ID) {}
         void ReadFrom(ByteStream& arInput, int aAddressSize) override;
         void WriteTo(ByteStream& arOutput) const override;
+        void Decode(CORE::ByteCursor& arInput, int aAddressSize) noexcept override;
+
+        // Current state in the encoded layout
+        Record ToRecord() const noexcept { return Record{static_cast<uint32_t>(GetAddress().GetInt()), val.GetValue()}; }
 
         InterrogationQualifierEnum val = InterrogationQualifier::UNUSED;
         // TODO Check if members are correct
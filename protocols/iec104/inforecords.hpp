@@ -0,0 +1,169 @@
+#ifndef IEC104_INFORECORDS_HPP_
+#define IEC104_INFORECORDS_HPP_
+
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+
+#include "core/bytecursor.hpp"
+#include "protocols/iec104/104enums.hpp"
+#include "protocols/iec104/quality.hpp"
+
+namespace IEC104
+{
+    /*
+     * Plain info object records for typed ASDUs (see TypedAsdu).
+     *
+     * In contrast to the BaseInfoObject classes, records have no vtable and no heap allocation.
+     * They are decoded from and encoded into raw memory, which was bound-checked once for the whole ASDU.
+     * Each record provides:
+     *   - TYPE_ID and DATA_SIZE (excluding the IOA), like the info object classes
+     *   - Decode(const uint8_t*) and Encode(uint8_t*) for exactly DATA_SIZE bytes
+     */
+
+    inline uint32_t ReadRecordAddress(const uint8_t* apSource, int aAddressSize) noexcept
+    {
+        uint32_t result = apSource[0];
+
+        if (aAddressSize > 1)
+            result |= (apSource[1] << 8);
+        if (aAddressSize > 2)
+            result |= (apSource[2] << 16);
+
+        return result;
+    }
+
+    inline void WriteRecordAddress(uint8_t* apDest, uint32_t aAddress, int aAddressSize) noexcept
+    {
+        apDest[0] = aAddress & 0xFF;
+
+        if (aAddressSize > 1)
+            apDest[1] = (aAddress >> 8) & 0xFF;
+        if (aAddressSize > 2)
+            apDest[2] = (aAddress >> 16) & 0xFF;
+    }
+
+    // Type 1: M_SP_NA_1 ////////////////////////////////////////////////////////////
+    struct RecordSinglePoint
+    {
+        static constexpr int TYPE_ID   = Type::M_SP_NA_1;
+        static constexpr int DATA_SIZE = 1;
+
+        uint32_t address = 0;
+        bool val = false;
+        Quality q;
+
+        void Decode(const uint8_t* apSource) noexcept
+        {
+            val = (apSource[0] & 0x01);
+            q = Quality(apSource[0] & 0xF0);
+        }
+
+        void Encode(uint8_t* apDest) const noexcept
+        {
+            apDest[0] = static_cast<uint8_t>(val) | (q.GetEncoded() & 0xF0);
+        }
+    };
+
+    // Type 3: M_DP_NA_1 ////////////////////////////////////////////////////////////
+    struct RecordDoublePoint
+    {
+        static constexpr int TYPE_ID   = Type::M_DP_NA_1;
+        static constexpr int DATA_SIZE = 1;
+
+        uint32_t address = 0;
+        DoublePoint val = DoublePoint::OFF;
+        Quality q;
+
+        void Decode(const uint8_t* apSource) noexcept
+        {
+            val = static_cast<DoublePoint>(apSource[0] & 0x03);
+            q = Quality(apSource[0] & 0xF0);
+        }
+
+        void Encode(uint8_t* apDest) const noexcept
+        {
+            apDest[0] = static_cast<uint8_t>(val) | (q.GetEncoded() & 0xF0);
+        }
+    };
+
+    // Type 11: M_ME_NB_1 ////////////////////////////////////////////////////////////
+    struct RecordMeasuredScaled
+    {
+        static constexpr int TYPE_ID   = Type::M_ME_NB_1;
+        static constexpr int DATA_SIZE = 3;
+
+        uint32_t address = 0;
+        int16_t val = 0;
+        Quality q;
+
+        void Decode(const uint8_t* apSource) noexcept
+        {
+            val = CORE::LoadLE<int16_t>(apSource);
+            q = Quality(apSource[2]);
+        }
+
+        void Encode(uint8_t* apDest) const noexcept
+        {
+            const auto bytes = static_cast<uint16_t>(val);
+            apDest[0] = bytes & 0xFF;
+            apDest[1] = (bytes >> 8) & 0xFF;
+            apDest[2] = q.GetEncoded();
+        }
+    };
+
+    // Type 13: M_ME_NC_1 ////////////////////////////////////////////////////////////
+    struct RecordMeasuredFloat
+    {
+        static constexpr int TYPE_ID   = Type::M_ME_NC_1;
+        static constexpr int DATA_SIZE = 5;
+
+        uint32_t address = 0;
+        float val = 0.0f;
+        Quality q;
+
+        void Decode(const uint8_t* apSource) noexcept
+        {
+            val = CORE::LoadLE<float>(apSource);
+            q = Quality(apSource[4]);
+        }
+
+        void Encode(uint8_t* apDest) const noexcept
+        {
+            const auto bytes = std::bit_cast<uint32_t>(val);
+            apDest[0] = bytes & 0xFF; // Start with LSB
+            apDest[1] = (bytes >> 8) & 0xFF;
+            apDest[2] = (bytes >> 16) & 0xFF;
+            apDest[3] = (bytes >> 24) & 0xFF;
+            apDest[4] = q.GetEncoded();
+        }
+    };
+
+    // Type 100: C_IC_NA_1 ////////////////////////////////////////////////////////////
+    struct RecordInterrogationCommand
+    {
+        static constexpr int TYPE_ID   = Type::C_IC_NA_1;
+        static constexpr int DATA_SIZE = 1;
+
+        uint32_t address = 0;
+        InterrogationQualifier val = InterrogationQualifier::UNUSED;
+
+        void Decode(const uint8_t* apSource) noexcept
+        {
+            val = static_cast<InterrogationQualifier>(apSource[0]);
+        }
+
+        void Encode(uint8_t* apDest) const noexcept
+        {
+            apDest[0] = static_cast<uint8_t>(val);
+        }
+    };
+
+    static_assert(std::is_trivially_copyable_v<RecordSinglePoint>);
+    static_assert(std::is_trivially_copyable_v<RecordDoublePoint>);
+    static_assert(std::is_trivially_copyable_v<RecordMeasuredScaled>);
+    static_assert(std::is_trivially_copyable_v<RecordMeasuredFloat>);
+    static_assert(std::is_trivially_copyable_v<RecordInterrogationCommand>);
+}
+
+#endif
@@ -0,0 +1,181 @@
+#include "protocols/iec104/interrogation.hpp"
+
+#include <algorithm>
+
+#include "core/bytestream.hpp"
+#include "protocols/iec104/apdu.hpp"
+#include "protocols/iec104/inforecords.hpp"
+#include "protocols/iec104/typedasdu.hpp"
+
+namespace IEC104
+{
+    Interrogation::Interrogation(const ProcessImage& arImage, const AsduConfig& arConfig,
+                                 const AsduHeader& arRequest, InterrogationQualifier aQualifier)
+        : mImage(arImage)
+        , mConfig(arConfig)
+        , mRequest(arRequest)
+        , mQualifier(aQualifier)
+    {
+        // Group interrogations are not supported
+        if (aQualifier != InterrogationQualifier::INTERROGATE_STATION)
+        {
+            mIsNegative = true;
+            return;
+        }
+
+        if (arRequest.commonAddress == BroadcastAddress(arConfig))
+            mImage.ForEachStation([this](int aCommonAddress) { mStations.push_back(aCommonAddress); });
+        else if (mImage.HasStation(arRequest.commonAddress))
+            mStations.push_back(arRequest.commonAddress);
+
+        if (mStations.empty())
+        {
+            mIsNegative = true;
+            mRejection = ReasonCode::UNKNOWN_COMMON_ADDRESS;
+        }
+    }
+
+    void Interrogation::Reject(ByteStream& arOutput, const AsduConfig& arConfig,
+                               const AsduHeader& arRequest, InterrogationQualifier aQualifier)
+    {
+        Respond(arOutput, arConfig, arRequest, arRequest.commonAddress, aQualifier, ReasonCode::CONFIRM_ACTIVATION, true);
+    }
+
+    int Interrogation::BroadcastAddress(const AsduConfig& arConfig) noexcept
+    {
+        return arConfig.GetCASize() == 2 ? 0xFFFF : 0xFF;
+    }
+
+    bool Interrogation::Next(ByteStream& arOutput)
+    {
+        switch (mPhase)
+        {
+        case Phase::CONFIRM:
+            if (mIsNegative)
+            {
+                Respond(arOutput, mConfig, mRequest, mRequest.commonAddress, mQualifier, mRejection, true);
+                mPhase = Phase::DONE;
+                return true;
+            }
+
+            Respond(arOutput, mConfig, mRequest, mStations[mStation], mQualifier, ReasonCode::CONFIRM_ACTIVATION, false);
+            mPhase = Phase::POINTS;
+            return true;
+
+        case Phase::POINTS:
+            if (NextPoints(arOutput))
+                return true;
+
+            mPhase = Phase::TERMINATE;
+            [[fallthrough]];
+
+        case Phase::TERMINATE:
+            Respond(arOutput, mConfig, mRequest, mStations[mStation], mQualifier, ReasonCode::FINISHED_ACTIVATION, false);
+
+            // A broadcast continues with the next station
+            if (++mStation < mStations.size())
+            {
+                mColumn = 0;
+                mNextAddress = 0;
+                mPhase = Phase::CONFIRM;
+            }
+            else
+            {
+                mPhase = Phase::DONE;
+            }
+            return true;
+
+        case Phase::DONE:
+        default:
+            return false;
+        }
+    }
+
+    void Interrogation::Respond(ByteStream& arOutput, const AsduConfig& arConfig, const AsduHeader& arRequest,
+                                int aCommonAddress, InterrogationQualifier aQualifier, ReasonCode aReason, bool aIsNegative)
+    {
+        TypedAsdu<RecordInterrogationCommand> response(arConfig);
+        auto& header = response.GetHeader();
+        header.reason = aReason;
+        header.isNegative = aIsNegative;
+        header.isTest = arRequest.isTest;
+        header.origin = arRequest.origin;
+        header.commonAddress = aCommonAddress;
+
+        response.Append(RecordInterrogationCommand{0, aQualifier});
+        response.WriteTo(arOutput);
+    }
+
+    bool Interrogation::NextPoints(ByteStream& arOutput)
+    {
+        // Each call advances the column, once all of its points were encoded
+        for (;;)
+        {
+            switch (mColumn)
+            {
+            case 0:
+                if (NextPoints<RecordSinglePoint>(arOutput))
+                    return true;
+                break;
+            case 1:
+                if (NextPoints<RecordDoublePoint>(arOutput))
+                    return true;
+                break;
+            case 2:
+                if (NextPoints<RecordMeasuredScaled>(arOutput))
+                    return true;
+                break;
+            case 3:
+                if (NextPoints<RecordMeasuredFloat>(arOutput))
+                    return true;
+                break;
+            default:
+                return false;
+            }
+        }
+    }
+
+    template <typename RECORD>
+    bool Interrogation::NextPoints(ByteStream& arOutput)
+    {
+        TypedAsdu<RECORD> asdu(mConfig);
+        auto& header = asdu.GetHeader();
+        header.reason = ReasonCode::GENERAL_INTERROGATION;
+        header.isTest = mRequest.isTest;
+        header.origin = mRequest.origin;
+        header.commonAddress = mStations[mStation];
+
+        const bool completed = mImage.template Scan<RECORD>(header.commonAddress, mNextAddress, [&](const RECORD& arRecord) {
+            if (!asdu.Empty())
+            {
+                const bool contiguous = (arRecord.address == asdu[asdu.Size() - 1].address + 1);
+
+                // The first two points decide: A contiguous run is sent with SQ=1 until it breaks
+                if (asdu.Size() == 1)
+                    asdu.SetSequence(contiguous);
+
+                if ((asdu.IsSequence() && !contiguous) || !asdu.HasMoreSpace())
+                    return false;
+            }
+
+            asdu.Append(arRecord);
+            return true;
+        });
+
+        if (completed)
+        {
+            ++mColumn;
+            mNextAddress = 0;
+        }
+        else
+        {
+            mNextAddress = asdu[asdu.Size() - 1].address + 1;
+        }
+
+        if (asdu.Empty())
+            return false;
+
+        asdu.WriteTo(arOutput);
+        return true;
+    }
+}
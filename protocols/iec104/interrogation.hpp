@@ -0,0 +1,83 @@
+#ifndef IEC104_INTERROGATION_HPP_
+#define IEC104_INTERROGATION_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "protocols/iec104/asdu.hpp"
+#include "protocols/iec104/processimage.hpp"
+
+class ByteStream;
+
+namespace IEC104
+{
+    /**
+     * @brief Responses to a single station interrogation (C_IC_NA_1), encoded one ASDU at a time
+     *
+     * The responses are produced on demand, so a link only encodes as many ASDUs as its k-window allows
+     * and never buffers the whole image. Each interrogated station is answered with
+     * ACTCON, its points with COT 20 (interrogated by station) and ACTTERM.
+     *
+     * Points are packed into maximally full ASDUs: Runs of contiguous IOAs are sent with SQ=1,
+     * other points with SQ=0. ASDUs are encoded from inline storage without any allocation.
+     *
+     * The process image must outlive the interrogation. Points, which change meanwhile,
+     * are sent with their state at the time they are reached.
+     */
+    class Interrogation
+    {
+    public:
+        /**
+         * @param arRequest Header of the received activation. A broadcast address interrogates all known stations.
+         * @param aQualifier Qualifier of interrogation. Only the station interrogation is supported.
+         */
+        Interrogation(const ProcessImage& arImage, const AsduConfig& arConfig,
+                      const AsduHeader& arRequest, InterrogationQualifier aQualifier);
+
+        // Encode a negative ACTCON, e.g. for an activation, which arrives while another one is running
+        static void Reject(ByteStream& arOutput, const AsduConfig& arConfig,
+                           const AsduHeader& arRequest, InterrogationQualifier aQualifier);
+
+        // Encode the next response ASDU. false, if all responses were encoded.
+        bool Next(ByteStream& arOutput);
+        bool Done() const noexcept { return mPhase == Phase::DONE; }
+
+        // Common address of all stations in a broadcast
+        static int BroadcastAddress(const AsduConfig& arConfig) noexcept;
+
+    private:
+        enum class Phase
+        {
+            CONFIRM,
+            POINTS,
+            TERMINATE,
+            DONE
+        };
+
+        static void Respond(ByteStream& arOutput, const AsduConfig& arConfig, const AsduHeader& arRequest,
+                            int aCommonAddress, InterrogationQualifier aQualifier, ReasonCode aReason, bool aIsNegative);
+
+        // Encode the next ASDU of a column. false, if the column has no more points.
+        template <typename RECORD>
+        bool NextPoints(ByteStream& arOutput);
+        bool NextPoints(ByteStream& arOutput);
+
+    private:
+        const ProcessImage& mImage;
+        AsduConfig mConfig;
+        AsduHeader mRequest;
+        InterrogationQualifier mQualifier;
+
+        std::vector<int> mStations;
+        size_t mStation = 0;
+        size_t mColumn = 0;
+        uint32_t mNextAddress = 0;
+        Phase mPhase = Phase::CONFIRM;
+        bool mIsNegative = false;
+        // Cause of a negative confirmation
+        ReasonCode mRejection = ReasonCode::CONFIRM_ACTIVATION;
+    };
+}
+
+#endif
@@ -1,5 +1,6 @@
 #include "link.hpp"
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 
@@ -9,41 +10,169 @@
 #include <boost/cobalt/race.hpp>
 
 #include "core/bytestream.hpp"
+#include "core/metrics.hpp"
 #include "protocols/iec104/asdu.hpp"
 #include "protocols/iec104/infoobjects.hpp"
+#include "protocols/iec104/interrogation.hpp"
+#include "protocols/iec104/typedasdu.hpp"
 
 namespace IEC104
 {
-    Link::Link(boost::asio::ip::tcp::socket&& arSocket, Mode mode, const ConnectionConfig& arConfig)
+    // U-Frames of both directions and a single S-Frame
+    static constexpr size_t CONTROL_CAPACITY = 4;
+
+    // Remote endpoint as "ip:port"
+    static std::string PeerOf(const asio::ip::tcp::socket& arSocket)
+    {
+        boost::system::error_code ec;
+        auto endpoint = arSocket.remote_endpoint(ec);
+        if (ec)
+            return {};
+
+        return endpoint.address().to_string() + ":" + std::to_string(endpoint.port());
+    }
+
+    // Failures to decode the data of the peer are counted, before they close the link
+    template <typename DECODE>
+    static auto CountDecodeError(LinkMetrics& arMetrics, DECODE&& aDecode)
+    {
+        try
+        {
+            return aDecode();
+        }
+        catch (const std::exception&)
+        {
+            arMetrics.DecodeError();
+            throw;
+        }
+    }
+
+    // Operations of a destroyed link may still complete successfully. They unwind as if they were aborted.
+    static void ThrowIfDestroyed(const std::weak_ptr<Link*>& arAlive)
+    {
+        if (arAlive.expired())
+            throw boost::system::system_error(asio::error::operation_aborted);
+    }
+
+    Link::Link(boost::asio::ip::tcp::socket&& arSocket, Mode mode, CORE::BufferPool& arBuffers,
+               const ConnectionConfig& arConfig)
         : mIsMaster(mode == Mode::Master)
         , mSocket(std::move(arSocket))
+        , mPeer(PeerOf(mSocket))
         , mConfig(arConfig)
-        , recvBuffer(4096)
+        , mControlQueue(CONTROL_CAPACITY)
+        , mDataQueue(mConfig.GetK())
+        , mrBuffers(arBuffers)
     {
+        mGather.reserve(CONTROL_CAPACITY + mConfig.GetK());
     }
 
-    Link::Link(boost::asio::ip::tcp::socket&& arSocket, Mode mode)
-        : Link(std::move(arSocket), mode, ConnectionConfig())
+    Link::Link(boost::asio::ip::tcp::socket&& arSocket, Mode mode, CORE::BufferPool& arBuffers)
+        : Link(std::move(arSocket), mode, arBuffers, ConnectionConfig())
     {
     }
 
+    void Link::Run()
+    {
+        if (!mReceiveLoop)
+            mReceiveLoop.emplace(ReceiveLoop());
+    }
+
     async::promise<void> Link::Tick()
     {
+        co_await Tick(VRTU::ClockWrapper::UtcNow());
+    }
+
+    async::promise<void> Link::Tick(std::chrono::milliseconds now)
+    {
+        std::weak_ptr<Link*> alive = mAlive;
+
         try
         {
-            co_await HandleReceive();
-            co_await HandleTimers();
+            {
+                CORE::ScopedTimer timer([this](auto elapsed) { mMetrics.TimerTime(elapsed); });
+                HandleTimers(now);
+            }
+            co_await Flush();
+            ArmTimers();
 
             SignalTickFinished(*this);
         }
         catch (...)
         {
+            // The flush was aborted by the destruction of the link. Its owner is gone as well,
+            // so the tick unwinds without touching any member.
+            if (alive.expired())
+                throw;
+
             CloseSocket();
         }
 
         co_return;
     }
 
+    void Link::AttachTimers(CORE::TimerWheel<Link>& arWheel) noexcept
+    {
+        mTimerEntry.Cancel();
+        mTimers = &arWheel;
+        ArmTimers();
+    }
+
+    void Link::ArmTimers() noexcept
+    {
+        if (!mTimers || !IsConnected())
+            return;
+
+        // Deadlines, which moved to a later point, are not rescheduled.
+        // The link is woken at the old deadline, checks its timers and arms the real one.
+        auto next = NextDeadline();
+
+        if (!next)
+            mTimerEntry.Cancel();
+        else if (!mTimerEntry.IsScheduled() || *next < mTimerEntry.Deadline())
+            mTimers->Schedule(mTimerEntry, *next);
+    }
+
+    std::optional<std::chrono::milliseconds> Link::NextDeadline() const noexcept
+    {
+        std::optional<std::chrono::milliseconds> next;
+
+        auto consider = [&next](std::chrono::milliseconds deadline) {
+            if (!next || deadline < *next)
+                next = deadline;
+        };
+
+        if (PeerAckPending())
+            consider(mPeerAckPendingSince + std::chrono::seconds(mConfig.GetT1()));
+
+        if (MyAckPending())
+            consider(mMyAckPendingSince + std::chrono::seconds(mConfig.GetT2()));
+
+        if (TestEnabled() && !ServicePending())
+            consider(mNoTrafficSince + std::chrono::seconds(mConfig.GetT3()));
+
+        return next;
+    }
+
+    std::chrono::milliseconds Link::TimerT1() const noexcept
+    {
+        if (!PeerAckPending())
+            return std::chrono::milliseconds(0);
+        return VRTU::ClockWrapper::UtcNow() - mPeerAckPendingSince;
+    }
+
+    std::chrono::milliseconds Link::TimerT2() const noexcept
+    {
+        if (!MyAckPending())
+            return std::chrono::milliseconds(0);
+        return VRTU::ClockWrapper::UtcNow() - mMyAckPendingSince;
+    }
+
+    std::chrono::milliseconds Link::TimerT3() const noexcept
+    {
+        return VRTU::ClockWrapper::UtcNow() - mNoTrafficSince;
+    }
+
     async::promise<void> Link::Delay(std::chrono::milliseconds msec)
     {
         asio::steady_timer t(co_await asio::this_coro::executor, msec);
@@ -51,14 +180,17 @@ namespace IEC104
         co_return;
     }
 
-    async::promise<void> Link::ActivateService(const Apdu& service)
+    void Link::ActivateService(const Apdu& service)
     {
         if (ServicePending())
             throw std::runtime_error("cannot activate service while another is pending");
 
+        if (!PeerAckPending())
+            mPeerAckPendingSince = VRTU::ClockWrapper::UtcNow();
+
         mPending = service.ServiceActivation();
-        co_await Send(service);
-        co_return;
+        ArmTimers();
+        Queue(service);
     }
 
     bool Link::ServicePending() const noexcept
@@ -66,110 +198,328 @@ namespace IEC104
         return mPending != ServiceType::NONE;
     }
 
-    async::promise<void> Link::Send(const Apdu& apdu)
+    void Link::Queue(const Apdu& apdu)
     {
-        apdu.WriteTo(sendBuffer);
-        co_await mSocket.async_send(boost::asio::buffer(sendBuffer), async::use_op);
-        sendBuffer.clear();
-        SignalApduSent(*this, apdu);
-        co_return;
+        mControlQueue.EmplaceBack(apdu);
     }
 
-    async::promise<void> Link::SendAck()
+    void Link::QueueAck()
     {
-        co_await Send(Apdu(seqRecv));
         seqMyLastAck = seqRecv;
-        mMyAckPendingSince = VRTU::ClockWrapper::UtcNow();
+        Queue(Apdu(seqRecv));
     }
 
-    async::promise<void> Link::HandleReceive()
+    void Link::Enqueue(const Asdu& asdu)
+    {
+        auto encoded = mrBuffers.Borrow();
+        asdu.WriteTo(*encoded);
+        QueueEncoded(*encoded);
+    }
+
+    void Link::QueueEncoded(const ByteStream& arAsdu)
+    {
+        mDataQueue.EmplaceBack(arAsdu.DataBegin(), arAsdu.RemainingBytes());
+    }
+
+    void Link::AttachProcessImage(const ProcessImage& arImage, const AsduConfig& arConfig)
+    {
+        mImage = &arImage;
+        mAsduConfig = arConfig;
+    }
+
+    int Link::FreeWindow() const noexcept
+    {
+        return mConfig.GetK() - CurrentK() - static_cast<int>(mDataQueue.Size());
+    }
+
+    void Link::QueueChanges()
+    {
+        if (!IsActive() || mEvents.Empty() || FreeWindow() <= 0)
+            return;
+
+        auto encoded = mrBuffers.Borrow();
+
+        while (FreeWindow() > 0 && mEvents.Next(*encoded, mAsduConfig))
+        {
+            QueueEncoded(*encoded);
+            encoded->Clear();
+        }
+    }
+
+    void Link::QueueResponses()
     {
-        if (!mSocket.available())
+        if (!IsActive() || !mInterrogation || FreeWindow() <= 0)
+            return;
+
+        auto encoded = mrBuffers.Borrow();
+
+        while (FreeWindow() > 0 && mInterrogation->Next(*encoded))
+        {
+            QueueEncoded(*encoded);
+            encoded->Clear();
+        }
+
+        if (mInterrogation->Done())
+            mInterrogation.reset();
+    }
+
+    size_t Link::PrepareTransmission()
+    {
+        size_t data = 0;
+
+        // Changes overtake the responses of a running interrogation
+        QueueChanges();
+        QueueResponses();
+
+        // I-Frames are only allowed on an active link and as long as the peer has not fallen behind by k frames
+        if (IsActive())
+        {
+            auto window = mConfig.GetK() - CurrentK();
+            if (window > 0)
+                data = std::min(mDataQueue.Size(), static_cast<size_t>(window));
+        }
+
+        if (data > 0)
+        {
+            // Every I-Frame acknowledges the received frames. A queued S-Frame would be redundant.
+            mControlQueue.EraseIf([](const Apdu& apdu) { return apdu.IsRecvAck(); });
+
+            if (!PeerAckPending())
+                mPeerAckPendingSince = VRTU::ClockWrapper::UtcNow();
+
+            for (size_t i = 0; i < data; ++i)
+                mDataQueue[i].SetSequences(seqSend++, seqRecv);
+
+            seqMyLastAck = seqRecv;
+        }
+
+        mControlInFlight = mControlQueue.Size();
+        mDataInFlight = data;
+
+        mGather.clear();
+        for (size_t i = 0; i < mControlInFlight; ++i)
+            mGather.emplace_back(mControlQueue[i].View().Data(), mControlQueue[i].Length());
+        for (size_t i = 0; i < mDataInFlight; ++i)
+            mGather.emplace_back(mDataQueue[i].View().Data(), mDataQueue[i].Length());
+
+        return mGather.size();
+    }
+
+    void Link::CompleteTransmission()
+    {
+        for (size_t i = 0; i < mControlInFlight; ++i)
+        {
+            mMetrics.Sent(mControlQueue[i]);
+            SignalApduSent(*this, mControlQueue[i]);
+        }
+        for (size_t i = 0; i < mDataInFlight; ++i)
+        {
+            mMetrics.Sent(mDataQueue[i]);
+            SignalApduSent(*this, mDataQueue[i]);
+        }
+
+        mControlQueue.PopFront(mControlInFlight);
+        mDataQueue.PopFront(mDataInFlight);
+        mControlInFlight = 0;
+        mDataInFlight = 0;
+        mGather.clear();
+    }
+
+    async::promise<void> Link::Flush()
+    {
+        // Receive loop and timers may flush at the same time.
+        // The write in progress also takes care of the frames, which were queued meanwhile.
+        if (mIsSending)
             co_return;
 
+        mIsSending = true;
+
+        // Held by the coroutine, which may resume after the link was destroyed
+        std::weak_ptr<Link*> alive = mAlive;
+
+        try
+        {
+            while (PrepareTransmission() > 0)
+            {
+                co_await asio::async_write(mSocket, mGather, async::use_op);
+                ThrowIfDestroyed(alive);
+                CompleteTransmission();
+            }
+        }
+        catch (...)
+        {
+            // The write of a destroyed link was aborted. Do not touch any member in this case.
+            if (!alive.expired())
+                mIsSending = false;
+            throw;
+        }
+
+        mIsSending = false;
+        mMetrics.SendQueue(mDataQueue.Size());
+        ArmTimers();
+    }
+
+    async::promise<void> Link::ReceiveLoop()
+    {
+        try
+        {
+            while (IsConnected())
+                co_await HandleReceive();
+        }
+        catch (const boost::system::system_error& e)
+        {
+            // Reads are only aborted, when the socket was closed or the link is being destroyed.
+            // Do not touch any member in this case.
+            if (e.code() == asio::error::operation_aborted)
+                co_return;
+
+            CloseSocket();
+        }
+        catch (...)
+        {
+            // The peer sent data, which could not be handled, or a subscriber failed
+            CloseSocket();
+        }
+    }
+
+    async::promise<void> Link::HandleReceive()
+    {
+        std::weak_ptr<Link*> alive = mAlive;
+
+        // Idle links do not hold a buffer. It is borrowed, once data is ready to be read.
+        if (!mRecvBuffer)
+        {
+            co_await mSocket.async_wait(asio::socket_base::wait_read, async::use_op);
+            ThrowIfDestroyed(alive);
+            mRecvBuffer = mrBuffers.Borrow();
+        }
+
+        auto& recvBuffer = *mRecvBuffer;
         auto buf = boost::asio::buffer(recvBuffer.WriteBegin(), recvBuffer.WritableBytes());
         auto recv = co_await mSocket.async_read_some(buf, async::use_op);
+        ThrowIfDestroyed(alive);
         recvBuffer.BytesWritten(recv);
+        mRecvTime = VRTU::ClockWrapper::UtcNow();
 
-        while (Apdu::IsFullyAvailable(recvBuffer))
+        // The views refer to recvBuffer, which is not modified until all complete APDUs are handled
         {
-            auto apdu = Apdu(recvBuffer);
-            co_await HandleApdu(apdu);
+            CORE::ScopedTimer timer([this](auto elapsed) { mMetrics.ReceiveTime(elapsed); });
+
+            while (CountDecodeError(mMetrics, [&recvBuffer] { return Apdu::IsFullyAvailable(recvBuffer); }))
+            {
+                auto apdu = CountDecodeError(mMetrics, [&recvBuffer] { return ApduView(recvBuffer); });
+                HandleApdu(apdu);
+            }
         }
 
-        recvBuffer.Flush();
+        // Only a partial APDU keeps the buffer. It is moved, if a complete one might not fit behind it.
+        if (recvBuffer.RemainingBytes() == 0)
+            mRecvBuffer.Release();
+        else
+            recvBuffer.Reclaim(ApduView::MAX_LENGTH);
+
+        // All responses to this read are written at once
+        co_await Flush();
+        ArmTimers();
         co_return;
     }
 
-    async::promise<void> Link::HandleTimers()
+    void Link::HandleTimers(std::chrono::milliseconds now)
     {
-        if (!ServicePending() && seqPeerLastAck == seqSend)
-            mPeerAckPendingSince = VRTU::ClockWrapper::UtcNow();
-        
-        if (seqMyLastAck == seqRecv)
-            mMyAckPendingSince = VRTU::ClockWrapper::UtcNow();
-
-        if (TimerT1() > std::chrono::seconds(mConfig.GetT1()))
+        if (PeerAckPending() && now - mPeerAckPendingSince >= std::chrono::seconds(mConfig.GetT1()))
+        {
+            mMetrics.T1Expired();
             throw std::runtime_error("peer ack timed out");
+        }
 
-        if (TimerT2() > std::chrono::seconds(mConfig.GetT2()))
-            co_await SendAck();
-
-        bool testEnabled = (mConfig.GetT3() > 0);
-
-        if (testEnabled && !ServicePending() && (TimerT3() > std::chrono::seconds(mConfig.GetT3())))
-            co_await Test();
+        if (MyAckPending() && now - mMyAckPendingSince >= std::chrono::seconds(mConfig.GetT2()))
+        {
+            mMetrics.T2Ack();
+            QueueAck();
+        }
 
-        co_return;
+        if (TestEnabled() && !ServicePending() && now - mNoTrafficSince >= std::chrono::seconds(mConfig.GetT3()))
+            ActivateService(Apdu::TESTFR_ACT);
     }
 
-    async::promise<void> Link::HandleApdu(const Apdu& apdu)
+    void Link::HandleApdu(const ApduView& apdu)
     {
-        mNoTrafficSince = VRTU::ClockWrapper::UtcNow();
+        mNoTrafficSince = mRecvTime;
+        mMetrics.Received(apdu);
         SignalApduReceived(*this, apdu);
 
         HandleApduServiceCon(apdu);
-        co_await HandleApduServiceAct(apdu);
+        HandleApduServiceAct(apdu);
         HandlePeerRecvSequence(apdu);
-        co_await HandlePeerSendSequence(apdu);
+        HandlePeerSendSequence(apdu);
+        HandleInterrogation(apdu);
     }
 
-    async::promise<void> Link::HandleApduServiceAct(const Apdu& apdu)
+    void Link::HandleApduServiceAct(const ApduView& apdu)
     {
         switch (apdu.ServiceActivation()) {
         case ServiceType::START:
-            co_await ActivateLink();
+            ActivateLink();
             break;
         case ServiceType::STOP:
-            co_await DeactivateLink();
+            DeactivateLink();
             break;
         case ServiceType::TEST:
-            co_await Send(Apdu::TESTFR_CON);
+            Queue(Apdu::TESTFR_CON);
             break;
         default:
             break;
         }
-        co_return;
     }
 
-    async::promise<void> Link::HandlePeerSendSequence(const Apdu& apdu)
+    void Link::HandleInterrogation(const ApduView& apdu)
+    {
+        if (IsMaster() || !mImage || !apdu.HasPayload() || apdu.PayloadLength() == 0)
+            return;
+
+        if (apdu.PayloadBegin()[0] != RecordInterrogationCommand::TYPE_ID)
+            return;
+
+        TypedAsdu<RecordInterrogationCommand> command(mAsduConfig);
+        CountDecodeError(mMetrics, [&command, &apdu] { command.ReadFrom(apdu); });
+
+        const auto& request = command.GetHeader();
+
+        if (request.reason != ReasonCode::ACTIVATION || command.Empty())
+            return;
+
+        // Only a single interrogation runs at a time
+        if (mInterrogation)
+        {
+            auto encoded = mrBuffers.Borrow();
+            Interrogation::Reject(*encoded, mAsduConfig, request, command[0].val);
+            QueueEncoded(*encoded);
+            return;
+        }
+
+        mInterrogation = std::make_unique<Interrogation>(*mImage, mAsduConfig, request, command[0].val);
+    }
+
+    void Link::HandlePeerSendSequence(const ApduView& apdu)
     {
         auto sent = apdu.SendSequence();
 
         if (!sent.has_value())
-            co_return;
+            return;
 
         if (sent.value() != seqRecv)
             throw std::runtime_error("peer telegram has unexpected send sequence");
 
+        if (!MyAckPending())
+            mMyAckPendingSince = mRecvTime;
+
         ++seqRecv;
 
         if (CurrentW() >= mConfig.GetW())
-            co_await SendAck();
-        co_return;
+            QueueAck();
     }
 
-    void Link::HandleApduServiceCon(const Apdu& apdu)
+    void Link::HandleApduServiceCon(const ApduView& apdu)
     {
         auto confirmed = apdu.ServiceConfirmation();
 
@@ -190,7 +540,7 @@ namespace IEC104
         }
     }
 
-    void Link::HandlePeerRecvSequence(const Apdu& apdu)
+    void Link::HandlePeerRecvSequence(const ApduView& apdu)
     {
         auto recv = apdu.ReceiveSequence();
 
@@ -204,24 +554,32 @@ namespace IEC104
 
         if (acked > 0) {
             seqPeerLastAck = recv.value();
-            mPeerAckPendingSince = VRTU::ClockWrapper::UtcNow();
+            mPeerAckPendingSince = mRecvTime;
         }
     }
 
-    async::promise<void> Link::ActivateLink()
+    void Link::ActivateLink()
     {
-        co_await Send(Apdu::STARTDT_CON);
+        Queue(Apdu::STARTDT_CON);
 
         if (!IsMaster())
             setActive(true);
     }
 
-    async::promise<void> Link::DeactivateLink()
+    void Link::DeactivateLink()
     {
-        co_await Send(Apdu::STOPDT_CON);
+        Queue(Apdu::STOPDT_CON);
 
         if (!IsMaster())
+        {
+            // Pending responses and changes are discarded by STOPDT. A general interrogation restores the state.
+            // I-Frames, which are being written right now, stay queued until the write has completed.
+            mInterrogation.reset();
+            mEvents.Clear();
+            size_t index = 0;
+            mDataQueue.EraseIf([this, &index](const Apdu&) { return index++ >= mDataInFlight; });
             setActive(false);
+        }
     }
 
     void Link::PeerActivated()
@@ -238,20 +596,20 @@ namespace IEC104
 
     async::promise<void> Link::Start()
     {
-        co_await ActivateService(Apdu::STARTDT_ACT);
-        co_return;
+        ActivateService(Apdu::STARTDT_ACT);
+        co_await Flush();
     }
 
     async::promise<void> Link::Stop()
     {
-        co_await ActivateService(Apdu::STOPDT_ACT);
-        co_return;
+        ActivateService(Apdu::STOPDT_ACT);
+        co_await Flush();
     }
 
     async::promise<void> Link::Test()
     {
-        co_await ActivateService(Apdu::TESTFR_ACT);
-        co_return;
+        ActivateService(Apdu::TESTFR_ACT);
+        co_await Flush();
     }
 
     void Link::setConnected(bool value) noexcept
@@ -286,11 +644,22 @@ namespace IEC104
 
         boost::system::error_code ec;
         mSocket.close(ec);
+        mTimerEntry.Cancel();
         setConnected(false);
     }
 
+    void Link::Abort() noexcept
+    {
+        boost::system::error_code ec;
+        mSocket.close(ec);
+        mTimerEntry.Cancel();
+        mIsConnected = false;
+        mIsActive = false;
+    }
+
     Link::~Link() noexcept
     {
-        CloseSocket();
+        // Subscribers must not be notified by a link under destruction
+        Abort();
     }
 }
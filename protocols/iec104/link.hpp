@@ -3,14 +3,24 @@
 
 #include <cstdint>
 #include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
 
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/cobalt/promise.hpp>
+#include "core/bufferpool.hpp"
 #include "core/clockwrapper.hpp"
 #include "core/signal.hpp"
+#include "core/stablequeue.hpp"
+#include "core/timerwheel.hpp"
 
 #include "protocols/iec104/apdu.hpp"
+#include "protocols/iec104/asdu.hpp"
 #include "protocols/iec104/connectionconfig.hpp"
+#include "protocols/iec104/eventqueue.hpp"
+#include "protocols/iec104/linkmetrics.hpp"
 #include "protocols/iec104/sequence.hpp"
 
 namespace async = boost::cobalt;
@@ -19,6 +29,8 @@ namespace asio = boost::asio;
 namespace IEC104
 {
     class BaseInfoObject;
+    class Interrogation;
+    class ProcessImage;
 
     class Link
     {
@@ -27,10 +39,14 @@ namespace IEC104
         CORE::SignalEveryone<void, Link&> SignalStateChanged;
         /// Signal is invoked after a connection tick has finished
         CORE::SignalEveryone<void, Link&> SignalTickFinished;
-        /// Signal is invoked after an APDU was sent
+        /// Signal is invoked after an APDU was written to the socket
         CORE::SignalEveryone<void, Link&, const Apdu&> SignalApduSent;
-        /// Signal is invoked after an APDU was received
-        CORE::SignalEveryone<void, Link&, const Apdu&> SignalApduReceived;
+        /// Signal is invoked after an APDU was received.
+        /// The view is only valid during the call. Copy it into an Apdu to retain the frame.
+        CORE::SignalEveryone<void, Link&, const ApduView&> SignalApduReceived;
+
+        // Capacity of the buffers, which a link borrows to receive and encode
+        static constexpr size_t BUFFER_SIZE = 4096;
 
         enum class Mode
         {
@@ -38,19 +54,37 @@ namespace IEC104
             Slave
         };
 
-        // Create an connection with an connected socket
-        explicit Link(boost::asio::ip::tcp::socket&& arSocket, Mode mode, const ConnectionConfig& arConfig);
-        explicit Link(boost::asio::ip::tcp::socket&& arSocket, Mode mode);
+        // Create an connection with an connected socket. Buffers are borrowed from arBuffers, which outlives the link
+        // and is only used by the thread, which runs the link.
+        explicit Link(boost::asio::ip::tcp::socket&& arSocket, Mode mode, CORE::BufferPool& arBuffers,
+                      const ConnectionConfig& arConfig);
+        explicit Link(boost::asio::ip::tcp::socket&& arSocket, Mode mode, CORE::BufferPool& arBuffers);
         ~Link() noexcept;
 
         Link(const Link&)            = delete;
         Link& operator=(const Link&) = delete;
 
-        Link(Link&&)                 = default;
-        Link& operator=(Link&&)      = default;
+        // The receive loop refers to this link. Therefore it must never change its address
+        Link(Link&&)                 = delete;
+        Link& operator=(Link&&)      = delete;
+
+        // Launch the receive loop, which handles every APDU as soon as it arrives.
+        // The loop runs on the executor of the current thread, until the connection is closed.
+        void Run();
 
-        // Single tick of message processing
+        // Single tick of timer supervision
         async::promise<void> Tick();
+        // Single tick of timer supervision at a known point in time
+        async::promise<void> Tick(std::chrono::milliseconds now);
+
+        // Register the T1/T2/T3 deadlines at a shared wheel. The owner of the wheel ticks the link, when one expires.
+        void AttachTimers(CORE::TimerWheel<Link>& arWheel) noexcept;
+        // Answer station interrogations of the peer from a process image, which outlives the link. Slave links only.
+        void AttachProcessImage(const ProcessImage& arImage, const AsduConfig& arConfig = AsduConfig::Defaults);
+        // Sum up the metrics of this link in the metrics of its group, which outlive the link
+        void AttachMetrics(LinkMetricsGroup& arGroup) { mMetrics.AttachGroup(arGroup); }
+        // Earliest deadline of all running timers. Empty, if no timer is running.
+        std::optional<std::chrono::milliseconds> NextDeadline() const noexcept;
 
         async::promise<void> Start();
 
@@ -58,7 +92,53 @@ namespace IEC104
 
         async::promise<void> Test();
 
+        // Close the connection. Subscribers are notified about the new state.
+        void Close() noexcept { CloseSocket(); }
+        // Close the connection without notifying the subscribers, e.g. on shutdown.
+        // Pending operations complete with operation_aborted.
+        void Abort() noexcept;
+
+        // Queue an ASDU for transmission as I-Frame. It is sent with the next flush, as soon as the k-window allows it.
+        void Enqueue(const Asdu& asdu);
+        // Write all queued frames, which are allowed by the k-window, with a single write
+        async::promise<void> Flush();
+        // Number of I-Frames, which wait for the k-window or the next flush
+        size_t QueuedAsdus() const noexcept { return mDataQueue.Size(); }
+        // Spontaneous changes, which are packed into ASDUs as soon as the k-window has room. Sent with the next flush.
+        // Only to be used on the thread, which runs the link. Other threads push through a Poster.
+        EventQueue& Events() noexcept { return mEvents; }
+        const EventQueue& Events() const noexcept { return mEvents; }
+
+        // Pushes changes into the events of a link from any thread. Changes for a closed link are discarded.
+        class Poster
+        {
+        public:
+            // Queue a change on the executor of the link. It is sent with the flush following its push.
+            template <typename RECORD>
+            void Post(int aCommonAddress, const RECORD& arRecord) const
+            {
+                asio::post(mExecutor, [link = mLink, aCommonAddress, arRecord]() {
+                    if (auto p_link = link.lock())
+                        (*p_link)->mEvents.Push(aCommonAddress, arRecord);
+                });
+            }
+
+        private:
+            friend class Link;
+
+            Poster(asio::any_io_executor aExecutor, std::weak_ptr<Link*> aLink) noexcept
+                : mExecutor(std::move(aExecutor)), mLink(std::move(aLink)) {}
+
+            asio::any_io_executor mExecutor;
+            std::weak_ptr<Link*> mLink;
+        };
+
+        // Copyable handle, which may be handed to other threads
+        Poster GetPoster() { return Poster(mSocket.get_executor(), mAlive); }
+
         const ConnectionConfig& Config() const noexcept { return mConfig; }
+        // Traffic and health of this link. May be read from any thread, as long as the link exists.
+        const LinkMetrics& Metrics() const noexcept { return mMetrics; }
 
         bool IsActive() const noexcept { return mIsActive; }
         bool IsMaster() const noexcept { return mIsMaster; }
@@ -69,10 +149,13 @@ namespace IEC104
         int LocalPort() const noexcept { return mSocket.local_endpoint().port(); }
         asio::ip::address RemoteIp() const noexcept { return mSocket.remote_endpoint().address(); }
         int RemotePort() const noexcept { return mSocket.remote_endpoint().port(); }
+        // Remote endpoint as "ip:port", taken once when the link was created. Empty, if the socket was not connected.
+        const std::string& Peer() const noexcept { return mPeer; }
 
-        std::chrono::milliseconds TimerT1() const noexcept { return VRTU::ClockWrapper::UtcNow() - mPeerAckPendingSince; }
-        std::chrono::milliseconds TimerT2() const noexcept { return VRTU::ClockWrapper::UtcNow() - mMyAckPendingSince; }
-        std::chrono::milliseconds TimerT3() const noexcept { return VRTU::ClockWrapper::UtcNow() - mNoTrafficSince; }
+        // Elapsed time of each timer. Zero, if the timer is not running
+        std::chrono::milliseconds TimerT1() const noexcept;
+        std::chrono::milliseconds TimerT2() const noexcept;
+        std::chrono::milliseconds TimerT3() const noexcept;
 
         int CurrentW() const noexcept { return seqMyLastAck.Distance(seqRecv); }
         int CurrentK() const noexcept { return seqPeerLastAck.Distance(seqSend); }
@@ -81,19 +164,29 @@ namespace IEC104
 
     private:
         async::promise<void> Delay(std::chrono::milliseconds msec);
-        async::promise<void> ActivateService(const Apdu& service);
-        async::promise<void> Send(const Apdu& adpu);
-        async::promise<void> SendAck();
+        void ActivateService(const Apdu& service);
+        void Queue(const Apdu& apdu);
+        void QueueAck();
+        void QueueEncoded(const ByteStream& arAsdu);
+        // Room of the k-window, which is not taken by queued I-Frames
+        int FreeWindow() const noexcept;
+        // Encode pending changes and responses on demand: Only as many as the k-window allows to send right away
+        void QueueChanges();
+        void QueueResponses();
+        size_t PrepareTransmission();
+        void CompleteTransmission();
+        async::promise<void> ReceiveLoop();
         async::promise<void> HandleReceive();
-        async::promise<void> HandleTimers();
-        async::promise<void> HandleApdu(const Apdu& apdu);
-        async::promise<void> HandleApduServiceAct(const Apdu& apdu);
-        async::promise<void> HandlePeerSendSequence(const Apdu& apdu);
-        void HandleApduServiceCon(const Apdu& apdu);
-        void HandlePeerRecvSequence(const Apdu& apdu);
+        void HandleTimers(std::chrono::milliseconds now);
+        void HandleApdu(const ApduView& apdu);
+        void HandleApduServiceAct(const ApduView& apdu);
+        void HandlePeerSendSequence(const ApduView& apdu);
+        void HandleApduServiceCon(const ApduView& apdu);
+        void HandleInterrogation(const ApduView& apdu);
+        void HandlePeerRecvSequence(const ApduView& apdu);
         
-        async::promise<void> ActivateLink();
-        async::promise<void> DeactivateLink(); 
+        void ActivateLink();
+        void DeactivateLink(); 
         void PeerActivated();
         void PeerDeactivated();
 
@@ -104,15 +197,26 @@ namespace IEC104
 
         void CloseSocket() noexcept;
 
+        bool PeerAckPending() const noexcept { return ServicePending() || seqPeerLastAck != seqSend; }
+        bool MyAckPending() const noexcept { return seqMyLastAck != seqRecv; }
+        bool TestEnabled() const noexcept { return mConfig.GetT3() > 0; }
+        void ArmTimers() noexcept;
+
     private:
         bool mIsMaster    = false;
         bool mIsActive    = false;
         bool mIsConnected = true;
+        bool mIsSending   = false;
         ServiceType mPending = ServiceType::NONE;
 
         std::chrono::milliseconds mPeerAckPendingSince = VRTU::ClockWrapper::UtcNow();
         std::chrono::milliseconds mMyAckPendingSince   = VRTU::ClockWrapper::UtcNow();
         std::chrono::milliseconds mNoTrafficSince      = VRTU::ClockWrapper::UtcNow();
+        // Time of the latest receive. Read once for all APDUs of a single read.
+        std::chrono::milliseconds mRecvTime            = mNoTrafficSince;
+
+        CORE::TimerWheel<Link>* mTimers = nullptr;
+        CORE::TimerWheel<Link>::Entry mTimerEntry{*this};
 
         Sequence seqRecv;
         Sequence seqSend;
@@ -120,9 +224,32 @@ namespace IEC104
         Sequence seqPeerLastAck;
 
         boost::asio::ip::tcp::socket mSocket;
+        std::string mPeer;
         ConnectionConfig mConfig;
-        std::vector<uint8_t> sendBuffer;
-        ByteStream recvBuffer;
+        // U- and S-Frames are not limited by the k-window and overtake queued I-Frames.
+        // The queues keep the frames in place, while their memory is being written.
+        // Both are reserved for a full k-window, so they only allocate, if more frames are queued.
+        CORE::StableQueue<Apdu> mControlQueue;
+        CORE::StableQueue<Apdu> mDataQueue;
+        size_t mControlInFlight = 0;
+        size_t mDataInFlight    = 0;
+        std::vector<asio::const_buffer> mGather;
+        CORE::BufferPool& mrBuffers;
+        // Only held, while received data is pending
+        CORE::BufferPool::Lease mRecvBuffer;
+
+        const ProcessImage* mImage = nullptr;
+        AsduConfig mAsduConfig = AsduConfig::Defaults;
+        // Running station interrogation. Its responses are only encoded, when the k-window has room.
+        std::unique_ptr<Interrogation> mInterrogation;
+        EventQueue mEvents;
+        LinkMetrics mMetrics;
+
+        // Expires with the link, so neither posted changes nor completed operations reach a destroyed one
+        std::shared_ptr<Link*> mAlive = std::make_shared<Link*>(this);
+
+        // declared last: destroyed first, while the socket is still valid
+        std::optional<async::promise<void>> mReceiveLoop;
     };
 }
 
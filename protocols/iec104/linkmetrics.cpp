@@ -0,0 +1,285 @@
+#include "protocols/iec104/linkmetrics.hpp"
+
+#include <stdexcept>
+#include <thread>
+
+#include "protocols/iec104/apdu.hpp"
+
+namespace IEC104
+{
+    namespace
+    {
+        template <size_t N>
+        void AddAll(std::array<uint64_t, N>& arSum, const std::array<uint64_t, N>& arOther) noexcept
+        {
+            for (size_t i = 0; i < N; ++i)
+                arSum[i] += arOther[i];
+        }
+
+        template <size_t N>
+        std::array<uint64_t, N> LoadAll(const std::array<CORE::SingleWriterCounter, N>& arCounters) noexcept
+        {
+            std::array<uint64_t, N> result{};
+            for (size_t i = 0; i < N; ++i)
+                result[i] = arCounters[i].Load();
+            return result;
+        }
+
+        template <size_t N>
+        void AddAll(std::array<CORE::SingleWriterCounter, N>& arCounters, const std::array<uint64_t, N>& arValues) noexcept
+        {
+            for (size_t i = 0; i < N; ++i)
+                arCounters[i].Add(arValues[i]);
+        }
+
+        template <size_t N>
+        void ResetAll(std::array<CORE::SingleWriterCounter, N>& arCounters) noexcept
+        {
+            for (auto& counter : arCounters)
+                counter.Reset();
+        }
+    }
+
+    LinkMetrics::Snapshot& LinkMetrics::Snapshot::operator+=(const Snapshot& arOther) noexcept
+    {
+        AddAll(apdusReceived, arOther.apdusReceived);
+        AddAll(bytesReceived, arOther.bytesReceived);
+        AddAll(apdusSent, arOther.apdusSent);
+        AddAll(bytesSent, arOther.bytesSent);
+        decodeErrors += arOther.decodeErrors;
+        t1Expired += arOther.t1Expired;
+        t2Acks += arOther.t2Acks;
+        sendQueue += arOther.sendQueue;
+        sendQueueDepth += arOther.sendQueueDepth;
+        receiveTime += arOther.receiveTime;
+        timerTime += arOther.timerTime;
+        return *this;
+    }
+
+    LinkMetrics::Snapshot LinkMetrics::Values::Read() const noexcept
+    {
+        Snapshot result;
+        result.apdusReceived = LoadAll(apdusReceived);
+        result.bytesReceived = LoadAll(bytesReceived);
+        result.apdusSent = LoadAll(apdusSent);
+        result.bytesSent = LoadAll(bytesSent);
+        result.decodeErrors = decodeErrors.Load();
+        result.t1Expired = t1Expired.Load();
+        result.t2Acks = t2Acks.Load();
+        result.sendQueue = sendQueue.Load();
+        result.sendQueueDepth = sendQueueDepth.Read();
+        result.receiveTime = receiveTime.Read();
+        result.timerTime = timerTime.Read();
+        return result;
+    }
+
+    void LinkMetrics::Values::Add(const Snapshot& arSnapshot) noexcept
+    {
+        AddAll(apdusReceived, arSnapshot.apdusReceived);
+        AddAll(bytesReceived, arSnapshot.bytesReceived);
+        AddAll(apdusSent, arSnapshot.apdusSent);
+        AddAll(bytesSent, arSnapshot.bytesSent);
+        decodeErrors.Add(arSnapshot.decodeErrors);
+        t1Expired.Add(arSnapshot.t1Expired);
+        t2Acks.Add(arSnapshot.t2Acks);
+        sendQueueDepth.Add(arSnapshot.sendQueueDepth);
+        receiveTime.Add(arSnapshot.receiveTime);
+        timerTime.Add(arSnapshot.timerTime);
+    }
+
+    void LinkMetrics::Values::Reset() noexcept
+    {
+        ResetAll(apdusReceived);
+        ResetAll(bytesReceived);
+        ResetAll(apdusSent);
+        ResetAll(bytesSent);
+        decodeErrors.Reset();
+        t1Expired.Reset();
+        t2Acks.Reset();
+        sendQueue.Set(0);
+        sendQueueDepth.Reset();
+        receiveTime.Reset();
+        timerTime.Reset();
+    }
+
+    LinkMetrics::LinkMetrics()
+        : mpOwn(std::make_unique<Values>())
+        , mpValues(mpOwn.get())
+    {
+    }
+
+    LinkMetrics::~LinkMetrics() noexcept
+    {
+        if (mpGroup)
+            mpGroup->Leave(*mpValues);
+    }
+
+    void LinkMetrics::AttachGroup(LinkMetricsGroup& arGroup)
+    {
+        auto& values = arGroup.Join();
+
+        if (mpGroup)
+            mpGroup->Leave(*mpValues);
+
+        mpOwn.reset();
+        mpGroup = &arGroup;
+        mpValues = &values;
+    }
+
+    FrameFormat LinkMetrics::FormatOf(const ApduView& arApdu) noexcept
+    {
+        if (arApdu.HasPayload())
+            return FrameFormat::I;
+        return arApdu.IsRecvAck() ? FrameFormat::S : FrameFormat::U;
+    }
+
+    void LinkMetrics::CountApdu(Counters& arApdus, Counters& arBytes, FrameFormat aFormat, size_t aLength) noexcept
+    {
+        const auto index = static_cast<size_t>(aFormat);
+        arApdus[index].Add();
+        arBytes[index].Add(aLength);
+    }
+
+    void LinkMetrics::Received(const ApduView& arApdu) noexcept
+    {
+        const auto format = FormatOf(arApdu);
+        CountApdu(mpValues->apdusReceived, mpValues->bytesReceived, format, arApdu.Length());
+    }
+
+    void LinkMetrics::Sent(const Apdu& arApdu) noexcept
+    {
+        const auto format = FormatOf(arApdu.View());
+        CountApdu(mpValues->apdusSent, mpValues->bytesSent, format, arApdu.Length());
+    }
+
+    void LinkMetrics::DecodeError() noexcept
+    {
+        mpValues->decodeErrors.Add();
+    }
+
+    void LinkMetrics::T1Expired() noexcept
+    {
+        mpValues->t1Expired.Add();
+    }
+
+    void LinkMetrics::T2Ack() noexcept
+    {
+        mpValues->t2Acks.Add();
+    }
+
+    void LinkMetrics::SendQueue(size_t aDepth) noexcept
+    {
+        mpValues->sendQueue.Set(static_cast<int64_t>(aDepth));
+        mpValues->sendQueueDepth.Record(aDepth);
+    }
+
+    void LinkMetrics::ReceiveTime(std::chrono::nanoseconds aElapsed) noexcept
+    {
+        mpValues->receiveTime.Record(static_cast<uint64_t>(aElapsed.count()));
+    }
+
+    void LinkMetrics::TimerTime(std::chrono::nanoseconds aElapsed) noexcept
+    {
+        mpValues->timerTime.Record(static_cast<uint64_t>(aElapsed.count()));
+    }
+
+    LinkMetrics::Snapshot LinkMetrics::Read() const noexcept
+    {
+        return mpValues->Read();
+    }
+
+    LinkMetricsGroup::~LinkMetricsGroup() noexcept
+    {
+        for (auto& chunk : mChunks)
+            delete[] chunk.load(std::memory_order_relaxed);
+    }
+
+    LinkMetrics::Snapshot LinkMetricsGroup::Read() const noexcept
+    {
+        for (;;)
+        {
+            const auto version = mVersion.load(std::memory_order_acquire);
+
+            if (version % 2 == 0)
+            {
+                auto result = mRemoved.Read();
+
+                for (size_t i = 0; i < CHUNKS; ++i)
+                {
+                    const auto* p_chunk = mChunks[i].load(std::memory_order_acquire);
+                    if (!p_chunk)
+                        break;
+
+                    for (size_t j = 0; j < (FIRST_CHUNK << i); ++j)
+                    {
+                        if (p_chunk[j].used.load(std::memory_order_relaxed))
+                            result += p_chunk[j].Read();
+                    }
+                }
+
+                // The values are only consistent, if no link joined or left meanwhile
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (mVersion.load(std::memory_order_relaxed) == version)
+                    return result;
+            }
+
+            std::this_thread::yield();
+        }
+    }
+
+    LinkMetrics::Values& LinkMetricsGroup::Join()
+    {
+        if (!mpFree)
+            AddChunk();
+
+        auto& values = *mpFree;
+        mpFree = values.pNextFree;
+
+        BeginChange();
+        values.Reset();
+        values.used.store(true, std::memory_order_relaxed);
+        EndChange();
+
+        return values;
+    }
+
+    void LinkMetricsGroup::Leave(LinkMetrics::Values& arValues) noexcept
+    {
+        BeginChange();
+        mRemoved.Add(arValues.Read());
+        arValues.used.store(false, std::memory_order_relaxed);
+        EndChange();
+
+        arValues.pNextFree = mpFree;
+        mpFree = &arValues;
+    }
+
+    void LinkMetricsGroup::AddChunk()
+    {
+        if (mChunkCount == CHUNKS)
+            throw std::length_error("too many links in a metrics group");
+
+        const size_t size = FIRST_CHUNK << mChunkCount;
+        auto* p_chunk = new LinkMetrics::Values[size];
+
+        for (size_t i = size; i > 0; --i)
+        {
+            p_chunk[i - 1].pNextFree = mpFree;
+            mpFree = &p_chunk[i - 1];
+        }
+
+        // Published after the values are constructed
+        mChunks[mChunkCount++].store(p_chunk, std::memory_order_release);
+    }
+
+    void LinkMetricsGroup::BeginChange() noexcept
+    {
+        mVersion.store(mVersion.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void LinkMetricsGroup::EndChange() noexcept
+    {
+        mVersion.store(mVersion.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+}
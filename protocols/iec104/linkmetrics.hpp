@@ -0,0 +1,173 @@
+#ifndef IEC104_LINKMETRICS_HPP_
+#define IEC104_LINKMETRICS_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "core/metrics.hpp"
+
+namespace IEC104
+{
+    class Apdu;
+    class ApduView;
+    class LinkMetricsGroup;
+
+    enum class FrameFormat
+    {
+        I, // Information transfer
+        S, // Numbered supervisory
+        U  // Unnumbered control
+    };
+
+    /**
+     * @brief Traffic and health of a link
+     *
+     * Written by the thread, which runs the link. Read from any thread without locks.
+     * As there is a single writer, an update is a plain load and store. A group of links is only summed up,
+     * when it is read, so an update never touches anything but the metrics of its own link.
+     *
+     * The metrics of a link share their cache lines. They are aligned as a whole,
+     * so the metrics of links on different threads never share a line.
+     */
+    class LinkMetrics
+    {
+    public:
+        static constexpr size_t FORMATS = 3;
+
+        // Values read at once
+        struct Snapshot
+        {
+            std::array<uint64_t, FORMATS> apdusReceived{};
+            std::array<uint64_t, FORMATS> bytesReceived{};
+            std::array<uint64_t, FORMATS> apdusSent{};
+            std::array<uint64_t, FORMATS> bytesSent{};
+            uint64_t decodeErrors = 0;
+            uint64_t t1Expired = 0;
+            uint64_t t2Acks = 0;
+            int64_t sendQueue = 0;
+            CORE::Histogram::Snapshot sendQueueDepth;
+            // Nanoseconds
+            CORE::Histogram::Snapshot receiveTime;
+            CORE::Histogram::Snapshot timerTime;
+
+            Snapshot& operator+=(const Snapshot& arOther) noexcept;
+        };
+
+        LinkMetrics();
+        // Leaves the group, which keeps the final values
+        ~LinkMetrics() noexcept;
+
+        LinkMetrics(const LinkMetrics&)            = delete;
+        LinkMetrics& operator=(const LinkMetrics&) = delete;
+
+        // Join a group, which outlives this object. Called by the thread, which writes the metrics.
+        // The metrics start over within the group.
+        void AttachGroup(LinkMetricsGroup& arGroup);
+
+        static FrameFormat FormatOf(const ApduView& arApdu) noexcept;
+
+        void Received(const ApduView& arApdu) noexcept;
+        void Sent(const Apdu& arApdu) noexcept;
+        // The peer sent data, which could not be handled
+        void DecodeError() noexcept;
+        // The peer did not acknowledge in time
+        void T1Expired() noexcept;
+        // An acknowledge was sent, because T2 expired before w frames were received
+        void T2Ack() noexcept;
+        // Number of I-Frames, which still wait for transmission at the end of a flush
+        void SendQueue(size_t aDepth) noexcept;
+        // Time spent to handle a single read
+        void ReceiveTime(std::chrono::nanoseconds aElapsed) noexcept;
+        // Time spent to check the timers
+        void TimerTime(std::chrono::nanoseconds aElapsed) noexcept;
+
+        Snapshot Read() const noexcept;
+
+    private:
+        friend class LinkMetricsGroup;
+
+        using Counters = std::array<CORE::SingleWriterCounter, FORMATS>;
+
+        // Storage of the metrics. Owned by the group, while the link is a member of it.
+        struct alignas(CORE::CACHE_LINE) Values
+        {
+            Counters apdusReceived;
+            Counters bytesReceived;
+            Counters apdusSent;
+            Counters bytesSent;
+            CORE::SingleWriterCounter decodeErrors;
+            CORE::SingleWriterCounter t1Expired;
+            CORE::SingleWriterCounter t2Acks;
+            CORE::Gauge sendQueue;
+            CORE::SingleWriterHistogram sendQueueDepth;
+            CORE::SingleWriterHistogram receiveTime;
+            CORE::SingleWriterHistogram timerTime;
+
+            // Held by a link of the group
+            std::atomic<bool> used{false};
+            // Next unused values of the group
+            Values* pNextFree = nullptr;
+
+            Snapshot Read() const noexcept;
+            // Add the final values of a link. The send queue is left out.
+            void Add(const Snapshot& arSnapshot) noexcept;
+            void Reset() noexcept;
+        };
+
+        static void CountApdu(Counters& arApdus, Counters& arBytes, FrameFormat aFormat, size_t aLength) noexcept;
+
+        // Until the link joins a group
+        std::unique_ptr<Values> mpOwn;
+        Values* mpValues;
+        LinkMetricsGroup* mpGroup = nullptr;
+    };
+
+    /**
+     * @brief Sum of the metrics of a group of links, including the removed ones
+     *
+     * The group owns the metrics of its links. They are never released before the group,
+     * but reused by the next link, which joins. The totals of removed links are kept in single writer
+     * counters as well. Links join and leave on the thread, which runs them, and never wait for a reader.
+     * A reader, which overlaps with a join or leave, sums up again.
+     */
+    class LinkMetricsGroup
+    {
+    public:
+        LinkMetricsGroup() = default;
+        ~LinkMetricsGroup() noexcept;
+
+        LinkMetricsGroup(const LinkMetricsGroup&)            = delete;
+        LinkMetricsGroup& operator=(const LinkMetricsGroup&) = delete;
+
+        // Combine the current links and the removed ones. May be called from any thread.
+        LinkMetrics::Snapshot Read() const noexcept;
+
+    private:
+        friend class LinkMetrics;
+
+        // Chunk i holds FIRST_CHUNK << i values
+        static constexpr size_t FIRST_CHUNK = 16;
+        static constexpr size_t CHUNKS = 32;
+
+        LinkMetrics::Values& Join();
+        void Leave(LinkMetrics::Values& arValues) noexcept;
+        void AddChunk();
+
+        // A join or leave is in progress, while the version is odd
+        void BeginChange() noexcept;
+        void EndChange() noexcept;
+
+        std::atomic<uint64_t> mVersion{0};
+        std::array<std::atomic<LinkMetrics::Values*>, CHUNKS> mChunks{};
+        size_t mChunkCount = 0;
+        LinkMetrics::Values* mpFree = nullptr;
+        // Final values of the removed links. They no longer queue any frames.
+        LinkMetrics::Values mRemoved;
+    };
+}
+
+#endif
@@ -0,0 +1,635 @@
+#include "protocols/iec104/pcapimport.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "core/bytecursor.hpp"
+#include "core/bytestream.hpp"
+#include "protocols/iec104/apdu.hpp"
+#include "protocols/iec104/asdu.hpp"
+#include "protocols/iec104/pcapreader.hpp"
+
+namespace IEC104
+{
+    static constexpr uint32_t LINKTYPE_NULL      = 0;
+    static constexpr uint32_t LINKTYPE_ETHERNET  = 1;
+    static constexpr uint32_t LINKTYPE_RAW_BSD   = 12;
+    static constexpr uint32_t LINKTYPE_RAW_BSDOS = 14;
+    static constexpr uint32_t LINKTYPE_RAW       = 101;
+    static constexpr uint32_t LINKTYPE_LINUX_SLL = 113;
+    static constexpr uint32_t LINKTYPE_IPV4      = 228;
+    static constexpr uint32_t LINKTYPE_IPV6      = 229;
+    static constexpr uint32_t LINKTYPE_LINUX_SLL2 = 276;
+
+    static constexpr uint16_t ETHERTYPE_IPV4 = 0x0800;
+    static constexpr uint16_t ETHERTYPE_IPV6 = 0x86DD;
+    static constexpr uint16_t ETHERTYPE_VLAN = 0x8100;
+    static constexpr uint16_t ETHERTYPE_QINQ = 0x88A8;
+    static constexpr uint8_t IP_PROTOCOL_TCP = 6;
+
+    // Bytes, which may be queued for a single worker, before the reader waits
+    static constexpr size_t MAX_QUEUED_BYTES = 4 * 1024 * 1024;
+    // Out-of-order bytes, which are buffered per direction, before the missing bytes are given up
+    static constexpr size_t MAX_PENDING_BYTES = 256 * 1024;
+
+    static bool ParseTcp(std::span<const uint8_t> aSegment, TcpSegment& arSegment,
+                         const asio::ip::address& arSource, const asio::ip::address& arDestination)
+    {
+        if (aSegment.size() < 20)
+            return false;
+
+        const size_t header = (aSegment[12] >> 4) * 4;
+        if (header < 20 || header > aSegment.size())
+            return false;
+
+        const uint8_t flags = aSegment[13];
+
+        arSegment.source = {arSource, CORE::LoadBE<uint16_t>(aSegment.data())};
+        arSegment.destination = {arDestination, CORE::LoadBE<uint16_t>(aSegment.data() + 2)};
+        arSegment.sequence = CORE::LoadBE<uint32_t>(aSegment.data() + 4);
+        arSegment.fin = flags & 0x01;
+        arSegment.syn = flags & 0x02;
+        arSegment.rst = flags & 0x04;
+        arSegment.payload = aSegment.subspan(header);
+        return true;
+    }
+
+    static bool ParseIp(std::span<const uint8_t> aPacket, TcpSegment& arSegment)
+    {
+        if (aPacket.empty())
+            return false;
+
+        const uint8_t version = aPacket[0] >> 4;
+
+        if (version == 4)
+        {
+            if (aPacket.size() < 20)
+                return false;
+
+            const size_t header = (aPacket[0] & 0x0F) * 4;
+            const size_t total = CORE::LoadBE<uint16_t>(aPacket.data() + 2);
+            const uint16_t fragment = CORE::LoadBE<uint16_t>(aPacket.data() + 6);
+
+            // Fragments (more fragments flag or an offset) are not reassembled
+            if (aPacket[9] != IP_PROTOCOL_TCP || (fragment & 0x3FFF) != 0)
+                return false;
+
+            if (header < 20 || total < header || total > aPacket.size())
+                return false;
+
+            asio::ip::address_v4::bytes_type source, destination;
+            std::copy_n(aPacket.data() + 12, 4, source.begin());
+            std::copy_n(aPacket.data() + 16, 4, destination.begin());
+
+            // The total length drops the padding of short ethernet frames
+            return ParseTcp(aPacket.subspan(header, total - header), arSegment,
+                            asio::ip::address_v4(source), asio::ip::address_v4(destination));
+        }
+
+        if (version == 6)
+        {
+            if (aPacket.size() < 40 || aPacket[6] != IP_PROTOCOL_TCP)
+                return false;
+
+            const size_t payload = CORE::LoadBE<uint16_t>(aPacket.data() + 4);
+            if (40 + payload > aPacket.size())
+                return false;
+
+            asio::ip::address_v6::bytes_type source, destination;
+            std::copy_n(aPacket.data() + 8, 16, source.begin());
+            std::copy_n(aPacket.data() + 24, 16, destination.begin());
+
+            return ParseTcp(aPacket.subspan(40, payload), arSegment,
+                            asio::ip::address_v6(source), asio::ip::address_v6(destination));
+        }
+
+        return false;
+    }
+
+    static bool ParseEtherType(uint16_t aType, std::span<const uint8_t> aPayload, TcpSegment& arSegment)
+    {
+        // VLAN tags are skipped
+        while ((aType == ETHERTYPE_VLAN || aType == ETHERTYPE_QINQ) && aPayload.size() >= 4)
+        {
+            aType = CORE::LoadBE<uint16_t>(aPayload.data() + 2);
+            aPayload = aPayload.subspan(4);
+        }
+
+        if (aType != ETHERTYPE_IPV4 && aType != ETHERTYPE_IPV6)
+            return false;
+
+        return ParseIp(aPayload, arSegment);
+    }
+
+    bool ParseTcpSegment(uint32_t aLinkType, std::span<const uint8_t> aPacket, TcpSegment& arSegment)
+    {
+        switch (aLinkType)
+        {
+        case LINKTYPE_ETHERNET:
+            if (aPacket.size() < 14)
+                return false;
+            return ParseEtherType(CORE::LoadBE<uint16_t>(aPacket.data() + 12), aPacket.subspan(14), arSegment);
+
+        case LINKTYPE_LINUX_SLL:
+            if (aPacket.size() < 16)
+                return false;
+            return ParseEtherType(CORE::LoadBE<uint16_t>(aPacket.data() + 14), aPacket.subspan(16), arSegment);
+
+        case LINKTYPE_LINUX_SLL2:
+            if (aPacket.size() < 20)
+                return false;
+            return ParseEtherType(CORE::LoadBE<uint16_t>(aPacket.data()), aPacket.subspan(20), arSegment);
+
+        case LINKTYPE_NULL:
+            // The address family is stored in the byte order of the capturing host. IPv4 is 2 on every system.
+            if (aPacket.size() < 4)
+                return false;
+            return ParseIp(aPacket.subspan(4), arSegment);
+
+        case LINKTYPE_RAW:
+        case LINKTYPE_RAW_BSD:
+        case LINKTYPE_RAW_BSDOS:
+        case LINKTYPE_IPV4:
+        case LINKTYPE_IPV6:
+            return ParseIp(aPacket, arSegment);
+
+        default:
+            return false;
+        }
+    }
+
+    namespace
+    {
+        // Segment, which was handed over to a worker
+        struct QueuedSegment
+        {
+            // Shared by the queued segments and the reader, until the connection is closed
+            std::shared_ptr<const PcapConnection> connection;
+            bool fromServer = false;
+            bool syn = false;
+            bool fin = false;
+            bool rst = false;
+            // Last segment of the connection. The worker releases its state afterwards.
+            bool close = false;
+            uint32_t sequence = 0;
+            std::chrono::nanoseconds timestamp{};
+            std::vector<uint8_t> payload;
+        };
+
+        // Reassembles and decodes a single direction of a connection
+        class Stream
+        {
+        public:
+            // Add a segment. Returns the number of gaps, which had to be skipped.
+            size_t Push(const QueuedSegment& arSegment)
+            {
+                uint32_t sequence = arSegment.sequence;
+
+                // The data starts behind the SYN
+                if (arSegment.syn)
+                {
+                    mNext = ++sequence;
+                    mPending.clear();
+                    mPendingBytes = 0;
+                }
+
+                // A capture, which started amid the connection, begins with its first segment
+                if (!mNext)
+                    mNext = sequence;
+
+                if (arSegment.payload.empty())
+                    return 0;
+
+                const auto distance = static_cast<int32_t>(sequence - *mNext);
+
+                if (distance <= 0)
+                {
+                    // Data before the expected sequence was retransmitted
+                    const size_t skip = static_cast<size_t>(-static_cast<int64_t>(distance));
+                    if (skip < arSegment.payload.size())
+                        Append(arSegment.payload.data() + skip, arSegment.payload.size() - skip);
+
+                    DrainPending();
+                    return 0;
+                }
+
+                const uint64_t position = mPosition + static_cast<uint64_t>(distance);
+                auto& pending = mPending[position];
+
+                if (arSegment.payload.size() > pending.size())
+                {
+                    mPendingBytes += arSegment.payload.size() - pending.size();
+                    pending = arSegment.payload;
+                }
+
+                size_t gaps = 0;
+
+                // The missing data is given up. Decoding continues at the earliest buffered data.
+                while (mPendingBytes > MAX_PENDING_BYTES)
+                {
+                    SkipTo(mPending.begin()->first);
+                    DrainPending();
+                    ++gaps;
+                }
+
+                return gaps;
+            }
+
+            // Decode all complete APDUs
+            template <typename EMIT>
+            void Decode(EMIT&& aEmit)
+            {
+                while (mBuffer.RemainingBytes() > 0)
+                {
+                    // Search the next APDU after a gap or malformed data
+                    if (mBuffer.PeekAt(0) != ApduView::START_BYTE)
+                    {
+                        if (!mResync)
+                            aEmit(PcapEvent::Type::MALFORMED, nullptr, "stream does not continue with an APDU");
+
+                        mResync = true;
+                        mBuffer.ReadByte();
+                        continue;
+                    }
+
+                    try
+                    {
+                        if (!Apdu::IsFullyAvailable(mBuffer))
+                            break;
+
+                        ApduView view(mBuffer);
+                        mResync = false;
+                        aEmit(PcapEvent::Type::APDU, &view, nullptr);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        if (!mResync)
+                            aEmit(PcapEvent::Type::MALFORMED, nullptr, e.what());
+
+                        mResync = true;
+                        if (mBuffer.RemainingBytes() > 0)
+                            mBuffer.ReadByte();
+                    }
+                }
+
+                mBuffer.Reclaim(ApduView::MAX_LENGTH);
+            }
+
+            // Data is lost and the partial APDU is useless
+            void Discard() noexcept
+            {
+                mBuffer.Clear();
+                mResync = true;
+            }
+
+        private:
+            void Append(const uint8_t* apData, size_t aBytes)
+            {
+                mBuffer.WriteData(apData, aBytes);
+                *mNext += static_cast<uint32_t>(aBytes);
+                mPosition += aBytes;
+            }
+
+            void SkipTo(uint64_t aPosition)
+            {
+                *mNext += static_cast<uint32_t>(aPosition - mPosition);
+                mPosition = aPosition;
+                Discard();
+            }
+
+            // Append buffered segments, which now continue the stream
+            void DrainPending()
+            {
+                while (!mPending.empty() && mPending.begin()->first <= mPosition)
+                {
+                    auto node = mPending.extract(mPending.begin());
+                    const auto& data = node.mapped();
+                    const size_t skip = static_cast<size_t>(mPosition - node.key());
+
+                    mPendingBytes -= data.size();
+                    if (skip < data.size())
+                        Append(data.data() + skip, data.size() - skip);
+                }
+            }
+
+        private:
+            // Sequence number of the next byte
+            std::optional<uint32_t> mNext;
+            // Position of the next byte since the start of the stream, which does not wrap around
+            uint64_t mPosition = 0;
+            // Out-of-order segments by their position
+            std::map<uint64_t, std::vector<uint8_t>> mPending;
+            size_t mPendingBytes = 0;
+            ByteStream mBuffer;
+            bool mResync = false;
+        };
+
+        struct ConnectionState
+        {
+            Stream streams[2];
+        };
+    }
+
+    // Reassembles and decodes the connections, which were assigned to it. Optionally on its own thread.
+    class PcapImport::Worker
+    {
+    public:
+        Worker(const Handler& arHandler, bool aThreaded)
+            : mHandler(arHandler)
+        {
+            if (aThreaded)
+                mThread = std::thread([this] { Run(); });
+        }
+
+        ~Worker()
+        {
+            Finish();
+        }
+
+        Worker(const Worker&)            = delete;
+        Worker& operator=(const Worker&) = delete;
+
+        void Push(QueuedSegment&& arSegment)
+        {
+            if (!mThread.joinable())
+            {
+                Handle(arSegment);
+                return;
+            }
+
+            std::unique_lock lock(mMutex);
+            mSpace.wait(lock, [this] { return mQueuedBytes < MAX_QUEUED_BYTES || mError; });
+
+            // The handler failed on the worker thread. The import stops with its exception.
+            if (mError)
+                std::rethrow_exception(mError);
+
+            mQueuedBytes += arSegment.payload.size();
+            mQueue.push_back(std::move(arSegment));
+            mReady.notify_one();
+        }
+
+        // Wait until all queued segments are decoded
+        void Finish()
+        {
+            if (!mThread.joinable())
+                return;
+
+            {
+                std::lock_guard lock(mMutex);
+                mDone = true;
+            }
+
+            mReady.notify_one();
+            mThread.join();
+        }
+
+        const PcapStats& Stats() const noexcept { return mStats; }
+        // Exception of the handler, which stopped the worker thread. Read after Finish.
+        std::exception_ptr Error() const noexcept { return mError; }
+
+    private:
+        void Run()
+        {
+            std::deque<QueuedSegment> batch;
+
+            for (;;)
+            {
+                {
+                    std::unique_lock lock(mMutex);
+                    mReady.wait(lock, [this] { return !mQueue.empty() || mDone; });
+
+                    if (mQueue.empty())
+                        return;
+
+                    // The whole queue is taken at once, so the reader is blocked as little as possible
+                    batch.swap(mQueue);
+                    mQueuedBytes = 0;
+                }
+
+                mSpace.notify_one();
+
+                try
+                {
+                    for (auto& segment : batch)
+                        Handle(segment);
+                }
+                catch (...)
+                {
+                    // Handed back to the reader, which is woken, if it waits for space
+                    std::lock_guard lock(mMutex);
+                    mError = std::current_exception();
+                    mSpace.notify_one();
+                    return;
+                }
+
+                batch.clear();
+            }
+        }
+
+        void Handle(const QueuedSegment& arSegment)
+        {
+            const auto& connection = *arSegment.connection;
+            auto& state = mConnections[connection.id];
+            auto& stream = state.streams[arSegment.fromServer];
+
+            PcapEvent event;
+            event.connection = &connection;
+            event.fromServer = arSegment.fromServer;
+            event.timestamp = arSegment.timestamp;
+
+            const size_t gaps = stream.Push(arSegment);
+            for (size_t i = 0; i < gaps; ++i)
+            {
+                event.type = PcapEvent::Type::GAP;
+                ++mStats.gaps;
+                mHandler(event);
+            }
+
+            stream.Decode([&](PcapEvent::Type aType, const ApduView* apApdu, const char* apError) {
+                event.type = aType;
+                event.apdu = apApdu;
+                event.asdu = nullptr;
+                event.error = apError;
+
+                if (aType == PcapEvent::Type::MALFORMED)
+                {
+                    ++mStats.errors;
+                    mHandler(event);
+                    return;
+                }
+
+                ++mStats.apdus;
+
+                if (!apApdu->HasPayload())
+                {
+                    mHandler(event);
+                    return;
+                }
+
+                try
+                {
+                    Asdu asdu;
+                    asdu.ReadFrom(*apApdu);
+                    ++mStats.asdus;
+                    event.asdu = &asdu;
+                    mHandler(event);
+                }
+                catch (const std::exception& e)
+                {
+                    ++mStats.errors;
+                    event.type = PcapEvent::Type::MALFORMED;
+                    event.error = e.what();
+                    mHandler(event);
+                }
+            });
+
+            // Closed connections release their buffers
+            if (arSegment.close)
+                mConnections.erase(connection.id);
+        }
+
+    private:
+        const Handler& mHandler;
+        PcapStats mStats;
+        std::unordered_map<uint32_t, ConnectionState> mConnections;
+
+        std::mutex mMutex;
+        std::condition_variable mReady;
+        std::condition_variable mSpace;
+        std::deque<QueuedSegment> mQueue;
+        size_t mQueuedBytes = 0;
+        bool mDone = false;
+        std::exception_ptr mError;
+        // declared last: started after all other members are initialized
+        std::thread mThread;
+    };
+
+    PcapImport::PcapImport(Handler aHandler, size_t aWorkers, uint16_t aPort)
+        : mHandler(std::move(aHandler))
+        , mWorkers(aWorkers)
+        , mPort(aPort)
+    {
+    }
+
+    PcapStats PcapImport::Run(const std::string& arPath) const
+    {
+        PcapReader reader(arPath);
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        for (size_t i = 0; i < std::max<size_t>(mWorkers, 1); ++i)
+            workers.push_back(std::make_unique<Worker>(mHandler, mWorkers > 0));
+
+        struct Assignment
+        {
+            std::shared_ptr<const PcapConnection> connection;
+            Worker* worker;
+            // Data was exchanged, so a SYN belongs to a new connection and is no retransmission
+            bool established = false;
+            // FIN of the client and the server
+            bool finished[2] = { false, false };
+        };
+
+        // Only open connections are assigned. Closed ones are released, once their worker handled them.
+        std::map<std::pair<asio::ip::tcp::endpoint, asio::ip::tcp::endpoint>, Assignment> assignments;
+        uint32_t next_id = 0;
+        PcapStats stats;
+
+        auto close = [](Assignment& arAssignment) {
+            QueuedSegment last;
+            last.connection = arAssignment.connection;
+            last.close = true;
+            arAssignment.worker->Push(std::move(last));
+        };
+
+        PcapPacket packet;
+        TcpSegment segment;
+
+        while (reader.Next(packet))
+        {
+            ++stats.packets;
+
+            if (!ParseTcpSegment(packet.linkType, packet.data, segment))
+                continue;
+
+            const bool from_server = segment.source.port() == mPort;
+            if (!from_server && segment.destination.port() != mPort)
+                continue;
+
+            ++stats.segments;
+
+            const auto& client = from_server ? segment.destination : segment.source;
+            const auto& server = from_server ? segment.source : segment.destination;
+            auto key = std::make_pair(client, server);
+            auto found = assignments.find(key);
+
+            // A SYN of the client starts a new connection, even if the addresses were used before
+            if (found == assignments.end() || (segment.syn && !from_server && found->second.established))
+            {
+                // Trailing segments of a closed connection do not start another one
+                if (!segment.syn && segment.payload.empty())
+                    continue;
+
+                // The addresses are reused, before the previous connection was closed
+                if (found != assignments.end())
+                    close(found->second);
+
+                auto connection = std::make_shared<const PcapConnection>(PcapConnection{next_id++, client, server});
+                auto* p_worker = workers[connection->id % workers.size()].get();
+                found = assignments.insert_or_assign(key, Assignment{std::move(connection), p_worker}).first;
+            }
+
+            auto& assignment = found->second;
+
+            if (!segment.payload.empty() || segment.fin || segment.rst)
+                assignment.established = true;
+            if (segment.rst)
+                assignment.finished[0] = assignment.finished[1] = true;
+            if (segment.fin)
+                assignment.finished[from_server] = true;
+
+            QueuedSegment queued;
+            queued.connection = assignment.connection;
+            queued.fromServer = from_server;
+            queued.syn = segment.syn;
+            queued.fin = segment.fin;
+            queued.rst = segment.rst;
+            queued.sequence = segment.sequence;
+            queued.timestamp = packet.timestamp;
+            queued.payload.assign(segment.payload.begin(), segment.payload.end());
+            queued.close = assignment.finished[0] && assignment.finished[1];
+
+            const bool closed = queued.close;
+            assignment.worker->Push(std::move(queued));
+
+            if (closed)
+                assignments.erase(found);
+        }
+
+        for (auto& p_worker : workers)
+            p_worker->Finish();
+
+        for (auto& p_worker : workers)
+        {
+            if (auto error = p_worker->Error())
+                std::rethrow_exception(error);
+
+            const auto& worker_stats = p_worker->Stats();
+            stats.apdus += worker_stats.apdus;
+            stats.asdus += worker_stats.asdus;
+            stats.gaps += worker_stats.gaps;
+            stats.errors += worker_stats.errors;
+        }
+
+        stats.connections = next_id;
+        return stats;
+    }
+}
@@ -0,0 +1,132 @@
+#ifndef IEC104_PCAPIMPORT_HPP_
+#define IEC104_PCAPIMPORT_HPP_
+
+#include <boost/asio/ip/tcp.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <thread>
+
+namespace asio = boost::asio;
+
+namespace IEC104
+{
+    class ApduView;
+    class Asdu;
+
+    // TCP segment of a captured packet. The payload refers to the packet.
+    struct TcpSegment
+    {
+        asio::ip::tcp::endpoint source;
+        asio::ip::tcp::endpoint destination;
+        uint32_t sequence = 0;
+        bool syn = false;
+        bool fin = false;
+        bool rst = false;
+        std::span<const uint8_t> payload;
+    };
+
+    /**
+     * @brief Extract the TCP segment of a captured packet
+     *
+     * Ethernet (with VLAN tags), Linux cooked capture v1/v2, raw IP and BSD loopback are supported,
+     * each carrying IPv4 or IPv6. Fragmented IPv4 packets and IPv6 extension headers are not.
+     * @return false, if the packet does not carry a TCP segment
+     */
+    bool ParseTcpSegment(uint32_t aLinkType, std::span<const uint8_t> aPacket, TcpSegment& arSegment);
+
+    struct PcapConnection
+    {
+        // Numbered in the order of their first packet
+        uint32_t id = 0;
+        // Controlling station, which opened the connection
+        asio::ip::tcp::endpoint client;
+        // Controlled station, which listens on the IEC 104 port
+        asio::ip::tcp::endpoint server;
+    };
+
+    struct PcapEvent
+    {
+        enum class Type
+        {
+            // A complete APDU
+            APDU,
+            // Bytes of the stream are missing in the capture. Decoding resumes at the next APDU.
+            GAP,
+            // The stream or its ASDU could not be decoded
+            MALFORMED
+        };
+
+        Type type = Type::APDU;
+        // Only valid during the call. Copy it to retain the connection.
+        const PcapConnection* connection = nullptr;
+        // true for data, which was sent by the controlled station
+        bool fromServer = false;
+        // Time of the packet, which completed the APDU
+        std::chrono::nanoseconds timestamp{};
+        // Set for APDU events. Only valid during the call.
+        const ApduView* apdu = nullptr;
+        // Set for APDU events of I-Frames, which could be decoded
+        const Asdu* asdu = nullptr;
+        // Description of an error
+        const char* error = nullptr;
+    };
+
+    struct PcapStats
+    {
+        uint64_t packets = 0;
+        uint64_t segments = 0;
+        uint64_t connections = 0;
+        uint64_t apdus = 0;
+        uint64_t asdus = 0;
+        uint64_t gaps = 0;
+        uint64_t errors = 0;
+    };
+
+    /**
+     * @brief Decodes the IEC 104 connections of a pcap or pcapng file
+     *
+     * The file is read on the calling thread, which reassembles nothing itself but distributes the segments.
+     * Every connection is assigned to a single worker. The worker reassembles both directions of its
+     * connections and decodes them with ByteStream, Apdu and Asdu.
+     *
+     * Memory is bounded: the file is streamed, the queue of each worker is limited and out-of-order data
+     * of a stream is only buffered up to a limit. Beyond that, the missing bytes are reported as a gap.
+     * A connection is released, once it was closed by FIN or RST, or its addresses are reused by a new SYN.
+     */
+    class PcapImport
+    {
+    public:
+        /**
+         * @brief Receives the events of all connections
+         *
+         * The events of a connection are delivered in order by the same worker.
+         * Events of different connections are delivered concurrently.
+         * An exception of the handler stops the import and is rethrown by Run.
+         */
+        using Handler = std::function<void(const PcapEvent&)>;
+
+        /**
+         * @param aHandler Receiver of all events
+         * @param aWorkers Number of worker threads. With 0 workers, all connections are decoded on the calling thread.
+         * @param aPort TCP port of the controlled stations
+         */
+        explicit PcapImport(Handler aHandler, size_t aWorkers = std::thread::hardware_concurrency(), uint16_t aPort = 2404);
+
+        // Decode a capture file. Returns, after all its connections have been decoded.
+        PcapStats Run(const std::string& arPath) const;
+
+    private:
+        class Worker;
+
+        Handler mHandler;
+        size_t mWorkers;
+        uint16_t mPort;
+    };
+}
+
+#endif
@@ -0,0 +1,290 @@
+#include "protocols/iec104/pcapreader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "core/bytecursor.hpp"
+
+namespace IEC104
+{
+    // Data is read from the file in chunks of this size
+    static constexpr size_t READ_SIZE = 1024 * 1024;
+    // Larger blocks are rejected as malformed, instead of growing the buffer without limit
+    static constexpr size_t MAX_BLOCK_SIZE = 64 * 1024 * 1024;
+
+    static constexpr uint32_t PCAP_MAGIC_US    = 0xA1B2C3D4;
+    static constexpr uint32_t PCAP_MAGIC_NS    = 0xA1B23C4D;
+    static constexpr size_t PCAP_HEADER_SIZE   = 24;
+    static constexpr size_t PCAP_RECORD_SIZE   = 16;
+
+    static constexpr uint32_t BLOCK_SECTION_HEADER   = 0x0A0D0D0A;
+    static constexpr uint32_t BLOCK_INTERFACE        = 0x00000001;
+    static constexpr uint32_t BLOCK_OBSOLETE_PACKET  = 0x00000002;
+    static constexpr uint32_t BLOCK_SIMPLE_PACKET    = 0x00000003;
+    static constexpr uint32_t BLOCK_ENHANCED_PACKET  = 0x00000006;
+    static constexpr uint32_t BYTE_ORDER_MAGIC       = 0x1A2B3C4D;
+    static constexpr uint16_t OPTION_TIMESTAMP_RESOLUTION = 9;
+
+    static uint32_t Swap32(uint32_t aValue) noexcept
+    {
+        return ((aValue & 0xFF) << 24) | ((aValue & 0xFF00) << 8) | ((aValue >> 8) & 0xFF00) | (aValue >> 24);
+    }
+
+    PcapReader::PcapReader(const std::string& arPath)
+        : mFile(arPath, std::ios::binary)
+        , mBuffer(READ_SIZE)
+    {
+        if (!mFile)
+            throw std::runtime_error("cannot open capture file " + arPath);
+
+        if (!Fill(4))
+            throw std::runtime_error(arPath + " is not a pcap file");
+
+        const auto magic = CORE::LoadLE<uint32_t>(Data());
+
+        if (magic == BLOCK_SECTION_HEADER)
+        {
+            mIsPcapNg = true;
+            ReadSectionHeader();
+            return;
+        }
+
+        if (magic == PCAP_MAGIC_US || magic == PCAP_MAGIC_NS)
+            mSwapped = false;
+        else if (Swap32(magic) == PCAP_MAGIC_US || Swap32(magic) == PCAP_MAGIC_NS)
+            mSwapped = true;
+        else
+            throw std::runtime_error(arPath + " is neither a pcap nor a pcapng file");
+
+        if (!Fill(PCAP_HEADER_SIZE))
+            throw std::runtime_error("header of " + arPath + " is truncated");
+
+        mPcap.linkType = Load32(Data() + 20);
+        mPcap.resolution = (Load32(Data()) == PCAP_MAGIC_NS) ? 1000000000 : 1000000;
+        Consume(PCAP_HEADER_SIZE);
+    }
+
+    bool PcapReader::Next(PcapPacket& arPacket)
+    {
+        return mIsPcapNg ? NextPcapNg(arPacket) : NextPcap(arPacket);
+    }
+
+    bool PcapReader::Fill(size_t aBytes)
+    {
+        if (mEnd - mBegin >= aBytes)
+            return true;
+
+        if (aBytes > MAX_BLOCK_SIZE)
+            throw std::runtime_error("block of capture file exceeds the size limit");
+
+        // Keep the remaining data and read behind it
+        std::memmove(mBuffer.data(), Data(), mEnd - mBegin);
+        mEnd -= mBegin;
+        mBegin = 0;
+
+        if (mBuffer.size() < aBytes)
+            mBuffer.resize(aBytes);
+
+        while (mEnd < aBytes)
+        {
+            mFile.read(reinterpret_cast<char*>(mBuffer.data() + mEnd), static_cast<std::streamsize>(mBuffer.size() - mEnd));
+            const auto read = static_cast<size_t>(mFile.gcount());
+
+            if (read == 0)
+                return false;
+
+            mEnd += read;
+        }
+
+        return true;
+    }
+
+    uint16_t PcapReader::Load16(const uint8_t* apSource) const noexcept
+    {
+        return mSwapped ? CORE::LoadBE<uint16_t>(apSource) : CORE::LoadLE<uint16_t>(apSource);
+    }
+
+    uint32_t PcapReader::Load32(const uint8_t* apSource) const noexcept
+    {
+        return mSwapped ? CORE::LoadBE<uint32_t>(apSource) : CORE::LoadLE<uint32_t>(apSource);
+    }
+
+    bool PcapReader::NextPcap(PcapPacket& arPacket)
+    {
+        // A packet, which was cut off at the end of the file, ends the capture
+        if (!Fill(PCAP_RECORD_SIZE))
+            return false;
+
+        const uint64_t seconds = Load32(Data());
+        const uint64_t fraction = Load32(Data() + 4);
+        const size_t captured = Load32(Data() + 8);
+
+        if (!Fill(PCAP_RECORD_SIZE + captured))
+            return false;
+
+        arPacket.timestamp = ToNanoseconds(seconds * mPcap.resolution + fraction, mPcap.resolution);
+        arPacket.linkType = mPcap.linkType;
+        arPacket.data = {Data() + PCAP_RECORD_SIZE, captured};
+
+        Consume(PCAP_RECORD_SIZE + captured);
+        return true;
+    }
+
+    bool PcapReader::NextPcapNg(PcapPacket& arPacket)
+    {
+        for (;;)
+        {
+            if (!Fill(8))
+                return false;
+
+            // The type of a section header reads the same in both byte orders
+            if (CORE::LoadLE<uint32_t>(Data()) == BLOCK_SECTION_HEADER)
+            {
+                ReadSectionHeader();
+                continue;
+            }
+
+            const uint32_t type = Load32(Data());
+            const size_t length = Load32(Data() + 4);
+
+            if (length < 12 || length % 4 != 0)
+                throw std::runtime_error("pcapng block has an invalid length");
+
+            if (!Fill(length))
+                return false;
+
+            const uint8_t* p_body = Data() + 8;
+            const size_t size = length - 12;
+            bool packet = false;
+
+            switch (type)
+            {
+            case BLOCK_INTERFACE:
+                ReadInterface(p_body, size);
+                break;
+
+            case BLOCK_ENHANCED_PACKET:
+            case BLOCK_OBSOLETE_PACKET:
+            {
+                if (size < 20)
+                    throw std::runtime_error("pcapng packet block is truncated");
+
+                const uint32_t id = (type == BLOCK_ENHANCED_PACKET) ? Load32(p_body) : Load16(p_body);
+                const uint64_t timestamp = (static_cast<uint64_t>(Load32(p_body + 4)) << 32) | Load32(p_body + 8);
+                const size_t captured = Load32(p_body + 12);
+
+                if (captured > size - 20)
+                    throw std::runtime_error("pcapng packet exceeds its block");
+
+                const auto& interface = GetInterface(id);
+                arPacket.timestamp = ToNanoseconds(timestamp, interface.resolution);
+                arPacket.linkType = interface.linkType;
+                arPacket.data = {p_body + 20, captured};
+                packet = true;
+                break;
+            }
+
+            case BLOCK_SIMPLE_PACKET:
+            {
+                if (size < 4)
+                    throw std::runtime_error("pcapng packet block is truncated");
+
+                // Simple packets have no timestamp and belong to the first interface
+                const size_t captured = std::min<size_t>(Load32(p_body), size - 4);
+                arPacket.timestamp = std::chrono::nanoseconds(0);
+                arPacket.linkType = GetInterface(0).linkType;
+                arPacket.data = {p_body + 4, captured};
+                packet = true;
+                break;
+            }
+
+            default:
+                break;
+            }
+
+            Consume(length);
+
+            if (packet)
+                return true;
+        }
+    }
+
+    void PcapReader::ReadSectionHeader()
+    {
+        if (!Fill(12))
+            throw std::runtime_error("pcapng section header is truncated");
+
+        const auto order = CORE::LoadLE<uint32_t>(Data() + 8);
+
+        if (order == BYTE_ORDER_MAGIC)
+            mSwapped = false;
+        else if (Swap32(order) == BYTE_ORDER_MAGIC)
+            mSwapped = true;
+        else
+            throw std::runtime_error("pcapng section header has an unknown byte order");
+
+        const size_t length = Load32(Data() + 4);
+
+        if (length < 12 || length % 4 != 0 || !Fill(length))
+            throw std::runtime_error("pcapng section header has an invalid length");
+
+        // Interface ids are local to their section
+        mInterfaces.clear();
+        Consume(length);
+    }
+
+    void PcapReader::ReadInterface(const uint8_t* apBody, size_t aSize)
+    {
+        if (aSize < 8)
+            throw std::runtime_error("pcapng interface block is truncated");
+
+        Interface interface;
+        interface.linkType = Load16(apBody);
+
+        // Options are padded to 32 bits
+        for (size_t pos = 8; pos + 4 <= aSize;)
+        {
+            const uint16_t code = Load16(apBody + pos);
+            const size_t length = Load16(apBody + pos + 2);
+
+            if (code == 0 || pos + 4 + length > aSize)
+                break;
+
+            if (code == OPTION_TIMESTAMP_RESOLUTION && length >= 1)
+            {
+                // Negative power of 2 with the upper bit set, negative power of 10 otherwise
+                const uint8_t value = apBody[pos + 4];
+                interface.resolution = 1;
+
+                if (value & 0x80)
+                    interface.resolution <<= std::min(value & 0x7F, 62);
+                else
+                    for (int i = 0; i < std::min<int>(value, 19); ++i)
+                        interface.resolution *= 10;
+            }
+
+            pos += 4 + (length + 3) / 4 * 4;
+        }
+
+        mInterfaces.push_back(interface);
+    }
+
+    const PcapReader::Interface& PcapReader::GetInterface(uint32_t aId) const
+    {
+        if (aId >= mInterfaces.size())
+            throw std::runtime_error("pcapng packet refers to an unknown interface");
+
+        return mInterfaces[aId];
+    }
+
+    std::chrono::nanoseconds PcapReader::ToNanoseconds(uint64_t aTimestamp, uint64_t aResolution) noexcept
+    {
+        // Split into seconds and fraction, so the multiplication cannot overflow
+        const uint64_t seconds = aTimestamp / aResolution;
+        const uint64_t fraction = aTimestamp % aResolution;
+
+        const auto nanos = static_cast<uint64_t>(static_cast<long double>(fraction) * 1e9L / static_cast<long double>(aResolution));
+        return std::chrono::nanoseconds(static_cast<int64_t>(seconds * 1000000000ull + nanos));
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef IEC104_PCAPREADER_HPP_
+#define IEC104_PCAPREADER_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace IEC104
+{
+    struct PcapPacket
+    {
+        std::chrono::nanoseconds timestamp{};
+        // Link-layer header type (LINKTYPE_*)
+        uint32_t linkType = 0;
+        // Captured bytes. Only valid until the next packet is read.
+        std::span<const uint8_t> data;
+    };
+
+    /**
+     * @brief Streaming reader for pcap and pcapng files
+     *
+     * Both formats are read in either byte order. Classic pcap files may have micro- or nanosecond timestamps.
+     * Of pcapng, enhanced, simple and obsolete packet blocks are read with the resolution of their interface.
+     * Other blocks are skipped.
+     *
+     * Only a single block is held in memory at a time, so files of any size are read with a bounded buffer.
+     */
+    class PcapReader
+    {
+    public:
+        explicit PcapReader(const std::string& arPath);
+
+        PcapReader(const PcapReader&)            = delete;
+        PcapReader& operator=(const PcapReader&) = delete;
+
+        // Read the next packet. false at the end of the file. Throws, if the file is malformed.
+        bool Next(PcapPacket& arPacket);
+
+        bool IsPcapNg() const noexcept { return mIsPcapNg; }
+
+    private:
+        struct Interface
+        {
+            uint32_t linkType = 0;
+            // Timestamp units per second
+            uint64_t resolution = 1000000;
+        };
+
+        // Make aBytes available at the current position. false, if the file ends before.
+        bool Fill(size_t aBytes);
+        void Consume(size_t aBytes) noexcept { mBegin += aBytes; }
+        const uint8_t* Data() const noexcept { return mBuffer.data() + mBegin; }
+
+        uint16_t Load16(const uint8_t* apSource) const noexcept;
+        uint32_t Load32(const uint8_t* apSource) const noexcept;
+
+        bool NextPcap(PcapPacket& arPacket);
+        bool NextPcapNg(PcapPacket& arPacket);
+        void ReadSectionHeader();
+        void ReadInterface(const uint8_t* apBody, size_t aSize);
+        const Interface& GetInterface(uint32_t aId) const;
+
+        static std::chrono::nanoseconds ToNanoseconds(uint64_t aTimestamp, uint64_t aResolution) noexcept;
+
+    private:
+        std::ifstream mFile;
+        std::vector<uint8_t> mBuffer;
+        size_t mBegin = 0;
+        size_t mEnd = 0;
+
+        bool mIsPcapNg = false;
+        bool mSwapped = false;
+        // Classic pcap
+        Interface mPcap;
+        // Interfaces of the current pcapng section
+        std::vector<Interface> mInterfaces;
+    };
+}
+
+#endif
@@ -0,0 +1,98 @@
+#include "protocols/iec104/processimage.hpp"
+
+#include <memory>
+#include <stdexcept>
+
+#include "protocols/iec104/asdu.hpp"
+#include "protocols/iec104/infoobjects.hpp"
+
+namespace IEC104
+{
+    namespace
+    {
+        template <typename INFOOBJECT, typename Write>
+        size_t WriteAll(const Asdu& arAsdu, Write&& aWrite)
+        {
+            size_t updated = 0;
+
+            for (const auto& p_object : arAsdu)
+            {
+                aWrite(p_object->As<INFOOBJECT>().ToRecord());
+                ++updated;
+            }
+
+            return updated;
+        }
+    }
+
+    ProcessImage::~ProcessImage() noexcept
+    {
+        mStations.ForEach([](size_t, std::atomic<Station*>& arStation) {
+            delete arStation.load(std::memory_order_relaxed);
+        });
+    }
+
+    bool ProcessImage::IsSupported(int aTypeId) noexcept
+    {
+        switch (aTypeId)
+        {
+        case DataSinglePoint::TYPE_ID:
+        case DataDoublePoint::TYPE_ID:
+        case DataMeasuredScaled::TYPE_ID:
+        case DataMeasuredFloat::TYPE_ID:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    size_t ProcessImage::Update(const Asdu& arAsdu)
+    {
+        if (!IsSupported(arAsdu.GetType()))
+            return 0;
+
+        const auto common_address = arAsdu.GetAddress();
+        auto write = [&](const auto& arRecord) { Write(common_address, arRecord); };
+
+        switch (arAsdu.GetType())
+        {
+        case DataSinglePoint::TYPE_ID:
+            return WriteAll<DataSinglePoint>(arAsdu, write);
+        case DataDoublePoint::TYPE_ID:
+            return WriteAll<DataDoublePoint>(arAsdu, write);
+        case DataMeasuredScaled::TYPE_ID:
+            return WriteAll<DataMeasuredScaled>(arAsdu, write);
+        default:
+            return WriteAll<DataMeasuredFloat>(arAsdu, write);
+        }
+    }
+
+    const ProcessImage::Station* ProcessImage::FindStation(int aCommonAddress) const noexcept
+    {
+        if (aCommonAddress < 0)
+            return nullptr;
+
+        const auto* p_entry = mStations.Find(static_cast<size_t>(aCommonAddress));
+        return p_entry ? p_entry->load(std::memory_order_acquire) : nullptr;
+    }
+
+    ProcessImage::Station& ProcessImage::GetStation(int aCommonAddress)
+    {
+        if (aCommonAddress < 0)
+            throw std::out_of_range("common address must not be negative");
+
+        auto& entry = mStations.Get(static_cast<size_t>(aCommonAddress));
+        Station* p_station = entry.load(std::memory_order_acquire);
+
+        if (!p_station)
+        {
+            auto p_new = std::make_unique<Station>();
+
+            // Another thread may have created the station meanwhile. Its instance is used instead.
+            if (entry.compare_exchange_strong(p_station, p_new.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+                p_station = p_new.release();
+        }
+
+        return *p_station;
+    }
+}
@@ -0,0 +1,193 @@
+#ifndef IEC104_PROCESSIMAGE_HPP_
+#define IEC104_PROCESSIMAGE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+
+#include "core/pagetable.hpp"
+#include "protocols/iec104/inforecords.hpp"
+#include "protocols/iec104/typedasdu.hpp"
+
+namespace IEC104
+{
+    class Asdu;
+
+    /**
+     * @brief Latest state of all monitored points in the monitoring direction
+     *
+     * Each station (common address) keeps a column per info object type. A column is directly indexed
+     * by the IOA through a two-level page table, so a lookup is a fixed number of loads without hashing.
+     * Each point is a single atomic word, which holds its encoded info element.
+     *
+     * Readers never lock and may run on any thread, concurrently to updates. Updates of different
+     * points never block each other. Memory is only allocated for pages, which contain points.
+     *
+     * Supported types: M_SP_NA_1, M_DP_NA_1, M_ME_NB_1 and M_ME_NC_1
+     */
+    class ProcessImage
+    {
+    public:
+        // Common addresses are encoded with up to 16 bits, IOAs with up to 24 bits
+        static constexpr unsigned COMMON_ADDRESS_BITS = 16;
+        static constexpr unsigned IOA_BITS            = 24;
+
+        ProcessImage() = default;
+        ~ProcessImage() noexcept;
+
+        ProcessImage(const ProcessImage&)            = delete;
+        ProcessImage& operator=(const ProcessImage&) = delete;
+
+        static bool IsSupported(int aTypeId) noexcept;
+
+        // Store the state of a single point. The address of the record is the IOA.
+        template <typename RECORD>
+        void Write(int aCommonAddress, const RECORD& arRecord)
+        {
+            GetStation(aCommonAddress).template Get<RECORD>().Get(arRecord.address).store(Pack(arRecord), std::memory_order_release);
+        }
+
+        // Latest state of a single point. false, if the point was never written.
+        template <typename RECORD>
+        bool Read(int aCommonAddress, uint32_t aAddress, RECORD& arRecord) const noexcept
+        {
+            const Station* p_station = FindStation(aCommonAddress);
+
+            if (!p_station)
+                return false;
+
+            const auto* p_point = p_station->template Get<RECORD>().Find(aAddress);
+            return p_point && Unpack(p_point->load(std::memory_order_acquire), aAddress, arRecord);
+        }
+
+        // Visit all points of a type within a station in ascending order of their IOA as aVisitor(const RECORD&)
+        template <typename RECORD, typename Visitor>
+        void ForEach(int aCommonAddress, Visitor&& aVisitor) const
+        {
+            const Station* p_station = FindStation(aCommonAddress);
+
+            if (!p_station)
+                return;
+
+            p_station->template Get<RECORD>().ForEach([&](size_t aIndex, const Point& arPoint) {
+                RECORD record;
+                if (Unpack(arPoint.load(std::memory_order_acquire), static_cast<uint32_t>(aIndex), record))
+                    aVisitor(record);
+            });
+        }
+
+        /**
+         * @brief Visit the points of a type within a station from IOA aFirst on in ascending order
+         *
+         * aVisitor(const RECORD&) returns false to stop the scan. Used to resume a walk over the points.
+         * @return false, if the visitor stopped the scan
+         */
+        template <typename RECORD, typename Visitor>
+        bool Scan(int aCommonAddress, uint32_t aFirst, Visitor&& aVisitor) const
+        {
+            const Station* p_station = FindStation(aCommonAddress);
+
+            if (!p_station)
+                return true;
+
+            return p_station->template Get<RECORD>().Scan(aFirst, [&](size_t aIndex, const Point& arPoint) {
+                RECORD record;
+                return !Unpack(arPoint.load(std::memory_order_acquire), static_cast<uint32_t>(aIndex), record) || aVisitor(record);
+            });
+        }
+
+        // Known station, which holds at least one point
+        bool HasStation(int aCommonAddress) const noexcept { return FindStation(aCommonAddress) != nullptr; }
+
+        // Visit the common addresses of all known stations in ascending order as aVisitor(int)
+        template <typename Visitor>
+        void ForEachStation(Visitor&& aVisitor) const
+        {
+            mStations.ForEach([&](size_t aIndex, const std::atomic<Station*>& arStation) {
+                if (arStation.load(std::memory_order_acquire))
+                    aVisitor(static_cast<int>(aIndex));
+            });
+        }
+
+        /**
+         * @brief Store all info objects of a decoded ASDU
+         *
+         * @return Number of updated points. 0, if the type is not supported.
+         */
+        size_t Update(const Asdu& arAsdu);
+
+        template <typename RECORD>
+        size_t Update(const TypedAsdu<RECORD>& arAsdu)
+        {
+            auto& column = GetStation(arAsdu.GetHeader().commonAddress).template Get<RECORD>();
+
+            for (const auto& record : arAsdu)
+                column.Get(record.address).store(Pack(record), std::memory_order_release);
+
+            return arAsdu.Size();
+        }
+
+    private:
+        // Encoded info element in the lower bytes. The highest bit marks written points.
+        using Point = std::atomic<uint64_t>;
+        static constexpr uint64_t PRESENT = uint64_t(1) << 63;
+
+        template <typename RECORD>
+        static uint64_t Pack(const RECORD& arRecord) noexcept
+        {
+            static_assert(RECORD::DATA_SIZE < 8, "info element does not fit into a point");
+
+            uint8_t encoded[RECORD::DATA_SIZE];
+            arRecord.Encode(encoded);
+
+            uint64_t result = PRESENT;
+            for (int i = 0; i < RECORD::DATA_SIZE; ++i)
+                result |= static_cast<uint64_t>(encoded[i]) << (8 * i);
+            return result;
+        }
+
+        template <typename RECORD>
+        static bool Unpack(uint64_t aPoint, uint32_t aAddress, RECORD& arRecord) noexcept
+        {
+            if (!(aPoint & PRESENT))
+                return false;
+
+            uint8_t encoded[RECORD::DATA_SIZE];
+            for (int i = 0; i < RECORD::DATA_SIZE; ++i)
+                encoded[i] = static_cast<uint8_t>(aPoint >> (8 * i));
+
+            arRecord.Decode(encoded);
+            arRecord.address = aAddress;
+            return true;
+        }
+
+        // Pages of 4096 points: 32 KiB each
+        using Column = CORE::PageTable<Point, IOA_BITS, 12>;
+
+        template <typename RECORD>
+        struct TypedColumn : Column {};
+
+        struct Station
+        {
+            template <typename RECORD>
+            Column& Get() noexcept { return std::get<TypedColumn<RECORD>>(columns); }
+
+            template <typename RECORD>
+            const Column& Get() const noexcept { return std::get<TypedColumn<RECORD>>(columns); }
+
+            std::tuple<TypedColumn<RecordSinglePoint>,
+                       TypedColumn<RecordDoublePoint>,
+                       TypedColumn<RecordMeasuredScaled>,
+                       TypedColumn<RecordMeasuredFloat>> columns;
+        };
+
+        const Station* FindStation(int aCommonAddress) const noexcept;
+        Station& GetStation(int aCommonAddress);
+
+    private:
+        CORE::PageTable<std::atomic<Station*>, COMMON_ADDRESS_BITS, 8> mStations;
+    };
+}
+
+#endif
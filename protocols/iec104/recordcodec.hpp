@@ -0,0 +1,98 @@
+#ifndef IEC104_RECORDCODEC_HPP_
+#define IEC104_RECORDCODEC_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "protocols/iec104/inforecords.hpp"
+
+namespace IEC104
+{
+    /**
+     * @brief Fused decode and encode loops for the info objects of an ASDU
+     *
+     * One loop is instantiated per record type, IOA size and sequence flag.
+     * The IOA size and the object stride are compile-time constants, so the loop body reduces to
+     * the loads and shifts of a single object. No bound-checks are done: The caller checks the size
+     * of the whole ASDU once, before the loop is entered.
+     *
+     * @tparam RECORD Info object record, see inforecords.hpp
+     * @tparam IOA_SIZE Encoded size of an info object address [1,3]
+     * @tparam SEQUENCE true, if only the 1st object carries an address
+     */
+    template <typename RECORD, int IOA_SIZE, bool SEQUENCE>
+    struct RecordCodec
+    {
+        static_assert(IOA_SIZE >= 1 && IOA_SIZE <= 3, "IOA size not in range [1,3]");
+
+        // Encoded size of aCount objects
+        static constexpr size_t EncodedSize(size_t aCount) noexcept
+        {
+            return SEQUENCE ? IOA_SIZE + aCount * RECORD::DATA_SIZE
+                            : aCount * (IOA_SIZE + RECORD::DATA_SIZE);
+        }
+
+        static void Decode(const uint8_t* apSource, size_t aCount, RECORD* apDest) noexcept
+        {
+            if constexpr (SEQUENCE)
+            {
+                const uint32_t first = ReadRecordAddress(apSource, IOA_SIZE);
+                apSource += IOA_SIZE;
+
+                for (size_t i = 0; i < aCount; ++i, apSource += RECORD::DATA_SIZE)
+                {
+                    apDest[i].address = first + static_cast<uint32_t>(i);
+                    apDest[i].Decode(apSource);
+                }
+            }
+            else
+            {
+                for (size_t i = 0; i < aCount; ++i, apSource += IOA_SIZE + RECORD::DATA_SIZE)
+                {
+                    apDest[i].address = ReadRecordAddress(apSource, IOA_SIZE);
+                    apDest[i].Decode(apSource + IOA_SIZE);
+                }
+            }
+        }
+
+        static void Encode(const RECORD* apSource, size_t aCount, uint8_t* apDest) noexcept
+        {
+            if constexpr (SEQUENCE)
+            {
+                if (aCount == 0)
+                    return;
+
+                WriteRecordAddress(apDest, apSource[0].address, IOA_SIZE);
+                apDest += IOA_SIZE;
+
+                for (size_t i = 0; i < aCount; ++i, apDest += RECORD::DATA_SIZE)
+                    apSource[i].Encode(apDest);
+            }
+            else
+            {
+                for (size_t i = 0; i < aCount; ++i, apDest += IOA_SIZE + RECORD::DATA_SIZE)
+                {
+                    WriteRecordAddress(apDest, apSource[i].address, IOA_SIZE);
+                    apSource[i].Encode(apDest + IOA_SIZE);
+                }
+            }
+        }
+    };
+
+    // Select the specialized loop for a runtime IOA size and sequence flag
+    template <typename RECORD, typename Visitor>
+    decltype(auto) WithRecordCodec(int aIOASize, bool aSequence, Visitor&& aVisitor)
+    {
+        switch (aIOASize * 2 + aSequence)
+        {
+        case 2: return aVisitor(RecordCodec<RECORD, 1, false>());
+        case 3: return aVisitor(RecordCodec<RECORD, 1, true>());
+        case 4: return aVisitor(RecordCodec<RECORD, 2, false>());
+        case 5: return aVisitor(RecordCodec<RECORD, 2, true>());
+        case 7: return aVisitor(RecordCodec<RECORD, 3, true>());
+        default: return aVisitor(RecordCodec<RECORD, 3, false>());
+        }
+    }
+}
+
+#endif
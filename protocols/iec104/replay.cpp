@@ -0,0 +1,119 @@
+#include "protocols/iec104/replay.hpp"
+
+#include <thread>
+#include <vector>
+
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/cobalt/op.hpp>
+
+#include "protocols/iec104/asdu.hpp"
+
+namespace IEC104
+{
+    // Frames, which are gathered into a single write without pacing
+    static constexpr size_t MAX_GATHER = 64;
+
+    CaptureReplay::CaptureReplay(const CaptureReader& arReader, Pacing aPacing)
+        : mReader(arReader), mPacing(aPacing)
+    {
+    }
+
+    bool CaptureReplay::Selected(const CaptureRecord& arRecord) const noexcept
+    {
+        return (!mLink || arRecord.link == *mLink) && (!mDirection || arRecord.direction == *mDirection);
+    }
+
+    ReplayStats CaptureReplay::Decode() const
+    {
+        ReplayStats stats;
+        std::optional<std::chrono::nanoseconds> first;
+        const auto start = std::chrono::steady_clock::now();
+
+        mReader.ForEach([&](const CaptureRecord& arRecord) {
+            if (!Selected(arRecord))
+                return;
+
+            if (mPacing == Pacing::ORIGINAL)
+            {
+                if (!first)
+                    first = arRecord.timestamp;
+                std::this_thread::sleep_until(start + (arRecord.timestamp - *first));
+            }
+
+            ++stats.frames;
+            stats.bytes += arRecord.frame.size();
+
+            ApduView view(arRecord.frame.data());
+            if (view.Length() != arRecord.frame.size() || !view.IsValid())
+            {
+                ++stats.errors;
+                return;
+            }
+
+            if (!view.HasPayload())
+                return;
+
+            try
+            {
+                Asdu asdu;
+                asdu.ReadFrom(view);
+                ++stats.asdus;
+                stats.objects += asdu.GetNumberOfInfoObjects();
+            }
+            catch (...)
+            {
+                ++stats.errors;
+            }
+        });
+
+        return stats;
+    }
+
+    async::promise<ReplayStats> CaptureReplay::Send(asio::ip::tcp::socket& arSocket) const
+    {
+        ReplayStats stats;
+        asio::steady_timer timer(arSocket.get_executor());
+        std::optional<std::chrono::nanoseconds> first;
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<asio::const_buffer> gather;
+        CaptureRecord record;
+        size_t offset = mReader.Begin();
+        bool more = true;
+
+        while (more)
+        {
+            gather.clear();
+
+            while (gather.size() < MAX_GATHER && (more = mReader.Next(offset, record)))
+            {
+                if (!Selected(record))
+                    continue;
+
+                gather.emplace_back(record.frame.data(), record.frame.size());
+                ++stats.frames;
+                stats.bytes += record.frame.size();
+
+                if (mPacing == Pacing::ORIGINAL)
+                    break;
+            }
+
+            if (gather.empty())
+                continue;
+
+            if (mPacing == Pacing::ORIGINAL)
+            {
+                if (!first)
+                    first = record.timestamp;
+
+                timer.expires_at(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(record.timestamp - *first));
+                co_await timer.async_wait(async::use_op);
+            }
+
+            co_await asio::async_write(arSocket, gather, async::use_op);
+        }
+
+        co_return stats;
+    }
+}
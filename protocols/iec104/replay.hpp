@@ -0,0 +1,70 @@
+#ifndef IEC104_REPLAY_HPP_
+#define IEC104_REPLAY_HPP_
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/cobalt/promise.hpp>
+
+#include <cstdint>
+#include <optional>
+
+#include "protocols/iec104/capture.hpp"
+
+namespace asio = boost::asio;
+namespace async = boost::cobalt;
+
+namespace IEC104
+{
+    enum class Pacing
+    {
+        // Keep the recorded gaps between frames
+        ORIGINAL,
+        // Ignore the timestamps
+        FAST
+    };
+
+    struct ReplayStats
+    {
+        uint64_t frames = 0;
+        uint64_t bytes = 0;
+        // Decoded I-Frames and their information objects
+        uint64_t asdus = 0;
+        uint64_t objects = 0;
+        // Frames, which could not be decoded
+        uint64_t errors = 0;
+    };
+
+    /**
+     * @brief Pushes recorded traffic through the decoders or back onto a connection
+     *
+     * Only the frames of the selected link and direction are replayed. By default all of them.
+     */
+    class CaptureReplay
+    {
+    public:
+        explicit CaptureReplay(const CaptureReader& arReader, Pacing aPacing = Pacing::FAST);
+
+        void SelectLink(uint32_t aLink) noexcept { mLink = aLink; }
+        void SelectDirection(CaptureDirection aDirection) noexcept { mDirection = aDirection; }
+
+        // Decode every frame with ApduView and Asdu on the current thread
+        ReplayStats Decode() const;
+
+        /**
+         * @brief Write the frames to a connected socket, e.g. to a link under test on loopback
+         *
+         * Without pacing, consecutive frames are gathered into a single write.
+         */
+        async::promise<ReplayStats> Send(asio::ip::tcp::socket& arSocket) const;
+
+    private:
+        bool Selected(const CaptureRecord& arRecord) const noexcept;
+
+    private:
+        const CaptureReader& mReader;
+        Pacing mPacing;
+        std::optional<uint32_t> mLink;
+        std::optional<CaptureDirection> mDirection;
+    };
+}
+
+#endif
@@ -1,105 +1,312 @@
 #include "protocols/iec104/server.hpp"
 
-#include <list>
+#include <thread>
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/cobalt/join.hpp>
-#include <boost/cobalt/race.hpp>
 #include <boost/cobalt/op.hpp>
+#include <boost/cobalt/this_thread.hpp>
+
 namespace IEC104
 {
-    Server::Server(const asio::ip::address& ip, uint16_t port)
-        : mLocalAddr{ip, port}
-        , mListener(async::this_thread::get_executor())
+    // T1/T2/T3 are configured in seconds. 100ms slots cover all defaults within a single revolution.
+    static constexpr std::chrono::milliseconds TIMER_RESOLUTION(100);
+    static constexpr size_t TIMER_SLOTS = 1024;
+
+    LinkGroup::LinkGroup(std::chrono::milliseconds aNow)
+        : mTimers(TIMER_RESOLUTION, TIMER_SLOTS, aNow)
+        , mBuffers(Link::BUFFER_SIZE)
     {
     }
 
-    Server::~Server()
+    LinkGroup::Handle LinkGroup::Add(asio::ip::tcp::socket&& arSocket, Link::Mode aMode, const ConnectionConfig& arConfig)
     {
+        auto handle = mLinks.Emplace(std::move(arSocket), aMode, mBuffers, arConfig);
+        auto& link = *mLinks.Get(handle);
+        link.AttachTimers(mTimers);
+        link.AttachMetrics(mMetrics);
+
+        // A link is closed only once, by closing its socket
+        link.SignalStateChanged.Register([this, handle](const Link& l) {
+            if (!l.IsConnected())
+                mClosed.push_back(handle);
+        });
+
+        return handle;
     }
 
-    async::promise<void> Server::Tick()
+    void LinkGroup::RemoveDisconnected()
     {
-        try
-        {
-            auto promiseAccept = AcceptOne();
-            auto promiseLinks = TickLinks();
-            co_await async::race(promiseAccept, promiseLinks);
-        }
-        catch (...) {}
-        co_return;
+        for (auto handle : mClosed)
+            mLinks.Erase(handle);
+
+        mClosed.clear();
     }
 
-    async::promise<void> Server::AcceptOne()
+    std::shared_ptr<ExportStatus> LinkGroup::Status() const
     {
-        if (!mListener.is_open()) {
-            mListener.open(mLocalAddr.protocol());
-            mListener.set_option(asio::socket_base::reuse_address(true));
-            mListener.bind(mLocalAddr);
-            mListener.listen();
-        }
+        auto status = std::make_shared<ExportStatus>();
+        status->links.reserve(mLinks.Size());
+        status->totals = mMetrics.Read();
 
-        auto peer = co_await mListener.async_accept(async::use_op);
+        mLinks.ForEach([&status](Handle, const Link& l) {
+            // The peer was taken once, when the link was accepted
+            if (!l.IsConnected() || l.Peer().empty())
+                return;
 
-        auto link = Link(std::move(peer), Link::Mode::Slave);
-        link.SignalApduReceived.Register([this](auto& l, auto& msg) { OnApduReceived(l, msg); });
-        link.SignalApduSent    .Register([this](auto& l, auto& msg) { OnApduSent(l, msg);     });
-        link.SignalTickFinished.Register([this](auto& l)            { OnLinkTickFinished(l);  });
-        link.SignalStateChanged.Register([this](auto& l)            { OnLinkStateChanged(l);  });
-        
-        mLinks.push_back(std::move(link));
-        co_return;
+            status->links.push_back({l.Peer(), l.IsActive(), l.CurrentK(), l.CurrentW(), l.QueuedAsdus(), l.Metrics().Read()});
+        });
+
+        return status;
+    }
+
+    void LinkGroup::Abort() noexcept
+    {
+        mLinks.ForEach([](Handle, Link& l) { l.Abort(); });
+    }
+
+    void LinkGroup::Clear() noexcept
+    {
+        mLinks.Clear();
+        mClosed.clear();
     }
 
-    async::task<void> Server::TickLinks()
+    async::task<void> LinkGroup::Tick()
     {
+        // The clock is read once per tick. Only links with an expired deadline are woken.
+        auto now = VRTU::ClockWrapper::UtcNow();
+        std::vector<Link*> expired;
+        mTimers.Advance(now, [&expired](Link& l) { expired.push_back(&l); });
+
+        if (expired.empty())
+            co_return;
+
         std::vector <async::promise<void>> promises;
 
-        std::for_each(mLinks.begin(), mLinks.end(), [&promises] (Link& l) {
-                promises.push_back(l.Tick());
+        std::for_each(expired.begin(), expired.end(), [&promises, now] (Link* l) {
+                promises.push_back(l->Tick(now));
             });
 
         co_await async::join(promises);
         co_return;
     }
 
-    void Server::OnApduSent(Link& l, const Apdu& msg) const
+    // Thread with its own io_context, which runs and ticks a share of the links
+    class Server::Worker
     {
-        SignalApduSent(l, msg);
+    public:
+        Worker(Server& arServer, size_t aThread)
+            : mServer(arServer)
+            , mThreadIndex(aThread)
+            , mLinks(VRTU::ClockWrapper::UtcNow())
+            , mThread([this] { Run(); })
+        {
+        }
+
+        ~Worker()
+        {
+            // The context runs out of work, once the aborted operations of the links have completed.
+            // Only then the links are destroyed by the worker thread, see Run.
+            asio::post(mContext, [this] {
+                mLinks.Abort();
+                mTickLoop.reset();
+                mWork.reset();
+            });
+
+            mThread.join();
+        }
+
+        Worker(const Worker&)            = delete;
+        Worker& operator=(const Worker&) = delete;
+
+        asio::io_context::executor_type Executor() noexcept { return mContext.get_executor(); }
+        const LinkGroup& Links() const noexcept { return mLinks; }
+
+        // Publish snapshots of the links to a source, which outlives the worker
+        void AttachExporter(MetricsExporter::Source& arSource)
+        {
+            asio::post(mContext, [this, &arSource] { mpStatus = &arSource; });
+        }
+
+        // Take over a socket, which was accepted with the executor of this worker
+        void Adopt(asio::ip::tcp::socket&& arSocket)
+        {
+            asio::post(mContext, [this, socket = std::move(arSocket)]() mutable {
+                auto& link = *mLinks.Find(mLinks.Add(std::move(socket)));
+                mServer.Connect(link, mThreadIndex);
+                link.Run();
+            });
+        }
+
+    private:
+        void Run()
+        {
+            async::this_thread::set_executor(mContext.get_executor());
+            mTickLoop.emplace(TickLoop());
+            mContext.run();
+
+            // No operation of a link is pending any more
+            mLinks.Clear();
+        }
+
+        async::promise<void> TickLoop()
+        {
+            asio::steady_timer timer(mContext);
+
+            try
+            {
+                for (;;)
+                {
+                    timer.expires_after(TIMER_RESOLUTION);
+                    co_await timer.async_wait(async::use_op);
+
+                    mLinks.RemoveDisconnected();
+                    co_await mLinks.Tick();
+
+                    if (mpStatus && mpStatus->Due(VRTU::ClockWrapper::UtcNow()))
+                        mpStatus->Publish(mLinks.Status());
+                }
+            }
+            // Cancelled by the shutdown of the worker. Do not touch any member.
+            catch (...) {}
+        }
+
+    private:
+        Server& mServer;
+        // Index among the threads of the server, which run links
+        size_t mThreadIndex;
+        asio::io_context mContext;
+        asio::executor_work_guard<asio::io_context::executor_type> mWork{mContext.get_executor()};
+        LinkGroup mLinks;
+        MetricsExporter::Source* mpStatus = nullptr;
+        std::optional<async::promise<void>> mTickLoop;
+        // declared last: started after all other members are initialized
+        std::thread mThread;
+    };
+
+    Server::Server(const asio::ip::address& ip, uint16_t port, size_t workers)
+        : SignalLinkStateChanged(workers + 1)
+        , SignalLinkTickFinished(workers + 1)
+        , SignalApduSent(workers + 1)
+        , SignalApduReceived(workers + 1)
+        , mLocalAddr{ip, port}
+        , mListener(async::this_thread::get_executor())
+        , mLinks(VRTU::ClockWrapper::UtcNow())
+    {
+        for (size_t i = 0; i < workers; ++i)
+            mWorkers.push_back(std::make_unique<Worker>(*this, i + 1));
     }
 
-    void Server::OnApduReceived(Link& l, const Apdu& msg) const
+    Server::~Server()
     {
-        SignalApduReceived(l, msg);
     }
 
-    void Server::OnLinkTickFinished(Link& l) const
+    void Server::Start()
     {
-        SignalLinkTickFinished(l);
+        if (!mAcceptLoop)
+            mAcceptLoop.emplace(AcceptLoop());
     }
 
-    void Server::OnLinkStateChanged(Link& l)
+    async::promise<void> Server::Tick()
     {
         try
         {
-            SignalLinkStateChanged(l);
+            mLinks.RemoveDisconnected();
+            co_await mLinks.Tick();
+            Publish();
         }
-        catch (...)
+        catch (...) {}
+        co_return;
+    }
+
+    LinkMetrics::Snapshot Server::LinkTotals() const noexcept
+    {
+        auto totals = mLinks.Metrics().Read();
+
+        for (const auto& p_worker : mWorkers)
+            totals += p_worker->Links().Metrics().Read();
+
+        return totals;
+    }
+
+    void Server::AttachExporter(MetricsExporter& arExporter)
+    {
+        mpStatus = &arExporter.AddSource();
+
+        for (auto& p_worker : mWorkers)
+            p_worker->AttachExporter(arExporter.AddSource());
+    }
+
+    void Server::Publish()
+    {
+        if (!mpStatus || !mpStatus->Due(VRTU::ClockWrapper::UtcNow()))
+            return;
+
+        auto status = mLinks.Status();
+        status->accepted = mMetrics.accepted.Load();
+        status->closed = mMetrics.closed.Load();
+        mpStatus->Publish(std::move(status));
+    }
+
+    async::promise<void> Server::AcceptLoop()
+    {
+        try
         {
-            if (!l.IsConnected())
-                RemoveLink(l);
-            throw;
+            for (;;)
+                co_await AcceptOne();
         }
+        // Either the listener could not be opened, or it was closed. Do not touch any member.
+        catch (...) {}
+    }
 
-        if (!l.IsConnected())
-            RemoveLink(l);
+    async::promise<void> Server::AcceptOne()
+    {
+        if (!mListener.is_open()) {
+            mListener.open(mLocalAddr.protocol());
+            mListener.set_option(asio::socket_base::reuse_address(true));
+            mListener.bind(mLocalAddr);
+            mListener.listen();
+        }
+
+        if (mWorkers.empty())
+        {
+            auto peer = co_await mListener.async_accept(async::use_op);
+            mMetrics.accepted.Add();
+            auto& link = *mLinks.Find(mLinks.Add(std::move(peer)));
+            Connect(link, 0);
+            link.Run();
+            co_return;
+        }
+
+        // The socket is accepted with the executor of the worker, which is going to run its link
+        auto& worker = *mWorkers[mNextWorker];
+        mNextWorker = (mNextWorker + 1) % mWorkers.size();
+
+        auto peer = co_await mListener.async_accept(worker.Executor(), async::use_op);
+        mMetrics.accepted.Add();
+        worker.Adopt(std::move(peer));
+        co_return;
     }
 
-    void Server::RemoveLink(const Link& l)
+    void Server::Connect(Link& arLink, size_t aThread)
     {
-        auto it = std::find_if(mLinks.begin(), mLinks.end(), [&l](auto& stored) {
-            return &stored == &l; 
-        });
+        arLink.AttachProcessImage(mImage);
 
-        if (it != mLinks.end())
-            mLinks.erase(it);
+        arLink.SignalStateChanged.Register([this](auto& l) { OnLinkStateChanged(l); });
+
+        // Subscribers of the server are called by the link itself
+        SignalLinkStateChanged.Attach(arLink.SignalStateChanged, aThread);
+        SignalLinkTickFinished.Attach(arLink.SignalTickFinished, aThread);
+        SignalApduSent        .Attach(arLink.SignalApduSent, aThread);
+        SignalApduReceived    .Attach(arLink.SignalApduReceived, aThread);
+    }
+
+    void Server::OnLinkStateChanged(Link& l)
+    {
+        if (!l.IsConnected())
+            mMetrics.closed.Add();
     }
-}
\ No newline at end of file
+}
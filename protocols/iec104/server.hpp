@@ -7,9 +7,21 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 
+#include "core/bufferpool.hpp"
+#include "core/delegate.hpp"
+#include "core/metrics.hpp"
+#include "core/signal.hpp"
+#include "core/slotmap.hpp"
+#include "core/spscring.hpp"
+#include "protocols/iec104/exporter.hpp"
 #include "protocols/iec104/link.hpp"
+#include "protocols/iec104/linkmetrics.hpp"
+#include "protocols/iec104/processimage.hpp"
 
 namespace asio = boost::asio;
 namespace async = boost::cobalt;
@@ -17,47 +29,204 @@ namespace async = boost::cobalt;
 namespace IEC104
 {
     class Apdu;
+    class ApduView;
+
+    // Links, which are driven by the same executor, together with their shared timer wheel
+    class LinkGroup
+    {
+    public:
+        using Handle = CORE::SlotMap<Link>::Handle;
+
+        explicit LinkGroup(std::chrono::milliseconds aNow);
+
+        LinkGroup(const LinkGroup&)            = delete;
+        LinkGroup& operator=(const LinkGroup&) = delete;
+
+        // Create a link for a connected socket. The link is not running yet.
+        Handle Add(asio::ip::tcp::socket&& arSocket,
+                   Link::Mode aMode = Link::Mode::Slave,
+                   const ConnectionConfig& arConfig = ConnectionConfig());
+        // nullptr, if the link was removed meanwhile
+        Link* Find(Handle aHandle) noexcept { return mLinks.Get(aHandle); }
+        // Closed links are removed here and not within their signal,
+        // because they may still be running a coroutine at that point.
+        // Only the links, which were closed since the last call, are visited.
+        void RemoveDisconnected();
+        // Close all links silently. Their pending operations complete, while the links still exist.
+        void Abort() noexcept;
+        // Destroy all links
+        void Clear() noexcept;
+        // Tick all links with an expired deadline
+        async::task<void> Tick();
+
+        size_t Size() const noexcept { return mLinks.Size(); }
+        // Sum of all links of the group, including the removed ones. May be read from any thread.
+        const LinkMetricsGroup& Metrics() const noexcept { return mMetrics; }
+        // Snapshot of all connected links, which may be published to another thread
+        std::shared_ptr<ExportStatus> Status() const;
+
+    private:
+        // Declared before the links, which unregister themselves on destruction.
+        CORE::TimerWheel<Link> mTimers;
+        // Declared before the links, which leave it on their destruction
+        LinkMetricsGroup mMetrics;
+        // Buffers are lent to the links only while they hold data
+        CORE::BufferPool mBuffers;
+        // Links, which were closed since the last removal. Declared before the links, which append to it.
+        std::vector<Handle> mClosed;
+        // Links must keep their address, because their receive loops refer to them
+        CORE::SlotMap<Link> mLinks;
+    };
+
+    // Connections of a server. Written by the acceptor and all workers, read from any thread.
+    struct ServerMetrics
+    {
+        CORE::Padded<CORE::Counter> accepted;
+        CORE::Padded<CORE::Counter> closed;
+    };
+
+    /**
+     * @brief Signal of every link of a server
+     *
+     * Callees are registered on each link, as soon as it is connected. A call goes straight from the link
+     * to the callee, on the thread which runs the link. Register all callees before Server::Start.
+     *
+     * @tparam Args Arguments of the signal of the link, following Link&
+     */
+    template <typename... Args>
+    class ServerSignal
+    {
+    public:
+        using LinkSignal = CORE::SignalEveryone<void, Link&, Args...>;
+
+        // aThreads: Number of threads, which run links
+        explicit ServerSignal(size_t aThreads) noexcept
+            : mThreads(aThreads) {}
+
+        // Called inline. With workers, callees are called concurrently by all worker threads.
+        template <typename CALLEE>
+        void Register(CALLEE aCallee)
+        {
+            static_assert(std::is_copy_constructible_v<CALLEE>, "callees are copied onto every link");
+
+            mAttach.emplace_back([callee = std::move(aCallee)](LinkSignal& arSignal, size_t) {
+                arSignal.Register(callee);
+            });
+        }
+
+        // Publish into the ring of the thread, which runs the link. See SignalEveryone::RegisterAsync.
+        template <typename MESSAGE, typename CONVERT>
+        void RegisterAsync(CORE::SpscRingSet<MESSAGE>& arRings, CONVERT aConvert)
+        {
+            if (arRings.Size() < mThreads)
+                throw std::invalid_argument("each thread of the server needs a ring");
+
+            mAttach.emplace_back([&arRings, convert = std::move(aConvert)](LinkSignal& arSignal, size_t aThread) {
+                arSignal.RegisterAsync(arRings[aThread], convert);
+            });
+        }
+
+        // Register all callees on the signal of a link, which runs on the thread with the index aThread
+        void Attach(LinkSignal& arSignal, size_t aThread) const
+        {
+            for (const auto& Attach : mAttach)
+                Attach(arSignal, aThread);
+        }
+
+    private:
+        size_t mThreads;
+        // Holds a callee, which fits into the delegate of a link, together with the ring set
+        std::vector<CORE::Delegate<void(LinkSignal&, size_t), 8 * sizeof(void*)>> mAttach;
+    };
 
     class Server
     {
     public:
-        // Forwarded from child links
-        CORE::SignalEveryone<void, Link&> SignalLinkStateChanged;
-        // Forwarded from child links
-        CORE::SignalEveryone<void, Link&> SignalLinkTickFinished;
-        // Forwarded from child links
-        CORE::SignalEveryone<void, Link&, const Apdu&> SignalApduSent;
-        // Forwarded from child links
-        CORE::SignalEveryone<void, Link&, const Apdu&> SignalApduReceived;
-
-        explicit Server(const asio::ip::address& ip, uint16_t port = 2404);
+        // Invoked by every link
+        ServerSignal<> SignalLinkStateChanged;
+        // Invoked by every link
+        ServerSignal<> SignalLinkTickFinished;
+        // Invoked by every link
+        ServerSignal<const Apdu&> SignalApduSent;
+        // Invoked by every link
+        ServerSignal<const ApduView&> SignalApduReceived;
+
+        /**
+         * @param ip Local address to listen on
+         * @param port Local port to listen on
+         * @param workers Number of worker threads. With 0 workers, all links run on the executor of the current thread.
+         *                Otherwise accepted links are distributed round-robin across the workers,
+         *                which tick their links themselves.
+         *
+         * @note The signals are invoked by the thread, which runs the link, without any lock.
+         *       With workers, subscribers are therefore called concurrently. Subscribers, which are slow
+         *       or not thread-safe, register with RegisterAsync and get a ring per thread (see Threads).
+         *       Register all subscribers before Start. As no lock is held, subscribers may call back
+         *       into the link, e.g. close it, see CORE::SignalEveryone.
+         */
+        explicit Server(const asio::ip::address& ip, uint16_t port = 2404, size_t workers = 0);
         ~Server();
 
         Server(const Server&)            = delete;
         Server& operator=(const Server&) = delete;
 
-        Server(Server&&)                 = default;
-        Server& operator=(Server&&)      = default;
+        // Links and workers refer to the server
+        Server(Server&&)                 = delete;
+        Server& operator=(Server&&)      = delete;
+
+        // Start accepting connections. Accepted links process their APDUs as soon as they arrive.
+        void Start();
 
+        // Single tick of timer supervision for all links. Without effect, if the links run on workers.
         async::promise<void> Tick();
 
+        size_t Workers() const noexcept { return mWorkers.size(); }
+        // Threads, which run links: the current thread with index 0 and each worker
+        size_t Threads() const noexcept { return mWorkers.size() + 1; }
+
+        // May be read from any thread
+        const ServerMetrics& Metrics() const noexcept { return mMetrics; }
+        // Sum of the metrics of all links, which were ever accepted. May be read from any thread.
+        LinkMetrics::Snapshot LinkTotals() const noexcept;
+        // Publish snapshots of all links to an exporter, which outlives the server. Workers publish with their
+        // own ticks, the connection counters and the links of the current thread are published with Tick.
+        void AttachExporter(MetricsExporter& arExporter);
+
+        // Latest state of all points, which answers the station interrogations of all links.
+        // May be updated from any thread.
+        ProcessImage& Image() noexcept { return mImage; }
+        const ProcessImage& Image() const noexcept { return mImage; }
+
         asio::ip::address LocalIp() const noexcept { return mLocalAddr.address(); }
         int LocalPort() const noexcept { return mLocalAddr.port(); }
 
     private:
+        class Worker;
+
+        async::promise<void> AcceptLoop();
         async::promise<void> AcceptOne();
-        async::task<void> TickLinks();
-        void RemoveLink(const Link& l);
+        // Attach a new link, which runs on the thread with the index aThread
+        void Connect(Link& arLink, size_t aThread);
+        void Publish();
 
-        void OnApduSent(Link& l, const Apdu& msg) const;
-        void OnApduReceived(Link& l, const Apdu& msg) const;
-        void OnLinkTickFinished(Link& l) const;
         void OnLinkStateChanged(Link& l);
 
     private:
-        asio::ip::tcp::acceptor mListener;
         asio::ip::tcp::endpoint mLocalAddr;
-        std::vector<Link> mLinks;
+        asio::ip::tcp::acceptor mListener;
+        // Declared before the links, which refer to it
+        ProcessImage mImage;
+        // Links of the current thread, if there are no workers
+        LinkGroup mLinks;
+
+        ServerMetrics mMetrics;
+        MetricsExporter::Source* mpStatus = nullptr;
+
+        std::vector<std::unique_ptr<Worker>> mWorkers;
+        size_t mNextWorker = 0;
+
+        // declared last: destroyed first, while the listener is still valid
+        std::optional<async::promise<void>> mAcceptLoop;
     };
 }
 #endif
@@ -0,0 +1,145 @@
+#ifndef IEC104_TYPEDASDU_HPP_
+#define IEC104_TYPEDASDU_HPP_
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+#include "core/bytestream.hpp"
+#include "protocols/iec104/apdu.hpp"
+#include "protocols/iec104/asdu.hpp"
+#include "protocols/iec104/inforecords.hpp"
+#include "protocols/iec104/recordcodec.hpp"
+
+namespace IEC104
+{
+    /**
+     * @brief ASDU with a single, known info object type and inline storage
+     *
+     * All records are stored in a fixed array inside the object. Decoding does neither allocate nor dispatch
+     * virtually, and the size of the whole ASDU is checked once, before any record is decoded.
+     * Reuse a single instance to decode many ASDUs of the same type.
+     *
+     * @tparam RECORD Info object record, see inforecords.hpp
+     */
+    template <typename RECORD>
+    class TypedAsdu
+    {
+    public:
+        static constexpr int TYPE_ID = RECORD::TYPE_ID;
+        // The number of objects is encoded with 7 bits
+        static constexpr size_t MAX_OBJECTS = 127;
+
+        explicit TypedAsdu(const AsduConfig& arConfig = AsduConfig::Defaults)
+            : mConfig(arConfig)
+        {
+            mHeader.type = TYPE_ID;
+        }
+
+        void ReadFrom(ByteStream& arBuffer)
+        {
+            auto size = arBuffer.RemainingBytes();
+            ReadFrom(arBuffer.ReadData(size), size);
+        }
+
+        // Decode the payload of a received I-frame in place
+        void ReadFrom(const ApduView& arApdu)
+        {
+            if (!arApdu.HasPayload())
+                throw std::invalid_argument("apdu does not contain an asdu");
+
+            ReadFrom(arApdu.PayloadBegin(), arApdu.PayloadLength());
+        }
+
+        // Decode a complete ASDU from memory
+        void ReadFrom(const uint8_t* apData, size_t aSize)
+        {
+            if (aSize < AsduHeader::GetSize(mConfig))
+                throw std::runtime_error("data size does not match the expected asdu size");
+
+            AsduHeader header;
+            header.Decode(apData, mConfig);
+
+            if (header.type != TYPE_ID)
+                throw std::invalid_argument("asdu type does not match the record type");
+
+            if (header.GetExpectedSize(mConfig, RECORD::DATA_SIZE) != aSize)
+                throw std::runtime_error("data size does not match the expected asdu size");
+
+            mHeader = header;
+            Decode(apData + AsduHeader::GetSize(mConfig));
+        }
+
+        // Throws std::out_of_range, if the records do not fit into a single APDU, e.g. after a change to SQ=0
+        void WriteTo(ByteStream& arBuffer) const
+        {
+            if (Size() > MaxObjects())
+                throw std::out_of_range("asdu does not fit into an apdu");
+
+            mHeader.WriteTo(arBuffer, mConfig);
+
+            WithRecordCodec<RECORD>(mConfig.GetIOASize(), mHeader.isSequence, [&](auto codec) {
+                if (Empty())
+                    return;
+
+                const auto encoded = codec.EncodedSize(Size());
+
+                arBuffer.PrepareWrite(encoded);
+                codec.Encode(mRecords.data(), Size(), arBuffer.WriteBegin());
+                arBuffer.BytesWritten(encoded);
+            });
+        }
+
+        const AsduHeader& GetHeader() const noexcept { return mHeader; }
+        AsduHeader& GetHeader() noexcept { return mHeader; }
+
+        bool IsSequence() const noexcept { return mHeader.isSequence; }
+        // Encode subsequent addresses implicitly. The records must have contiguous addresses.
+        void SetSequence(bool aValue) noexcept { mHeader.isSequence = aValue; }
+
+        size_t Size() const noexcept { return mHeader.size; }
+        bool Empty() const noexcept { return mHeader.size == 0; }
+        // Objects, which fit into a single APDU with the configured IOA size and the current SQ mode
+        size_t MaxObjects() const noexcept
+        {
+            const size_t space = Apdu::MAX_ASDU_SIZE - AsduHeader::GetSize(mConfig);
+            const size_t ioa_size = mConfig.GetIOASize();
+            const size_t fit = IsSequence() ? (space - ioa_size) / RECORD::DATA_SIZE
+                                            : space / (ioa_size + RECORD::DATA_SIZE);
+            return std::min(MAX_OBJECTS, fit);
+        }
+        bool HasMoreSpace() const noexcept { return Size() < MaxObjects(); }
+
+        void Clear() noexcept { mHeader.size = 0; }
+
+        void Append(const RECORD& arRecord)
+        {
+            if (!HasMoreSpace())
+                throw std::out_of_range("asdu cannot hold more info objects");
+
+            mRecords[mHeader.size++] = arRecord;
+        }
+
+        const RECORD& operator[](size_t aIndex) const noexcept { return mRecords[aIndex]; }
+        RECORD& operator[](size_t aIndex) noexcept { return mRecords[aIndex]; }
+
+        const RECORD* begin() const noexcept { return mRecords.data(); }
+        const RECORD* end() const noexcept { return mRecords.data() + Size(); }
+
+    private:
+        // Decode all records. The size of apData was checked against the header before.
+        void Decode(const uint8_t* apData) noexcept
+        {
+            WithRecordCodec<RECORD>(mConfig.GetIOASize(), mHeader.isSequence, [&](auto codec) {
+                codec.Decode(apData, Size(), mRecords.data());
+            });
+        }
+
+    private:
+        AsduConfig mConfig;
+        AsduHeader mHeader;
+        std::array<RECORD, MAX_OBJECTS> mRecords;
+    };
+}
+
+#endif
@@ -0,0 +1,67 @@
+#include <boost/test/unit_test.hpp>
+
+#include "core/bytestream.hpp"
+#include "protocols/iec104/apdu.hpp"
+
+using namespace IEC104;
+
+BOOST_AUTO_TEST_CASE(apdu_view_refers_to_stream)
+{
+	// I-frame with send seq 1, recv seq 2 and a 3 byte payload, followed by a partial S-frame
+	ByteStream data{ 0x68, 0x07, 0x02, 0x00, 0x04, 0x00, 0xAA, 0xBB, 0xCC, 0x68, 0x04 };
+
+	BOOST_REQUIRE(Apdu::IsFullyAvailable(data));
+	ApduView view(data);
+	BOOST_REQUIRE_EQUAL(data.RemainingBytes(), 2);
+	BOOST_REQUIRE(!Apdu::IsFullyAvailable(data));
+
+	BOOST_REQUIRE_EQUAL(view.Data(), data.MemoryBegin());
+	BOOST_REQUIRE_EQUAL(view.Length(), 9);
+	BOOST_REQUIRE_EQUAL(view.PayloadLength(), 3);
+	BOOST_REQUIRE_EQUAL(*view.PayloadBegin(), 0xAA);
+	BOOST_REQUIRE(view.HasPayload());
+	BOOST_REQUIRE_EQUAL(view.SendSequence().value().Value(), 1);
+	BOOST_REQUIRE_EQUAL(view.ReceiveSequence().value().Value(), 2);
+
+	Apdu copy(view);
+	BOOST_REQUIRE_NE(copy.View().Data(), view.Data());
+	BOOST_REQUIRE_EQUAL(copy.Length(), 9);
+
+	std::vector<uint8_t> encoded;
+	copy.WriteTo(encoded);
+	BOOST_REQUIRE(std::equal(encoded.begin(), encoded.end(), view.Data()));
+}
+
+BOOST_AUTO_TEST_CASE(apdu_view_rejects_invalid_frames)
+{
+	// U-frame must not have a payload
+	ByteStream tooLong{ 0x68, 0x05, 0x07, 0x00, 0x00, 0x00, 0x00 };
+	BOOST_REQUIRE_THROW(ApduView{tooLong}, std::invalid_argument);
+
+	ByteStream badLength{ 0x68, 0x02, 0x07, 0x00, 0x00, 0x00 };
+	BOOST_REQUIRE_THROW(ApduView{badLength}, std::runtime_error);
+
+	BOOST_REQUIRE(Apdu::STARTDT_ACT.View().IsValid());
+	BOOST_REQUIRE(Apdu::STARTDT_ACT.View().ServiceActivation() == ServiceType::START);
+	BOOST_REQUIRE(Apdu::TESTFR_CON.View().ServiceConfirmation() == ServiceType::TEST);
+}
+
+BOOST_AUTO_TEST_CASE(apdu_iframe_from_asdu)
+{
+	const uint8_t asdu[] = { 0x0D, 0x01, 0x03, 0x00 };
+	Apdu apdu(asdu, sizeof(asdu));
+
+	BOOST_REQUIRE(apdu.IsValid());
+	BOOST_REQUIRE_EQUAL(apdu.Length(), 10);
+	BOOST_REQUIRE(std::equal(asdu, asdu + sizeof(asdu), apdu.View().PayloadBegin()));
+
+	apdu.SetSequences(Sequence(5), Sequence(7));
+	BOOST_REQUIRE_EQUAL(apdu.SendSequence().value().Value(), 5);
+	BOOST_REQUIRE_EQUAL(apdu.ReceiveSequence().value().Value(), 7);
+
+	BOOST_REQUIRE_THROW(Apdu(asdu, 0), std::invalid_argument);
+	BOOST_REQUIRE_THROW(Apdu(asdu, Apdu::MAX_ASDU_SIZE + 1), std::invalid_argument);
+
+	Apdu ack(Sequence(1));
+	BOOST_REQUIRE_THROW(ack.SetSequences(Sequence(0), Sequence(0)), std::logic_error);
+}
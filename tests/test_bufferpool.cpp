@@ -0,0 +1,41 @@
+#include <boost/test/unit_test.hpp>
+
+#include "core/bufferpool.hpp"
+
+BOOST_AUTO_TEST_CASE(bufferpool_reuses_returned_buffers)
+{
+	CORE::BufferPool pool(64, 1);
+
+	const ByteStream* first = nullptr;
+	{
+		auto lease = pool.Borrow();
+		BOOST_REQUIRE(lease);
+		BOOST_REQUIRE_EQUAL(lease->Capacity(), 64);
+		BOOST_REQUIRE_EQUAL(pool.Lent(), 1);
+
+		lease->WriteByte(0x01);
+		first = &*lease;
+	}
+
+	BOOST_REQUIRE_EQUAL(pool.Lent(), 0);
+	BOOST_REQUIRE_EQUAL(pool.Idle(), 1);
+
+	// A returned buffer is reused empty
+	auto again = pool.Borrow();
+	BOOST_REQUIRE_EQUAL(&*again, first);
+	BOOST_REQUIRE_EQUAL(again->RemainingBytes(), 0);
+
+	// Only one idle buffer is kept
+	auto second = pool.Borrow();
+	again.Release();
+	second.Release();
+	BOOST_REQUIRE(!again);
+	BOOST_REQUIRE_EQUAL(pool.Idle(), 1);
+	BOOST_REQUIRE_EQUAL(pool.Lent(), 0);
+
+	// Moving a lease does not return the buffer
+	auto moved = pool.Borrow();
+	auto target = std::move(moved);
+	BOOST_REQUIRE(!moved);
+	BOOST_REQUIRE_EQUAL(pool.Lent(), 1);
+}
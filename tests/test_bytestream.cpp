@@ -95,3 +95,50 @@ BOOST_AUTO_TEST_CASE(peek_bytestream)
 	BOOST_REQUIRE_THROW(data1.PeekAt(2), std::out_of_range);
 	BOOST_REQUIRE_THROW(data1.PeekAt(-1), std::out_of_range);
 }
+
+BOOST_AUTO_TEST_CASE(reclaim_bytestream)
+{
+	ByteStream data(16);
+	uint8_t arr[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A };
+
+	// Consumed data is released without moving anything
+	data.WriteData(arr, 4);
+	data.ReadData(4);
+	data.Reclaim(8);
+	BOOST_REQUIRE_EQUAL(data.DataBegin(), data.MemoryBegin());
+	BOOST_REQUIRE_EQUAL(data.WritableBytes(), 16);
+
+	// Enough space behind the remaining data: it stays in place
+	data.WriteData(arr, 6);
+	data.ReadData(4);
+	data.Reclaim(8);
+	BOOST_REQUIRE_EQUAL(data.DataBegin(), data.MemoryBegin() + 4);
+
+	// Not enough space left: the remaining data is moved to the start
+	data.WriteData(arr, 4);
+	data.Reclaim(8);
+	BOOST_REQUIRE_EQUAL(data.DataBegin(), data.MemoryBegin());
+	BOOST_REQUIRE_EQUAL(data.RemainingBytes(), 6);
+	BOOST_REQUIRE_EQUAL(data.PeekAt(0), 0x05);
+	BOOST_REQUIRE_EQUAL(data.PeekAt(2), 0x01);
+}
+
+BOOST_AUTO_TEST_CASE(read_cursor_bytestream)
+{
+	ByteStream data({ 0x34, 0x12, 0x00, 0x00, 0x80, 0x3F, 0xFF, 0x07 });
+
+	// The range is checked once, as a whole
+	BOOST_REQUIRE_THROW(data.ReadCursor(9), std::out_of_range);
+	BOOST_REQUIRE_EQUAL(data.RemainingBytes(), 8);
+
+	auto cursor = data.ReadCursor(7);
+	BOOST_REQUIRE_EQUAL(data.RemainingBytes(), 1);
+	BOOST_REQUIRE_EQUAL(cursor.RemainingBytes(), 7);
+
+	BOOST_REQUIRE_EQUAL(cursor.ReadLE<int16_t>(), 0x1234);
+	BOOST_REQUIRE_EQUAL(cursor.ReadLE<float>(), 1.0f);
+	BOOST_REQUIRE_EQUAL(cursor.ReadByte(), 0xFF);
+	BOOST_REQUIRE_EQUAL(cursor.RemainingBytes(), 0);
+
+	BOOST_REQUIRE_EQUAL(CORE::LoadLE<int16_t>(data.ReadData(1) - 1), static_cast<int16_t>(0x07FF));
+}
@@ -0,0 +1,114 @@
+#include <boost/test/unit_test.hpp>
+
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "core/bytestream.hpp"
+#include "protocols/iec104/capture.hpp"
+#include "protocols/iec104/replay.hpp"
+#include "protocols/iec104/typedasdu.hpp"
+
+using namespace IEC104;
+
+namespace
+{
+	// Capture file, which is removed after the test. The name is unique, so that test runs in parallel do not collide.
+	struct TempCapture
+	{
+		TempCapture() : path(UniquePath()) {}
+		~TempCapture() { std::filesystem::remove(path); }
+
+		std::string path;
+
+	private:
+		static std::string UniquePath()
+		{
+			const std::string test = boost::unit_test::framework::current_test_case().p_name;
+			const auto suffix = std::to_string(std::random_device{}());
+			return (std::filesystem::temp_directory_path() / ("vrtu_" + test + "_" + suffix + ".bin")).string();
+		}
+	};
+
+	Apdu MeasuredFloats(int aCount)
+	{
+		TypedAsdu<RecordMeasuredFloat> asdu(AsduConfig::Defaults);
+		asdu.GetHeader().reason = ReasonCode::SPONTANEOUS;
+		asdu.GetHeader().commonAddress = 1;
+		for (int i = 0; i < aCount; ++i)
+			asdu.Append(RecordMeasuredFloat{static_cast<uint32_t>(i), 1.0f, Quality()});
+
+		ByteStream encoded;
+		asdu.WriteTo(encoded);
+		return Apdu(encoded.DataBegin(), encoded.RemainingBytes());
+	}
+}
+
+BOOST_AUTO_TEST_CASE(capture_round_trip)
+{
+	TempCapture file;
+	const auto frame = MeasuredFloats(3);
+	const std::span<const uint8_t> data(frame.View().Data(), frame.Length());
+
+	{
+		// The smallest chunk forces the file to be remapped many times
+		CaptureWriter writer(file.path, 1);
+
+		for (uint32_t i = 0; i < 1000; ++i)
+		{
+			writer.Append(i % 4, CaptureDirection::SENT, data, std::chrono::nanoseconds(i * 1000));
+			writer.Append(i % 4, CaptureDirection::RECEIVED, {Apdu::TESTFR_CON.View().Data(), 6}, std::chrono::nanoseconds(i * 1000 + 1));
+		}
+
+		BOOST_REQUIRE_EQUAL(writer.Records(), 2000);
+		BOOST_REQUIRE_THROW(writer.Append(0, CaptureDirection::SENT, {}), std::invalid_argument);
+	}
+
+	// Closing truncates the file to its records
+	BOOST_REQUIRE_EQUAL(std::filesystem::file_size(file.path), CaptureFormat::FILE_HEADER_SIZE + 1000 * (2 * CaptureFormat::RECORD_HEADER_SIZE + data.size() + 6));
+
+	CaptureReader reader(file.path);
+	uint32_t index = 0;
+
+	auto count = reader.ForEach([&](const CaptureRecord& arRecord) {
+		BOOST_REQUIRE_EQUAL(arRecord.link, (index / 2) % 4);
+		BOOST_REQUIRE_EQUAL(arRecord.timestamp.count(), (index / 2) * 1000 + index % 2);
+		BOOST_REQUIRE(arRecord.direction == (index % 2 ? CaptureDirection::RECEIVED : CaptureDirection::SENT));
+		BOOST_REQUIRE_EQUAL(arRecord.frame.size(), index % 2 ? 6 : data.size());
+		++index;
+	});
+	BOOST_REQUIRE_EQUAL(count, 2000);
+
+	CaptureReplay replay(reader);
+	auto stats = replay.Decode();
+	BOOST_REQUIRE_EQUAL(stats.frames, 2000);
+	BOOST_REQUIRE_EQUAL(stats.asdus, 1000);
+	BOOST_REQUIRE_EQUAL(stats.objects, 3000);
+	BOOST_REQUIRE_EQUAL(stats.errors, 0);
+
+	replay.SelectLink(1);
+	replay.SelectDirection(CaptureDirection::SENT);
+	stats = replay.Decode();
+	BOOST_REQUIRE_EQUAL(stats.frames, 250);
+	BOOST_REQUIRE_EQUAL(stats.asdus, 250);
+}
+
+BOOST_AUTO_TEST_CASE(capture_survives_missing_close)
+{
+	TempCapture file;
+
+	CaptureWriter writer(file.path);
+	writer.Append(7, CaptureDirection::RECEIVED, {Apdu::STARTDT_ACT.View().Data(), 6});
+	writer.Flush();
+
+	// The unused tail of the chunk ends the records
+	CaptureReader reader(file.path);
+	BOOST_REQUIRE_GT(reader.Size(), writer.Size());
+	BOOST_REQUIRE_EQUAL(reader.ForEach([](const CaptureRecord& arRecord) {
+		BOOST_REQUIRE_EQUAL(arRecord.link, 7);
+	}), 1);
+
+	writer.Close();
+	BOOST_REQUIRE_THROW(writer.Append(7, CaptureDirection::RECEIVED, {Apdu::STARTDT_ACT.View().Data(), 6}), std::logic_error);
+}
@@ -0,0 +1,73 @@
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+
+#include "protocols/iec104/client.hpp"
+#include "protocols/iec104/infoobjects.hpp"
+
+using namespace IEC104;
+using namespace std::chrono_literals;
+
+BOOST_AUTO_TEST_CASE(backoff_doubles_up_to_maximum)
+{
+	Backoff backoff(100ms, 1000ms);
+	std::minstd_rand random(1);
+
+	const std::chrono::milliseconds limits[] = { 100ms, 200ms, 400ms, 800ms, 1000ms, 1000ms };
+
+	for (auto limit : limits)
+	{
+		BOOST_REQUIRE_EQUAL(backoff.Limit().count(), limit.count());
+
+		// Jitter stays within the upper half of the range
+		auto delay = backoff.Next(random);
+		BOOST_REQUIRE_GE(delay.count(), limit.count() / 2);
+		BOOST_REQUIRE_LE(delay.count(), limit.count());
+	}
+
+	BOOST_REQUIRE_EQUAL(backoff.Attempts(), 6);
+
+	backoff.Reset();
+	BOOST_REQUIRE_EQUAL(backoff.Limit().count(), 100);
+
+	BOOST_REQUIRE_THROW(Backoff(0ms, 1000ms), std::invalid_argument);
+	BOOST_REQUIRE_THROW(Backoff(100ms, 10ms), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(backoff_spreads_delays)
+{
+	Backoff first(1000ms, 1000ms);
+	Backoff second(1000ms, 1000ms);
+	std::minstd_rand random(7);
+
+	// Outstations, which fail together, must not retry in lockstep
+	bool differs = false;
+	for (int i = 0; i < 10; ++i)
+		differs |= first.Next(random) != second.Next(random);
+
+	BOOST_REQUIRE(differs);
+}
+
+BOOST_AUTO_TEST_CASE(client_outstations)
+{
+	Client client;
+	// Later tests still register their own info objects
+	BOOST_REQUIRE(!InfoObjectFactory::IsFrozen());
+
+	auto addr = asio::ip::address::from_string("127.0.0.1");
+
+	auto id = client.AddOutstation({ {addr, 2404}, {addr, 2405} });
+	BOOST_REQUIRE_EQUAL(client.Outstations(), 1);
+	BOOST_REQUIRE_EQUAL(client.ActiveEndpoint(id).port(), 2404);
+	BOOST_REQUIRE(client.Find(id) == nullptr);
+
+	// Without a connection, switching over only selects the next endpoint
+	client.Switchover(id);
+	BOOST_REQUIRE_EQUAL(client.ActiveEndpoint(id).port(), 2404);
+	client.Start();
+	client.Switchover(id);
+	BOOST_REQUIRE_EQUAL(client.ActiveEndpoint(id).port(), 2405);
+
+	BOOST_REQUIRE_THROW(client.AddOutstation({}), std::invalid_argument);
+	BOOST_REQUIRE_THROW(client.Find(1), std::out_of_range);
+}
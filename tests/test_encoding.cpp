@@ -1,6 +1,12 @@
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <vector>
+
+#include "core/bytestream.hpp"
+#include "protocols/iec104/asdu.hpp"
 #include "protocols/iec104/infoobjects.hpp"
+#include "protocols/iec104/typedasdu.hpp"
 
 BOOST_AUTO_TEST_CASE(single_point_type_and_len)
 {
@@ -9,3 +15,139 @@ BOOST_AUTO_TEST_CASE(single_point_type_and_len)
 	BOOST_REQUIRE_EQUAL(elem.DATA_SIZE, 1);
 }
 
+
+BOOST_AUTO_TEST_CASE(measured_float_reads_quality)
+{
+	// IOA 0x000102, value 1.0f, quality invalid
+	ByteStream data{ 0x02, 0x01, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x80 };
+
+	IEC104::DataMeasuredFloat elem;
+	elem.ReadFrom(data, 3);
+	BOOST_REQUIRE_EQUAL(data.RemainingBytes(), 0);
+	BOOST_REQUIRE_EQUAL(elem.GetAddress().GetInt(), 0x0102);
+	BOOST_REQUIRE_EQUAL(elem.val, 1.0f);
+	BOOST_REQUIRE(elem.q.IsInvalid());
+}
+
+BOOST_AUTO_TEST_CASE(typed_asdu_decodes_sequence)
+{
+	// M_ME_NC_1, SQ=1, 2 objects, COT 3, CA 7, 1st IOA 100
+	ByteStream data{ 0x0D, 0x82, 0x03, 0x00, 0x07, 0x00,
+	                 0x64, 0x00, 0x00,
+	                 0x00, 0x00, 0x80, 0x3F, 0x00,
+	                 0x00, 0x00, 0x00, 0x40, 0x10 };
+	std::vector<uint8_t> encoded(data.DataBegin(), data.DataEnd());
+
+	IEC104::TypedAsdu<IEC104::RecordMeasuredFloat> asdu;
+	asdu.ReadFrom(data);
+
+	BOOST_REQUIRE_EQUAL(asdu.Size(), 2);
+	BOOST_REQUIRE(asdu.IsSequence());
+	BOOST_REQUIRE_EQUAL(asdu.GetHeader().commonAddress, 7);
+	BOOST_REQUIRE_EQUAL(asdu[0].address, 100);
+	BOOST_REQUIRE_EQUAL(asdu[1].address, 101);
+	BOOST_REQUIRE_EQUAL(asdu[0].val, 1.0f);
+	BOOST_REQUIRE_EQUAL(asdu[1].val, 2.0f);
+	BOOST_REQUIRE(asdu[1].q.IsBlocked());
+
+	ByteStream out;
+	asdu.WriteTo(out);
+	BOOST_REQUIRE(std::equal(encoded.begin(), encoded.end(), out.DataBegin(), out.DataEnd()));
+
+	// Implicit addresses of the generic ASDU match the typed one
+	IEC104::Asdu generic;
+	ByteStream again(encoded.data(), encoded.data() + encoded.size());
+	generic.ReadFrom(again);
+	BOOST_REQUIRE_EQUAL(generic.GetNumberOfInfoObjects(), 2);
+
+	size_t index = 0;
+	for (const auto& p_object : generic)
+		BOOST_REQUIRE_EQUAL(p_object->GetAddress().GetInt(), asdu[index++].address);
+}
+
+BOOST_AUTO_TEST_CASE(typed_asdu_rejects_mismatch)
+{
+	IEC104::TypedAsdu<IEC104::RecordSinglePoint> asdu;
+
+	// wrong type
+	ByteStream wrongType{ 0x03, 0x01, 0x03, 0x00, 0x07, 0x00, 0x01, 0x00, 0x00, 0x01 };
+	BOOST_REQUIRE_THROW(asdu.ReadFrom(wrongType), std::invalid_argument);
+
+	// one byte missing
+	ByteStream truncated{ 0x01, 0x02, 0x03, 0x00, 0x07, 0x00, 0x01, 0x00, 0x00, 0x01, 0x02, 0x00, 0x00 };
+	BOOST_REQUIRE_THROW(asdu.ReadFrom(truncated), std::runtime_error);
+}
+
+namespace
+{
+	class DataCustom : public IEC104::BaseInfoObject
+	{
+	public:
+		explicit DataCustom(int aSize) : BaseInfoObject(250), size(aSize) {}
+		int size;
+	};
+}
+
+BOOST_AUTO_TEST_CASE(factory_external_overrides_internal)
+{
+	using IEC104::InfoObjectFactory;
+	const auto internal = static_cast<int>(IEC104::RegisteredBy::INTERNAL);
+	const auto external = static_cast<int>(IEC104::RegisteredBy::EXTERNAL);
+
+	BOOST_REQUIRE(!InfoObjectFactory::HasType(250));
+
+	InfoObjectFactory::RegisterInfoObject(250, internal, 1, []() -> IEC104::SharedInfoObject { return std::make_shared<DataCustom>(1); });
+	InfoObjectFactory::RegisterInfoObject(250, external, 2, []() -> IEC104::SharedInfoObject { return std::make_shared<DataCustom>(2); });
+	InfoObjectFactory::RegisterInfoObject(250, internal, 3, []() -> IEC104::SharedInfoObject { return std::make_shared<DataCustom>(3); });
+
+	BOOST_REQUIRE(InfoObjectFactory::HasType(250));
+	BOOST_REQUIRE_EQUAL(InfoObjectFactory::GetSize(250), 2);
+	BOOST_REQUIRE_EQUAL(static_cast<DataCustom&>(*InfoObjectFactory::Create(250)).size, 2);
+
+	BOOST_REQUIRE_EQUAL(InfoObjectFactory::GetSize(IEC104::DataMeasuredFloat::TYPE_ID), IEC104::DataMeasuredFloat::DATA_SIZE);
+	BOOST_REQUIRE_THROW(InfoObjectFactory::Create(251), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(typed_asdu_roundtrip_all_ioa_sizes)
+{
+	for (int ioa_size = 1; ioa_size <= 3; ++ioa_size)
+	{
+		for (bool sequence : { false, true })
+		{
+			IEC104::AsduConfig config(2, 2, ioa_size);
+			IEC104::TypedAsdu<IEC104::RecordMeasuredScaled> asdu(config);
+			asdu.SetSequence(sequence);
+
+			// As many objects as fit into a single APDU
+			const size_t header = IEC104::AsduHeader::GetSize(config);
+			const size_t expected = sequence ? (IEC104::Apdu::MAX_ASDU_SIZE - header - ioa_size) / 3
+			                                 : (IEC104::Apdu::MAX_ASDU_SIZE - header) / (ioa_size + 3);
+			BOOST_REQUIRE_EQUAL(asdu.MaxObjects(), expected);
+
+			for (int i = 0; asdu.HasMoreSpace(); ++i)
+				asdu.Append(IEC104::RecordMeasuredScaled{ static_cast<uint32_t>(10 + i), static_cast<int16_t>(-i), IEC104::Quality(i & 0xF1) });
+
+			BOOST_REQUIRE_EQUAL(asdu.Size(), expected);
+			BOOST_REQUIRE_THROW(asdu.Append(asdu[0]), std::out_of_range);
+
+			ByteStream encoded;
+			asdu.WriteTo(encoded);
+			BOOST_REQUIRE_EQUAL(encoded.RemainingBytes(), asdu.GetHeader().GetExpectedSize(config, 3));
+			BOOST_REQUIRE_LE(encoded.RemainingBytes(), IEC104::Apdu::MAX_ASDU_SIZE);
+
+			// Sendable as a single I-Frame
+			BOOST_REQUIRE_NO_THROW(IEC104::Apdu(encoded.DataBegin(), encoded.RemainingBytes()));
+
+			IEC104::TypedAsdu<IEC104::RecordMeasuredScaled> decoded(config);
+			decoded.ReadFrom(encoded);
+
+			BOOST_REQUIRE_EQUAL(decoded.Size(), expected);
+			for (size_t i = 0; i < expected; ++i)
+			{
+				BOOST_REQUIRE_EQUAL(decoded[i].address, asdu[i].address);
+				BOOST_REQUIRE_EQUAL(decoded[i].val, asdu[i].val);
+				BOOST_REQUIRE_EQUAL(decoded[i].q.GetEncoded(), asdu[i].q.GetEncoded());
+			}
+		}
+	}
+}
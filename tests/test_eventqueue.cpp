@@ -0,0 +1,148 @@
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "core/bytestream.hpp"
+#include "core/fixedhashmap.hpp"
+#include "protocols/iec104/asdu.hpp"
+#include "protocols/iec104/eventqueue.hpp"
+
+using namespace IEC104;
+
+namespace
+{
+	std::vector<Asdu> Drain(EventQueue& arQueue)
+	{
+		std::vector<Asdu> result;
+		ByteStream encoded;
+
+		while (arQueue.Next(encoded, AsduConfig::Defaults))
+		{
+			result.emplace_back();
+			result.back().ReadFrom(encoded);
+			encoded.Clear();
+		}
+
+		return result;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(fixed_hash_map_matches_reference)
+{
+	CORE::FixedHashMap<uint64_t, uint32_t> map(100);
+	std::unordered_map<uint64_t, uint32_t> reference;
+	std::mt19937 random(7);
+
+	for (int i = 0; i < 20000; ++i)
+	{
+		const uint64_t key = random() % 150;
+
+		if (random() % 2)
+		{
+			const bool inserted = map.Insert(key, i);
+			BOOST_REQUIRE_EQUAL(inserted, reference.count(key) != 0 || reference.size() < 100);
+			if (inserted)
+				reference[key] = i;
+		}
+		else
+		{
+			BOOST_REQUIRE_EQUAL(map.Erase(key), reference.erase(key) != 0);
+		}
+
+		BOOST_REQUIRE_EQUAL(map.Size(), reference.size());
+	}
+
+	for (uint64_t key = 0; key < 150; ++key)
+	{
+		auto found = reference.find(key);
+		auto* p_value = map.Find(key);
+		BOOST_REQUIRE_EQUAL(p_value != nullptr, found != reference.end());
+		if (p_value)
+			BOOST_REQUIRE_EQUAL(*p_value, found->second);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(event_queue_coalesces_measured_values)
+{
+	EventQueue queue(4);
+
+	BOOST_REQUIRE(queue.Push(1, RecordMeasuredFloat{10, 1.0f, Quality()}));
+	BOOST_REQUIRE(queue.Push(1, RecordMeasuredFloat{11, 2.0f, Quality()}));
+	BOOST_REQUIRE(queue.Push(1, RecordMeasuredFloat{10, 3.0f, Quality()}));
+	// Same IOA of another station
+	BOOST_REQUIRE(queue.Push(2, RecordMeasuredFloat{10, 4.0f, Quality()}));
+
+	BOOST_REQUIRE_EQUAL(queue.Size(), 3);
+	BOOST_REQUIRE_EQUAL(queue.Counters().queued, 4);
+	BOOST_REQUIRE_EQUAL(queue.Counters().coalesced, 1);
+
+	auto asdus = Drain(queue);
+	BOOST_REQUIRE_EQUAL(asdus.size(), 2);
+	BOOST_REQUIRE(asdus[0].GetReason() == ReasonCode::SPONTANEOUS);
+	BOOST_REQUIRE_EQUAL(asdus[0].GetAddress(), 1);
+	BOOST_REQUIRE_EQUAL(asdus[0].GetNumberOfInfoObjects(), 2);
+
+	// The point keeps its place, but carries its latest value
+	auto first = *asdus[0].begin();
+	BOOST_REQUIRE_EQUAL(first->GetAddress().GetInt(), 10);
+	BOOST_REQUIRE_EQUAL(first->As<DataMeasuredFloat>().val, 3.0f);
+	BOOST_REQUIRE_EQUAL(asdus[1].GetAddress(), 2);
+
+	BOOST_REQUIRE_EQUAL(queue.Counters().sent, 3);
+	BOOST_REQUIRE(queue.Empty());
+
+	// Sent points are queued again
+	BOOST_REQUIRE(queue.Push(1, RecordMeasuredFloat{10, 5.0f, Quality()}));
+	BOOST_REQUIRE_EQUAL(queue.Size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(event_queue_keeps_order_and_bounds)
+{
+	EventQueue queue(3);
+
+	BOOST_REQUIRE(queue.GetPolicy<RecordDoublePoint>() == EventPolicy::KEEP_ALL);
+
+	BOOST_REQUIRE(queue.Push(1, RecordDoublePoint{5, DoublePoint::ON, Quality()}));
+	BOOST_REQUIRE(queue.Push(1, RecordMeasuredScaled{6, 100, Quality()}));
+	BOOST_REQUIRE(queue.Push(1, RecordDoublePoint{5, DoublePoint::OFF, Quality()}));
+	BOOST_REQUIRE(queue.Push(1, RecordDoublePoint{5, DoublePoint::ON, Quality()}));
+
+	// Every change of a double point is kept, until the queue of its type is full
+	BOOST_REQUIRE(!queue.Push(1, RecordDoublePoint{5, DoublePoint::OFF, Quality()}));
+	BOOST_REQUIRE_EQUAL(queue.Counters().overflowed, 1);
+	BOOST_REQUIRE_EQUAL(queue.Size(), 4);
+
+	// The scaled value lies in between the double points and splits them
+	auto asdus = Drain(queue);
+	BOOST_REQUIRE_EQUAL(asdus.size(), 3);
+	BOOST_REQUIRE_EQUAL(asdus[0].GetType(), Type::M_DP_NA_1);
+	BOOST_REQUIRE_EQUAL(asdus[0].GetNumberOfInfoObjects(), 1);
+	BOOST_REQUIRE_EQUAL(asdus[1].GetType(), Type::M_ME_NB_1);
+	BOOST_REQUIRE_EQUAL(asdus[2].GetType(), Type::M_DP_NA_1);
+	BOOST_REQUIRE_EQUAL(asdus[2].GetNumberOfInfoObjects(), 2);
+	BOOST_REQUIRE(!asdus[2].IsSequence());
+
+	BOOST_REQUIRE_THROW(EventQueue(0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(event_queue_fills_asdus)
+{
+	EventQueue queue(500);
+	queue.SetPolicy<RecordMeasuredFloat>(EventPolicy::KEEP_ALL);
+
+	for (uint32_t i = 0; i < 200; ++i)
+		queue.Push(1, RecordMeasuredFloat{i % 10, static_cast<float>(i), Quality()});
+
+	// 30 objects with an IOA of 3 bytes fit into an APDU
+	auto asdus = Drain(queue);
+	BOOST_REQUIRE_EQUAL(asdus.size(), 7);
+	BOOST_REQUIRE_EQUAL(asdus[0].GetNumberOfInfoObjects(), 30);
+	BOOST_REQUIRE_EQUAL(asdus[6].GetNumberOfInfoObjects(), 20);
+
+	BOOST_REQUIRE(queue.Push(1, RecordMeasuredFloat{1, 0.0f, Quality()}));
+	BOOST_REQUIRE_THROW(queue.SetPolicy<RecordMeasuredFloat>(EventPolicy::KEEP_LATEST), std::logic_error);
+	queue.Clear();
+	BOOST_REQUIRE(queue.Empty());
+}
@@ -0,0 +1,158 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include "protocols/iec104/exporter.hpp"
+
+using namespace IEC104;
+
+namespace
+{
+	std::shared_ptr<ExportStatus> MakeStatus()
+	{
+		auto status = std::make_shared<ExportStatus>();
+		status->accepted = 3;
+		status->closed = 1;
+		status->totals.apdusReceived = { 7, 2, 1 };
+		status->totals.decodeErrors = 1;
+		status->totals.receiveTime.buckets[11] = 2;
+		status->totals.receiveTime.count = 2;
+		status->totals.receiveTime.sum = 2500;
+
+		LinkStatus link;
+		link.peer = "127.0.0.1:50000";
+		link.active = true;
+		link.k = 3;
+		link.w = 1;
+		link.metrics.apdusSent = { 5, 0, 1 };
+		status->links.push_back(link);
+
+		link.peer = "odd\"peer";
+		link.active = false;
+		status->links.push_back(link);
+		return status;
+	}
+
+	std::string RenderAll(std::vector<std::shared_ptr<const ExportStatus>> aStatus, size_t aChunkSize)
+	{
+		OpenMetricsRenderer renderer(std::move(aStatus));
+		std::string text;
+		std::string chunk;
+
+		while (renderer.Next(chunk, aChunkSize))
+		{
+			BOOST_REQUIRE(!chunk.empty());
+			text += chunk;
+			chunk.clear();
+		}
+
+		return text;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(openmetrics_renders_in_chunks)
+{
+	std::vector<std::shared_ptr<const ExportStatus>> status{ MakeStatus(), MakeStatus() };
+
+	const auto text = RenderAll(status, 1024 * 1024);
+	BOOST_REQUIRE_EQUAL(RenderAll(status, 64), text);
+	BOOST_REQUIRE(text.ends_with("# EOF\n"));
+
+	// Totals are summed over all sources, links are listed one by one
+	BOOST_REQUIRE(text.find("# TYPE vrtu_connections_accepted counter\n") != std::string::npos);
+	BOOST_REQUIRE(text.find("vrtu_connections_accepted_total 6\n") != std::string::npos);
+	BOOST_REQUIRE(text.find("vrtu_links 4\n") != std::string::npos);
+	BOOST_REQUIRE(text.find("vrtu_links_active 2\n") != std::string::npos);
+	BOOST_REQUIRE(text.find("vrtu_apdus_received_total{format=\"i\"} 14\n") != std::string::npos);
+	BOOST_REQUIRE(text.find("vrtu_decode_errors_total 2\n") != std::string::npos);
+	BOOST_REQUIRE(text.find("vrtu_link_k{peer=\"127.0.0.1:50000\"} 3\n") != std::string::npos);
+	BOOST_REQUIRE(text.find("vrtu_link_apdus_sent_total{peer=\"127.0.0.1:50000\",format=\"u\"} 1\n") != std::string::npos);
+	BOOST_REQUIRE(text.find("vrtu_link_active{peer=\"odd\\\"peer\"} 0\n") != std::string::npos);
+
+	// Buckets are cumulative and in seconds
+	BOOST_REQUIRE(text.find("# UNIT vrtu_receive_seconds seconds\n") != std::string::npos);
+	BOOST_REQUIRE(text.find("vrtu_receive_seconds_bucket{le=\"2.047e-06\"} 4\n") != std::string::npos);
+	BOOST_REQUIRE(text.find("vrtu_receive_seconds_bucket{le=\"+Inf\"} 4\n") != std::string::npos);
+	BOOST_REQUIRE(text.find("vrtu_receive_seconds_count 4\n") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(openmetrics_without_status)
+{
+	const auto text = RenderAll({}, 64);
+
+	BOOST_REQUIRE(text.find("vrtu_links 0\n") != std::string::npos);
+	BOOST_REQUIRE(text.find("vrtu_link_k{") == std::string::npos);
+	BOOST_REQUIRE(text.ends_with("# EOF\n"));
+}
+
+BOOST_AUTO_TEST_CASE(exporter_serves_latest_status)
+{
+	MetricsExporter exporter(asio::ip::address_v4::loopback(), 0);
+	auto& source = exporter.AddSource();
+
+	BOOST_REQUIRE(source.Due(std::chrono::milliseconds(0)));
+	BOOST_REQUIRE(!source.Due(std::chrono::milliseconds(999)));
+	BOOST_REQUIRE(source.Due(std::chrono::seconds(1)));
+	BOOST_REQUIRE(exporter.Latest().empty());
+
+	source.Publish(MakeStatus());
+	BOOST_REQUIRE_EQUAL(exporter.Latest().size(), 1);
+
+	auto scrape = [&exporter](const std::string& arRequest) {
+		asio::io_context ctx;
+		asio::ip::tcp::socket socket(ctx);
+		socket.connect({asio::ip::address_v4::loopback(), exporter.LocalPort()});
+		asio::write(socket, asio::buffer(arRequest));
+
+		std::string response;
+		boost::system::error_code ec;
+		asio::read(socket, asio::dynamic_buffer(response), ec);
+		BOOST_REQUIRE(ec == asio::error::eof);
+		return response;
+	};
+
+	auto response = scrape("GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+	BOOST_REQUIRE(response.starts_with("HTTP/1.1 200 OK\r\n"));
+	BOOST_REQUIRE(response.find("application/openmetrics-text") != std::string::npos);
+	BOOST_REQUIRE(response.find("vrtu_link_w{peer=\"127.0.0.1:50000\"} 1\n") != std::string::npos);
+	BOOST_REQUIRE(response.ends_with("# EOF\n"));
+
+	response = scrape("GET /other HTTP/1.1\r\n\r\n");
+	BOOST_REQUIRE(response.starts_with("HTTP/1.1 404 Not Found\r\n"));
+}
+
+BOOST_AUTO_TEST_CASE(exporter_closes_stalled_scrape)
+{
+	MetricsExporter exporter(asio::ip::address_v4::loopback(), 0, std::chrono::seconds(1), std::chrono::milliseconds(200));
+	exporter.AddSource().Publish(MakeStatus());
+
+	asio::io_context ctx;
+	const asio::ip::tcp::endpoint endpoint(asio::ip::address_v4::loopback(), exporter.LocalPort());
+
+	// Never completes its request
+	asio::ip::tcp::socket stalled(ctx);
+	stalled.connect(endpoint);
+	asio::write(stalled, asio::buffer(std::string("GET /metrics HTTP/1.1\r\n")));
+
+	// Answered, once the stalled scrape has timed out
+	asio::ip::tcp::socket next(ctx);
+	next.connect(endpoint);
+	asio::write(next, asio::buffer(std::string("GET /metrics HTTP/1.1\r\n\r\n")));
+
+	std::string response;
+	boost::system::error_code ec;
+	asio::read(next, asio::dynamic_buffer(response), ec);
+	BOOST_REQUIRE(ec == asio::error::eof);
+	BOOST_REQUIRE(response.starts_with("HTTP/1.1 200 OK\r\n"));
+
+	std::string nothing;
+	asio::read(stalled, asio::dynamic_buffer(nothing), ec);
+	BOOST_REQUIRE(ec == asio::error::eof || ec == asio::error::connection_reset);
+	BOOST_REQUIRE(nothing.empty());
+}
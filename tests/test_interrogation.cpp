@@ -0,0 +1,120 @@
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+#include "core/bytestream.hpp"
+#include "protocols/iec104/apdu.hpp"
+#include "protocols/iec104/asdu.hpp"
+#include "protocols/iec104/interrogation.hpp"
+#include "protocols/iec104/processimage.hpp"
+
+using namespace IEC104;
+
+namespace
+{
+	AsduHeader StationInterrogation(int aCommonAddress)
+	{
+		AsduHeader request;
+		request.type = RecordInterrogationCommand::TYPE_ID;
+		request.size = 1;
+		request.reason = ReasonCode::ACTIVATION;
+		request.origin = 3;
+		request.commonAddress = aCommonAddress;
+		return request;
+	}
+
+	// Decode all responses of an interrogation
+	std::vector<Asdu> Collect(Interrogation& arInterrogation)
+	{
+		std::vector<Asdu> result;
+		ByteStream encoded;
+
+		while (arInterrogation.Next(encoded))
+		{
+			BOOST_REQUIRE_LE(encoded.RemainingBytes(), Apdu::MAX_ASDU_SIZE);
+			result.emplace_back();
+			result.back().ReadFrom(encoded);
+			encoded.Clear();
+		}
+
+		BOOST_REQUIRE(arInterrogation.Done());
+		return result;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(interrogation_packs_points)
+{
+	ProcessImage image;
+
+	// Contiguous run of 300 floats and a few scattered single points
+	for (uint32_t ioa = 1000; ioa < 1300; ++ioa)
+		image.Write(5, RecordMeasuredFloat{ioa, static_cast<float>(ioa), Quality()});
+
+	for (uint32_t ioa : {1, 7, 9, 20})
+		image.Write(5, RecordSinglePoint{ioa, true, Quality()});
+
+	Interrogation gi(image, AsduConfig::Defaults, StationInterrogation(5), InterrogationQualifier::INTERROGATE_STATION);
+	auto responses = Collect(gi);
+
+	// ACTCON, 1 ASDU with single points (SQ=0), 300 floats in 7 ASDUs of up to 48 (SQ=1), ACTTERM
+	BOOST_REQUIRE_EQUAL(responses.size(), 10);
+
+	BOOST_REQUIRE_EQUAL(responses.front().GetType(), Type::C_IC_NA_1);
+	BOOST_REQUIRE(responses.front().GetReason() == ReasonCode::CONFIRM_ACTIVATION);
+	BOOST_REQUIRE(!responses.front().GetHeader().isNegative);
+	BOOST_REQUIRE_EQUAL(responses.front().GetHeader().origin, 3);
+
+	BOOST_REQUIRE_EQUAL(responses[1].GetType(), Type::M_SP_NA_1);
+	BOOST_REQUIRE(!responses[1].IsSequence());
+	BOOST_REQUIRE_EQUAL(responses[1].GetNumberOfInfoObjects(), 4);
+	BOOST_REQUIRE(responses[1].GetReason() == ReasonCode::GENERAL_INTERROGATION);
+
+	int floats = 0;
+	for (size_t i = 2; i < 9; ++i)
+	{
+		BOOST_REQUIRE_EQUAL(responses[i].GetType(), Type::M_ME_NC_1);
+		BOOST_REQUIRE(responses[i].IsSequence());
+		BOOST_REQUIRE_EQUAL(responses[i].GetAddress(), 5);
+		BOOST_REQUIRE_EQUAL(responses[i].GetNumberOfInfoObjects(), i < 8 ? 48 : 12);
+
+		for (const auto& p_object : responses[i])
+		{
+			BOOST_REQUIRE_EQUAL(p_object->GetAddress().GetInt(), 1000 + floats);
+			BOOST_REQUIRE_EQUAL(p_object->As<DataMeasuredFloat>().val, static_cast<float>(1000 + floats));
+			++floats;
+		}
+	}
+	BOOST_REQUIRE_EQUAL(floats, 300);
+
+	BOOST_REQUIRE_EQUAL(responses.back().GetType(), Type::C_IC_NA_1);
+	BOOST_REQUIRE(responses.back().GetReason() == ReasonCode::FINISHED_ACTIVATION);
+}
+
+BOOST_AUTO_TEST_CASE(interrogation_broadcast_and_rejections)
+{
+	ProcessImage image;
+	image.Write(1, RecordSinglePoint{10, true, Quality()});
+	image.Write(2, RecordDoublePoint{20, DoublePoint::ON, Quality()});
+
+	// Every station is answered on its own
+	Interrogation broadcast(image, AsduConfig::Defaults, StationInterrogation(0xFFFF), InterrogationQualifier::INTERROGATE_STATION);
+	auto responses = Collect(broadcast);
+	BOOST_REQUIRE_EQUAL(responses.size(), 6);
+	BOOST_REQUIRE_EQUAL(responses[0].GetAddress(), 1);
+	BOOST_REQUIRE_EQUAL(responses[3].GetAddress(), 2);
+	BOOST_REQUIRE_EQUAL(responses[4].GetType(), Type::M_DP_NA_1);
+
+	// Unknown station
+	Interrogation unknown(image, AsduConfig::Defaults, StationInterrogation(3), InterrogationQualifier::INTERROGATE_STATION);
+	responses = Collect(unknown);
+	BOOST_REQUIRE_EQUAL(responses.size(), 1);
+	BOOST_REQUIRE(responses[0].GetHeader().isNegative);
+	BOOST_REQUIRE(responses[0].GetReason() == ReasonCode::UNKNOWN_COMMON_ADDRESS);
+
+	// Group interrogations are not supported
+	Interrogation group(image, AsduConfig::Defaults, StationInterrogation(1), static_cast<InterrogationQualifier>(21));
+	responses = Collect(group);
+	BOOST_REQUIRE_EQUAL(responses.size(), 1);
+	BOOST_REQUIRE(responses[0].GetHeader().isNegative);
+	BOOST_REQUIRE(responses[0].GetReason() == ReasonCode::CONFIRM_ACTIVATION);
+}
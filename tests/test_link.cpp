@@ -1,9 +1,16 @@
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include "core/bufferpool.hpp"
+#include "core/bytestream.hpp"
 #include "protocols/iec104/link.hpp"
+#include "protocols/iec104/processimage.hpp"
 using namespace IEC104;
 
 namespace asio = boost::asio;
@@ -60,25 +67,106 @@ static std::unique_ptr<TestEnvironment> InitTest() {
 	return env;
 }
 
+// Send to the link and return everything it wrote in response
+static std::vector<uint8_t> Exchange(TestEnvironment& arEnv, const std::vector<uint8_t>& arSend = {})
+{
+	if (!arSend.empty())
+		asio::write(arEnv.client, asio::buffer(arSend));
+
+	arEnv.ctx.restart();
+	arEnv.ctx.poll();
+
+	std::vector<uint8_t> received(arEnv.client.available());
+	asio::read(arEnv.client, asio::buffer(received));
+	return received;
+}
+
+// Split received data into APDUs
+static std::vector<std::vector<uint8_t>> Frames(const std::vector<uint8_t>& arData)
+{
+	std::vector<std::vector<uint8_t>> frames;
+	for (size_t pos = 0; pos + 2 <= arData.size(); pos += arData[pos + 1] + 2)
+		frames.emplace_back(arData.begin() + pos, arData.begin() + std::min(arData.size(), pos + arData[pos + 1] + 2));
+	return frames;
+}
+
+static const std::vector<uint8_t> STARTDT_ACT = { 0x68, 0x04, 0x07, 0x00, 0x00, 0x00 };
+static const std::vector<uint8_t> STARTDT_CON = { 0x68, 0x04, 0x0B, 0x00, 0x00, 0x00 };
+static const std::vector<uint8_t> STOPDT_ACT  = { 0x68, 0x04, 0x13, 0x00, 0x00, 0x00 };
+static const std::vector<uint8_t> STOPDT_CON  = { 0x68, 0x04, 0x23, 0x00, 0x00, 0x00 };
+static const std::vector<uint8_t> TESTFR_ACT  = { 0x68, 0x04, 0x43, 0x00, 0x00, 0x00 };
+static const std::vector<uint8_t> TESTFR_CON  = { 0x68, 0x04, 0x83, 0x00, 0x00, 0x00 };
+
 BOOST_AUTO_TEST_CASE(link_startdt_stopdt_testfr)
 {
-	// TODO
-	//static const uint8_t STARTDT_ACT[] = { 0x68, 0x04, 0x07, 0x00, 0x00, 0x00 };
-	//static const uint8_t STARTDT_CON[] = { 0x68, 0x04, 0x0B, 0x00, 0x00, 0x00 };
-	//static const uint8_t STOPDT_ACT[]  = { 0x68, 0x04, 0x13, 0x00, 0x00, 0x00 };
-	//static const uint8_t STOPDT_CON[]  = { 0x68, 0x04, 0x23, 0x00, 0x00, 0x00 };
-	//static const uint8_t TESTFT_ACT[]  = { 0x68, 0x04, 0x43, 0x00, 0x00, 0x00 };
-	//static const uint8_t TESTFT_CON[]  = { 0x68, 0x04, 0x83, 0x00, 0x00, 0x00 };
-	//std::vector<uint8_t> recvBuffer(1024, 0);
-
-	//auto env = InitTest();
-
-	//Link l(std::move(env->server), Link::Mode::Slave);
-	//auto linkRun = l.Run();
-	//env->client.send(boost::asio::buffer(STARTDT_ACT, 6));
-	//env->client.async_read_some(boost::asio::buffer(recvBuffer.data(), recvBuffer.size()), [&recvBuffer](boost::system::error_code ec, size_t read) {
-	//	BOOST_REQUIRE_EQUAL(read, 6);
-	//	BOOST_REQUIRE_EQUAL(std::memcmp(STARTDT_CON, recvBuffer.data(), 6), 0);
-	//});
-	//env->ctx.poll();
+	auto env = InitTest();
+	CORE::BufferPool buffers(Link::BUFFER_SIZE);
+
+	Link l(std::move(env->server), Link::Mode::Slave, buffers);
+	l.Run();
+
+	BOOST_REQUIRE(Exchange(*env, STARTDT_ACT) == STARTDT_CON);
+	BOOST_REQUIRE(l.IsActive());
+
+	BOOST_REQUIRE(Exchange(*env, TESTFR_ACT) == TESTFR_CON);
+	BOOST_REQUIRE(l.IsActive());
+
+	BOOST_REQUIRE(Exchange(*env, STOPDT_ACT) == STOPDT_CON);
+	BOOST_REQUIRE(!l.IsActive());
+	BOOST_REQUIRE(l.IsConnected());
+}
+
+BOOST_AUTO_TEST_CASE(link_stopdt_discards_pending_data)
+{
+	const auto typeOf = [](const std::vector<uint8_t>& arFrame) { return arFrame.size() > 6 ? arFrame[6] : 0; };
+	const auto reasonOf = [](const std::vector<uint8_t>& arFrame) { return arFrame.size() > 8 ? arFrame[8] & 0x3F : 0; };
+
+	auto env = InitTest();
+	CORE::BufferPool buffers(Link::BUFFER_SIZE);
+	ProcessImage image;
+	image.Write(1, RecordMeasuredFloat{100, 1.0f, Quality()});
+
+	Link l(std::move(env->server), Link::Mode::Slave, buffers);
+	l.AttachProcessImage(image);
+	l.Run();
+
+	BOOST_REQUIRE(Exchange(*env, STARTDT_ACT) == STARTDT_CON);
+
+	// A change is sent with the next flush
+	l.Events().Push(1, RecordMeasuredFloat{100, 2.0f, Quality()});
+	{
+		[[maybe_unused]] auto flush = l.Flush();
+		auto frames = Frames(Exchange(*env));
+		BOOST_REQUIRE_EQUAL(frames.size(), 1);
+		BOOST_REQUIRE_EQUAL(typeOf(frames[0]), RecordMeasuredFloat::TYPE_ID);
+		BOOST_REQUIRE_EQUAL(reasonOf(frames[0]), static_cast<int>(ReasonCode::SPONTANEOUS));
+	}
+
+	// Neither queued changes nor queued I-Frames survive STOPDT
+	l.Events().Push(1, RecordMeasuredFloat{100, 3.0f, Quality()});
+	// M_ME_NC_1, spontaneous, CA 1, IOA 101
+	ByteStream spontaneous{ 0x0D, 0x01, 0x03, 0x00, 0x01, 0x00, 0x65, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00 };
+	Asdu asdu;
+	asdu.ReadFrom(spontaneous);
+	l.Enqueue(asdu);
+
+	BOOST_REQUIRE(Exchange(*env, STOPDT_ACT) == STOPDT_CON);
+	BOOST_REQUIRE(l.Events().Empty());
+	BOOST_REQUIRE_EQUAL(l.QueuedAsdus(), 0);
+
+	// Nothing stale follows the next STARTDT
+	BOOST_REQUIRE(Exchange(*env, STARTDT_ACT) == STARTDT_CON);
+
+	// A general interrogation restores the state. It acknowledges the change, which was sent before.
+	const std::vector<uint8_t> interrogation = { 0x68, 0x0E, 0x00, 0x00, 0x02, 0x00,
+	                                             0x64, 0x01, 0x06, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x14 };
+	auto frames = Frames(Exchange(*env, interrogation));
+
+	BOOST_REQUIRE_EQUAL(frames.size(), 3);
+	BOOST_REQUIRE_EQUAL(typeOf(frames[0]), RecordInterrogationCommand::TYPE_ID);
+	BOOST_REQUIRE_EQUAL(reasonOf(frames[0]), static_cast<int>(ReasonCode::CONFIRM_ACTIVATION));
+	BOOST_REQUIRE_EQUAL(typeOf(frames[1]), RecordMeasuredFloat::TYPE_ID);
+	BOOST_REQUIRE_EQUAL(reasonOf(frames[1]), static_cast<int>(ReasonCode::GENERAL_INTERROGATION));
+	BOOST_REQUIRE_EQUAL(typeOf(frames[2]), RecordInterrogationCommand::TYPE_ID);
+	BOOST_REQUIRE_EQUAL(reasonOf(frames[2]), static_cast<int>(ReasonCode::FINISHED_ACTIVATION));
 }
@@ -0,0 +1,155 @@
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "core/metrics.hpp"
+#include "protocols/iec104/apdu.hpp"
+#include "protocols/iec104/linkmetrics.hpp"
+
+using namespace IEC104;
+
+BOOST_AUTO_TEST_CASE(histogram_power_of_2_buckets)
+{
+	BOOST_REQUIRE_EQUAL(CORE::Histogram::BucketOf(0), 0);
+	BOOST_REQUIRE_EQUAL(CORE::Histogram::BucketOf(1), 1);
+	BOOST_REQUIRE_EQUAL(CORE::Histogram::BucketOf(2), 2);
+	BOOST_REQUIRE_EQUAL(CORE::Histogram::BucketOf(3), 2);
+	BOOST_REQUIRE_EQUAL(CORE::Histogram::BucketOf(1024), 11);
+	BOOST_REQUIRE_EQUAL(CORE::Histogram::BucketOf(UINT64_MAX), CORE::Histogram::BUCKETS - 1);
+
+	CORE::Histogram histogram;
+	for (uint64_t i = 1; i <= 100; ++i)
+		histogram.Record(i);
+
+	auto snapshot = histogram.Read();
+	BOOST_REQUIRE_EQUAL(snapshot.count, 100);
+	BOOST_REQUIRE_EQUAL(snapshot.sum, 5050);
+	BOOST_REQUIRE_EQUAL(snapshot.max, 100);
+	// 50 is in [32, 64), 99 in [64, 128)
+	BOOST_REQUIRE_EQUAL(snapshot.Quantile(0.5), 63);
+	BOOST_REQUIRE_EQUAL(snapshot.Quantile(0.99), 127);
+	BOOST_REQUIRE_EQUAL(CORE::Histogram::Snapshot().Quantile(0.5), 0);
+
+	snapshot += histogram.Read();
+	BOOST_REQUIRE_EQUAL(snapshot.count, 200);
+	BOOST_REQUIRE_EQUAL(snapshot.buckets[1], 2);
+	BOOST_REQUIRE_EQUAL(snapshot.max, 100);
+}
+
+BOOST_AUTO_TEST_CASE(counter_concurrent_writers)
+{
+	CORE::Padded<CORE::Counter> counter;
+	static_assert(alignof(decltype(counter)) == CORE::CACHE_LINE);
+
+	std::vector<std::thread> writers;
+	for (int i = 0; i < 4; ++i)
+		writers.emplace_back([&counter] {
+			for (int n = 0; n < 10000; ++n)
+				counter.Add();
+		});
+
+	for (auto& r_writer : writers)
+		r_writer.join();
+
+	BOOST_REQUIRE_EQUAL(counter.Load(), 40000);
+}
+
+BOOST_AUTO_TEST_CASE(link_metrics_sum_up_in_group)
+{
+	const uint8_t i_frame[] = { 0x68, 0x0E, 0x02, 0x00, 0x04, 0x00, 0x0D, 0x01, 0x03, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00 };
+	const Apdu ack(Sequence(1));
+
+	LinkMetricsGroup group;
+	{
+		std::optional<LinkMetrics> first(std::in_place);
+		LinkMetrics second;
+		LinkMetrics third;
+		first->AttachGroup(group);
+		second.AttachGroup(group);
+		third.AttachGroup(group);
+
+		first->Received(ApduView(i_frame));
+		first->Sent(ack);
+		first->Sent(Apdu::STARTDT_CON);
+		second.Received(ApduView(i_frame));
+		second.DecodeError();
+		second.T2Ack();
+
+		first->SendQueue(5);
+		second.SendQueue(3);
+		first->SendQueue(2);
+
+		auto link = first->Read();
+		BOOST_REQUIRE_EQUAL(link.apdusReceived[static_cast<size_t>(FrameFormat::I)], 1);
+		BOOST_REQUIRE_EQUAL(link.bytesReceived[static_cast<size_t>(FrameFormat::I)], sizeof(i_frame));
+		BOOST_REQUIRE_EQUAL(link.apdusSent[static_cast<size_t>(FrameFormat::S)], 1);
+		BOOST_REQUIRE_EQUAL(link.apdusSent[static_cast<size_t>(FrameFormat::U)], 1);
+		BOOST_REQUIRE_EQUAL(link.decodeErrors, 0);
+		BOOST_REQUIRE_EQUAL(link.sendQueue, 2);
+		BOOST_REQUIRE_EQUAL(link.sendQueueDepth.count, 2);
+
+		auto total = group.Read();
+		BOOST_REQUIRE_EQUAL(total.apdusReceived[static_cast<size_t>(FrameFormat::I)], 2);
+		BOOST_REQUIRE_EQUAL(total.decodeErrors, 1);
+		BOOST_REQUIRE_EQUAL(total.t2Acks, 1);
+		BOOST_REQUIRE_EQUAL(total.sendQueue, 5);
+		BOOST_REQUIRE_EQUAL(total.sendQueueDepth.count, 3);
+
+		// The first link leaves, while the others keep counting
+		first.reset();
+		third.T1Expired();
+
+		total = group.Read();
+		BOOST_REQUIRE_EQUAL(total.apdusReceived[static_cast<size_t>(FrameFormat::I)], 2);
+		BOOST_REQUIRE_EQUAL(total.t1Expired, 1);
+		BOOST_REQUIRE_EQUAL(total.sendQueue, 3);
+	}
+
+	// Removed links keep their counts, but no longer queue any frames
+	auto total = group.Read();
+	BOOST_REQUIRE_EQUAL(total.apdusSent[static_cast<size_t>(FrameFormat::S)], 1);
+	BOOST_REQUIRE_EQUAL(total.sendQueue, 0);
+}
+
+BOOST_AUTO_TEST_CASE(link_metrics_group_read_while_links_join_and_leave)
+{
+	constexpr uint64_t LINKS = 2000;
+
+	const uint8_t i_frame[] = { 0x68, 0x0E, 0x02, 0x00, 0x04, 0x00, 0x0D, 0x01, 0x03, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00 };
+	const auto received = [](const LinkMetrics::Snapshot& arSnapshot) {
+		return arSnapshot.apdusReceived[static_cast<size_t>(FrameFormat::I)];
+	};
+
+	LinkMetricsGroup group;
+	std::atomic<bool> done{false};
+
+	// Counts move from a leaving link to the removed ones, so the total never goes down
+	std::thread reader([&] {
+		uint64_t last = 0;
+		while (!done.load())
+		{
+			const auto total = received(group.Read());
+			BOOST_REQUIRE_GE(total, last);
+			last = total;
+		}
+	});
+
+	std::vector<std::optional<LinkMetrics>> links(8);
+	for (uint64_t i = 0; i < LINKS; ++i)
+	{
+		auto& link = links[i % links.size()];
+		link.emplace();
+		link->AttachGroup(group);
+		link->Received(ApduView(i_frame));
+	}
+
+	done.store(true);
+	reader.join();
+
+	BOOST_REQUIRE_EQUAL(received(group.Read()), LINKS);
+	links.clear();
+	BOOST_REQUIRE_EQUAL(received(group.Read()), LINKS);
+}
@@ -0,0 +1,302 @@
+#include <boost/test/unit_test.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#include "core/bytestream.hpp"
+#include "protocols/iec104/apdu.hpp"
+#include "protocols/iec104/asdu.hpp"
+#include "protocols/iec104/pcapimport.hpp"
+#include "protocols/iec104/pcapreader.hpp"
+#include "protocols/iec104/typedasdu.hpp"
+
+using namespace IEC104;
+
+namespace
+{
+	using Bytes = std::vector<uint8_t>;
+
+	void PutLE(Bytes& arOut, uint64_t aValue, size_t aBytes)
+	{
+		for (size_t i = 0; i < aBytes; ++i)
+			arOut.push_back(static_cast<uint8_t>(aValue >> (8 * i)));
+	}
+
+	void PutBE(Bytes& arOut, uint64_t aValue, size_t aBytes)
+	{
+		for (size_t i = aBytes; i > 0; --i)
+			arOut.push_back(static_cast<uint8_t>(aValue >> (8 * (i - 1))));
+	}
+
+	// Ethernet frame with IPv4 and TCP between 10.0.0.1 (client) and 10.0.0.2:2404 (server)
+	Bytes Frame(bool aFromServer, uint32_t aSequence, uint8_t aFlags, const Bytes& arPayload)
+	{
+		Bytes frame(12, 0);
+		PutBE(frame, 0x0800, 2);
+
+		const uint32_t client = 0x0A000001, server = 0x0A000002;
+		PutBE(frame, 0x45, 1);
+		PutBE(frame, 0, 1);
+		PutBE(frame, 20 + 20 + arPayload.size(), 2);
+		PutBE(frame, 0, 4);
+		PutBE(frame, 64, 1);
+		PutBE(frame, 6, 1);
+		PutBE(frame, 0, 2);
+		PutBE(frame, aFromServer ? server : client, 4);
+		PutBE(frame, aFromServer ? client : server, 4);
+
+		PutBE(frame, aFromServer ? 2404 : 50000, 2);
+		PutBE(frame, aFromServer ? 50000 : 2404, 2);
+		PutBE(frame, aSequence, 4);
+		PutBE(frame, 0, 4);
+		PutBE(frame, 5 << 4, 1);
+		PutBE(frame, aFlags, 1);
+		PutBE(frame, 0, 6);
+
+		frame.insert(frame.end(), arPayload.begin(), arPayload.end());
+		return frame;
+	}
+
+	Bytes Frame(const Apdu& arApdu)
+	{
+		return Bytes(arApdu.View().Data(), arApdu.View().Data() + arApdu.Length());
+	}
+
+	Bytes IFrame()
+	{
+		TypedAsdu<RecordMeasuredFloat> asdu(AsduConfig::Defaults);
+		asdu.GetHeader().reason = ReasonCode::SPONTANEOUS;
+		asdu.GetHeader().commonAddress = 1;
+		for (uint32_t i = 0; i < 10; ++i)
+			asdu.Append(RecordMeasuredFloat{i, 1.0f, Quality()});
+
+		ByteStream encoded;
+		asdu.WriteTo(encoded);
+		return Frame(Apdu(encoded.DataBegin(), encoded.RemainingBytes()));
+	}
+
+	// Classic pcap with microsecond timestamps
+	void WritePcap(const std::string& arPath, const std::vector<Bytes>& arFrames)
+	{
+		Bytes file;
+		PutLE(file, 0xA1B2C3D4, 4);
+		PutLE(file, 2, 2);
+		PutLE(file, 4, 2);
+		PutLE(file, 0, 8);
+		PutLE(file, 65535, 4);
+		PutLE(file, 1, 4);
+
+		for (size_t i = 0; i < arFrames.size(); ++i)
+		{
+			PutLE(file, 100, 4);
+			PutLE(file, i, 4);
+			PutLE(file, arFrames[i].size(), 4);
+			PutLE(file, arFrames[i].size(), 4);
+			file.insert(file.end(), arFrames[i].begin(), arFrames[i].end());
+		}
+
+		std::ofstream(arPath, std::ios::binary).write(reinterpret_cast<const char*>(file.data()), file.size());
+	}
+
+	// Big-endian pcapng with nanosecond timestamps
+	void WritePcapNg(const std::string& arPath, const std::vector<Bytes>& arFrames)
+	{
+		Bytes file;
+		PutBE(file, 0x0A0D0D0A, 4);
+		PutBE(file, 28, 4);
+		PutBE(file, 0x1A2B3C4D, 4);
+		PutBE(file, 0x00010000, 4);
+		PutBE(file, 0xFFFFFFFFFFFFFFFF, 8);
+		PutBE(file, 28, 4);
+
+		// Interface with if_tsresol = 9
+		PutBE(file, 1, 4);
+		PutBE(file, 32, 4);
+		PutBE(file, 1, 2);
+		PutBE(file, 0, 2);
+		PutBE(file, 65535, 4);
+		PutBE(file, 9, 2);
+		PutBE(file, 1, 2);
+		file.insert(file.end(), { 9, 0, 0, 0 });
+		PutBE(file, 0, 4);
+		PutBE(file, 32, 4);
+
+		for (size_t i = 0; i < arFrames.size(); ++i)
+		{
+			const size_t padded = (arFrames[i].size() + 3) / 4 * 4;
+			const uint64_t timestamp = 5000000000ull + i;
+
+			PutBE(file, 6, 4);
+			PutBE(file, 32 + padded, 4);
+			PutBE(file, 0, 4);
+			PutBE(file, timestamp >> 32, 4);
+			PutBE(file, timestamp & 0xFFFFFFFF, 4);
+			PutBE(file, arFrames[i].size(), 4);
+			PutBE(file, arFrames[i].size(), 4);
+			file.insert(file.end(), arFrames[i].begin(), arFrames[i].end());
+			file.resize(file.size() + padded - arFrames[i].size(), 0);
+			PutBE(file, 32 + padded, 4);
+		}
+
+		std::ofstream(arPath, std::ios::binary).write(reinterpret_cast<const char*>(file.data()), file.size());
+	}
+
+	struct TempFile
+	{
+		TempFile() : path((std::filesystem::temp_directory_path() / "vrtu_test_import.pcap").string()) {}
+		~TempFile() { std::filesystem::remove(path); }
+
+		std::string path;
+	};
+
+	struct Recorded
+	{
+		PcapEvent::Type type;
+		uint32_t connection;
+		bool fromServer;
+		size_t length;
+		int objects;
+	};
+
+	std::vector<Recorded> Import(const std::string& arPath, size_t aWorkers, PcapStats& arStats)
+	{
+		std::mutex mutex;
+		std::vector<Recorded> events;
+
+		PcapImport import([&](const PcapEvent& e) {
+			std::lock_guard lock(mutex);
+			events.push_back({e.type, e.connection->id, e.fromServer,
+			                  e.apdu ? e.apdu->Length() : 0, e.asdu ? e.asdu->GetNumberOfInfoObjects() : -1});
+		}, aWorkers);
+
+		arStats = import.Run(arPath);
+		return events;
+	}
+
+	constexpr uint8_t SYN = 0x02, FIN = 0x01, ACK = 0x10;
+}
+
+BOOST_AUTO_TEST_CASE(pcap_import_reassembles_streams)
+{
+	TempFile file;
+	const auto startdt = Frame(Apdu::STARTDT_ACT);
+	const auto confirm = Frame(Apdu::STARTDT_CON);
+	const auto data = IFrame();
+	const Bytes first(data.begin(), data.begin() + 20);
+	const Bytes second(data.begin() + 20, data.end());
+
+	WritePcap(file.path, {
+		Frame(false, 1000, SYN, {}),
+		Frame(true, 7000, SYN | ACK, {}),
+		Frame(false, 1001, ACK, startdt),
+		// Retransmission
+		Frame(false, 1001, ACK, startdt),
+		Frame(true, 7001, ACK, confirm),
+		// Out of order
+		Frame(true, 7007 + 20, ACK, second),
+		Frame(true, 7007, ACK, first),
+		Frame(false, 1007, FIN | ACK, {}),
+		Frame(true, 7007 + data.size(), FIN | ACK, {}),
+		// Not IEC 104
+		Frame(false, 1, ACK, {}),
+	});
+
+	for (size_t workers : { 0, 2 })
+	{
+		PcapStats stats;
+		auto events = Import(file.path, workers, stats);
+
+		BOOST_REQUIRE_EQUAL(stats.packets, 10);
+		BOOST_REQUIRE_EQUAL(stats.connections, 1);
+		BOOST_REQUIRE_EQUAL(stats.apdus, 3);
+		BOOST_REQUIRE_EQUAL(stats.asdus, 1);
+		BOOST_REQUIRE_EQUAL(stats.errors, 0);
+
+		BOOST_REQUIRE_EQUAL(events.size(), 3);
+		BOOST_REQUIRE(!events[0].fromServer);
+		BOOST_REQUIRE_EQUAL(events[0].length, 6);
+		BOOST_REQUIRE(events[1].fromServer);
+		BOOST_REQUIRE_EQUAL(events[2].length, data.size());
+		BOOST_REQUIRE_EQUAL(events[2].objects, 10);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(pcap_import_resynchronizes)
+{
+	TempFile file;
+	const auto data = IFrame();
+
+	// The capture starts amid an APDU of a running connection
+	Bytes payload(data.begin() + 30, data.end());
+	payload.insert(payload.end(), data.begin(), data.end());
+
+	WritePcapNg(file.path, { Frame(true, 123456, ACK, payload) });
+
+	PcapReader reader(file.path);
+	PcapPacket packet;
+	BOOST_REQUIRE(reader.IsPcapNg());
+	BOOST_REQUIRE(reader.Next(packet));
+	BOOST_REQUIRE_EQUAL(packet.timestamp.count(), 5000000000);
+	BOOST_REQUIRE_EQUAL(packet.linkType, 1);
+	BOOST_REQUIRE(!reader.Next(packet));
+
+	PcapStats stats;
+	auto events = Import(file.path, 1, stats);
+
+	BOOST_REQUIRE_EQUAL(events.size(), 2);
+	BOOST_REQUIRE(events[0].type == PcapEvent::Type::MALFORMED);
+	BOOST_REQUIRE(events[1].type == PcapEvent::Type::APDU);
+	BOOST_REQUIRE_EQUAL(events[1].objects, 10);
+}
+
+BOOST_AUTO_TEST_CASE(pcap_import_releases_closed_connections)
+{
+	TempFile file;
+	const auto startdt = Frame(Apdu::STARTDT_ACT);
+	constexpr uint8_t RST = 0x04;
+
+	WritePcap(file.path, {
+		Frame(false, 1000, SYN, {}),
+		Frame(false, 1001, ACK, startdt),
+		Frame(false, 1007, FIN | ACK, {}),
+		Frame(true, 7000, FIN | ACK, {}),
+		// Trailing acknowledge of the closed connection
+		Frame(false, 1008, ACK, {}),
+		// The addresses are reused by the next connection, which is reset
+		Frame(false, 5000, SYN, {}),
+		Frame(false, 5001, ACK, startdt),
+		Frame(true, 9000, RST, {}),
+		// Reused again, before the previous connection was closed
+		Frame(false, 6000, SYN, {}),
+		Frame(false, 6001, ACK, startdt),
+		Frame(false, 6000, SYN, {}),
+		Frame(false, 6001, ACK, startdt),
+	});
+
+	for (size_t workers : { 0, 2 })
+	{
+		PcapStats stats;
+		auto events = Import(file.path, workers, stats);
+
+		BOOST_REQUIRE_EQUAL(stats.connections, 4);
+		BOOST_REQUIRE_EQUAL(stats.apdus, 4);
+		BOOST_REQUIRE_EQUAL(events.size(), 4);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(pcap_import_rethrows_handler_errors)
+{
+	TempFile file;
+	WritePcap(file.path, {
+		Frame(false, 1000, SYN, {}),
+		Frame(false, 1001, ACK, Frame(Apdu::STARTDT_ACT)),
+	});
+
+	for (size_t workers : { 0, 2 })
+	{
+		PcapImport import([](const PcapEvent&) { throw std::runtime_error("handler failed"); }, workers);
+		BOOST_REQUIRE_THROW(import.Run(file.path), std::runtime_error);
+	}
+}
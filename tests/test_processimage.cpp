@@ -0,0 +1,145 @@
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "core/bytestream.hpp"
+#include "core/pagetable.hpp"
+#include "protocols/iec104/asdu.hpp"
+#include "protocols/iec104/processimage.hpp"
+#include "protocols/iec104/typedasdu.hpp"
+
+BOOST_AUTO_TEST_CASE(page_table_allocates_on_demand)
+{
+	CORE::PageTable<int, 16, 8> table;
+
+	BOOST_REQUIRE(table.Find(300) == nullptr);
+	BOOST_REQUIRE_EQUAL(table.Pages(), 0);
+
+	table.Get(300) = 5;
+	BOOST_REQUIRE_EQUAL(table.Pages(), 1);
+	BOOST_REQUIRE_EQUAL(*table.Find(300), 5);
+	// Same page, value-initialized
+	BOOST_REQUIRE_EQUAL(*table.Find(301), 0);
+	BOOST_REQUIRE(table.Find(0) == nullptr);
+
+	BOOST_REQUIRE(table.Find(1 << 16) == nullptr);
+	BOOST_REQUIRE_THROW(table.Get(1 << 16), std::out_of_range);
+
+	std::vector<size_t> visited;
+	table.ForEach([&](size_t aIndex, int& arValue) { if (arValue) visited.push_back(aIndex); });
+	BOOST_REQUIRE(visited == std::vector<size_t>{300});
+}
+
+BOOST_AUTO_TEST_CASE(process_image_read_write)
+{
+	IEC104::ProcessImage image;
+	IEC104::RecordMeasuredFloat record;
+
+	BOOST_REQUIRE(!image.Read(1, 100, record));
+
+	IEC104::Quality q;
+	q.SetInvalid(true);
+	image.Write(1, IEC104::RecordMeasuredFloat{100, 2.5f, q});
+	image.Write(1, IEC104::RecordSinglePoint{100, true, IEC104::Quality()});
+
+	BOOST_REQUIRE(image.Read(1, 100, record));
+	BOOST_REQUIRE_EQUAL(record.address, 100);
+	BOOST_REQUIRE_EQUAL(record.val, 2.5f);
+	BOOST_REQUIRE(record.q.IsInvalid());
+
+	// Columns and stations are separate
+	IEC104::RecordSinglePoint single;
+	BOOST_REQUIRE(image.Read(1, 100, single));
+	BOOST_REQUIRE(single.val);
+	BOOST_REQUIRE(!image.Read(1, 101, record));
+	BOOST_REQUIRE(!image.Read(2, 100, record));
+
+	// The latest state wins
+	image.Write(1, IEC104::RecordMeasuredFloat{100, -1.0f, IEC104::Quality()});
+	BOOST_REQUIRE(image.Read(1, 100, record));
+	BOOST_REQUIRE_EQUAL(record.val, -1.0f);
+	BOOST_REQUIRE(record.q.IsGood());
+
+	BOOST_REQUIRE_THROW(image.Write(1, IEC104::RecordMeasuredFloat{1 << 24, 0.0f, IEC104::Quality()}), std::out_of_range);
+	BOOST_REQUIRE(!image.Read(1, 1 << 24, record));
+}
+
+BOOST_AUTO_TEST_CASE(process_image_update_from_asdu)
+{
+	// M_ME_NB_1, SQ=1, 3 objects, COT 3, CA 7, 1st IOA 0x010000
+	const std::vector<uint8_t> encoded{ 0x0B, 0x83, 0x03, 0x00, 0x07, 0x00,
+	                                    0x00, 0x00, 0x01,
+	                                    0x01, 0x00, 0x00,
+	                                    0xFF, 0xFF, 0x10,
+	                                    0x00, 0x80, 0x00 };
+
+	IEC104::ProcessImage image;
+
+	IEC104::Asdu generic;
+	ByteStream data(encoded.data(), encoded.data() + encoded.size());
+	generic.ReadFrom(data);
+	BOOST_REQUIRE_EQUAL(image.Update(generic), 3);
+
+	IEC104::RecordMeasuredScaled record;
+	BOOST_REQUIRE(image.Read(7, 0x010001, record));
+	BOOST_REQUIRE_EQUAL(record.val, -1);
+	BOOST_REQUIRE(record.q.IsBlocked());
+
+	// Visited in ascending order of the IOA
+	std::vector<int16_t> values;
+	image.ForEach<IEC104::RecordMeasuredScaled>(7, [&](const IEC104::RecordMeasuredScaled& arRecord) {
+		BOOST_REQUIRE_EQUAL(arRecord.address, 0x010000 + values.size());
+		values.push_back(arRecord.val);
+	});
+	BOOST_REQUIRE(values == (std::vector<int16_t>{1, -1, -32768}));
+
+	// Typed ASDUs update the same columns
+	IEC104::TypedAsdu<IEC104::RecordMeasuredScaled> typed;
+	typed.ReadFrom(encoded.data(), encoded.size());
+	typed[0].val = 42;
+
+	IEC104::ProcessImage other;
+	BOOST_REQUIRE_EQUAL(other.Update(typed), 3);
+	BOOST_REQUIRE(other.Read(7, 0x010000, record));
+	BOOST_REQUIRE_EQUAL(record.val, 42);
+
+	std::vector<int> stations;
+	other.ForEachStation([&](int aCommonAddress) { stations.push_back(aCommonAddress); });
+	BOOST_REQUIRE(stations == std::vector<int>{7});
+
+	// Unsupported types are ignored
+	IEC104::Asdu command;
+	ByteStream gi{ 0x64, 0x01, 0x06, 0x00, 0x07, 0x00, 0x00, 0x00, 0x00, 0x14 };
+	command.ReadFrom(gi);
+	BOOST_REQUIRE_EQUAL(image.Update(command), 0);
+}
+
+BOOST_AUTO_TEST_CASE(process_image_concurrent_readers)
+{
+	IEC104::ProcessImage image;
+	std::atomic<bool> done{false};
+	std::atomic<int> torn{0};
+
+	// Readers either see no point or a consistent one, while pages and stations are allocated
+	std::thread reader([&]() {
+		IEC104::RecordMeasuredFloat record;
+
+		while (!done.load())
+		{
+			for (uint32_t ioa = 0; ioa < 10000; ioa += 97)
+			{
+				if (image.Read(3, ioa, record) && record.val != static_cast<float>(ioa))
+					++torn;
+			}
+		}
+	});
+
+	for (uint32_t ioa = 0; ioa < 10000; ++ioa)
+		image.Write(3, IEC104::RecordMeasuredFloat{ioa, static_cast<float>(ioa), IEC104::Quality()});
+
+	done = true;
+	reader.join();
+	BOOST_REQUIRE_EQUAL(torn.load(), 0);
+}
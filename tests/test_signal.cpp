@@ -0,0 +1,164 @@
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "core/delegate.hpp"
+#include "core/signal.hpp"
+#include "core/spscring.hpp"
+
+BOOST_AUTO_TEST_CASE(delegate_stores_callable_inline)
+{
+	int calls = 0;
+	CORE::Delegate<int(int)> add([&calls](int value) { ++calls; return value + 1; });
+
+	BOOST_REQUIRE(add);
+	BOOST_REQUIRE_EQUAL(add(41), 42);
+
+	// Moving keeps the callable, the source is left empty
+	auto moved = std::move(add);
+	BOOST_REQUIRE(!add);
+	BOOST_REQUIRE_EQUAL(moved(1), 2);
+	BOOST_REQUIRE_EQUAL(calls, 2);
+
+	// Non-trivial captures are moved and destroyed properly
+	auto counted = std::make_shared<int>(7);
+	{
+		CORE::Delegate<int()> read([counted]() { return *counted; });
+		BOOST_REQUIRE_EQUAL(counted.use_count(), 2);
+
+		CORE::Delegate<int()> other;
+		other = std::move(read);
+		BOOST_REQUIRE_EQUAL(other(), 7);
+		BOOST_REQUIRE_EQUAL(counted.use_count(), 2);
+	}
+	BOOST_REQUIRE_EQUAL(counted.use_count(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(signal_calls_everyone_in_order)
+{
+	CORE::SignalEveryone<void, std::string&> signal;
+	BOOST_REQUIRE(signal.Empty());
+
+	signal.Register([](std::string& text) { text += "a"; });
+	signal.Register([](auto& text) { text += "b"; });
+
+	std::string text;
+	signal(text);
+	BOOST_REQUIRE_EQUAL(text, "ab");
+
+	CORE::SignalEveryone<void, void> tick;
+	int ticks = 0;
+	tick.Register([&ticks]() { ++ticks; });
+	tick();
+	BOOST_REQUIRE_EQUAL(ticks, 1);
+}
+
+BOOST_AUTO_TEST_CASE(signal_may_be_invoked_by_its_callees)
+{
+	CORE::SignalEveryone<void, int> signal;
+	std::string order;
+
+	// Like a subscriber, which closes the link and so changes its state once more
+	signal.Register([&signal, &order](int depth) {
+		order += std::to_string(depth);
+		if (depth < 2)
+			signal(depth + 1);
+	});
+	signal(0);
+	BOOST_REQUIRE_EQUAL(order, "012");
+
+	// Registering from a callee would move the running callees
+	CORE::SignalEveryone<void, void> tick;
+	tick.Register([&tick]() { tick.Register([]() {}); });
+	BOOST_REQUIRE_THROW(tick(), std::logic_error);
+
+	// The signal is usable again after a callee threw
+	BOOST_REQUIRE_NO_THROW(tick.Register([]() {}));
+}
+
+BOOST_AUTO_TEST_CASE(spsc_ring_rejects_when_full)
+{
+	CORE::SpscRing<std::string> ring(3);
+	BOOST_REQUIRE_EQUAL(ring.Capacity(), 4);
+
+	for (int i = 0; i < 4; ++i)
+		BOOST_REQUIRE(ring.TryPush(std::to_string(i)));
+
+	BOOST_REQUIRE(!ring.TryPush("4"));
+	BOOST_REQUIRE_EQUAL(ring.Dropped(), 1);
+
+	BOOST_REQUIRE_EQUAL(*ring.TryPop(), "0");
+	BOOST_REQUIRE(ring.TryPush("5"));
+
+	std::string order;
+	BOOST_REQUIRE_EQUAL(ring.Drain([&order](std::string&& value) { order += value; }), 4);
+	BOOST_REQUIRE_EQUAL(order, "1235");
+	BOOST_REQUIRE(!ring.TryPop());
+}
+
+BOOST_AUTO_TEST_CASE(signal_publishes_to_consumer_thread)
+{
+	constexpr uint64_t CALLS = 100000;
+
+	CORE::SignalEveryone<void, const int&, int> signal;
+	// Large enough for every call, so none is dropped, however slow the consumer is
+	CORE::SpscRing<uint64_t> ring(CALLS);
+	signal.RegisterAsync(ring, [](const int& a, int b) { return static_cast<uint64_t>(a) + b; });
+
+	uint64_t sum = 0;
+	uint64_t received = 0;
+
+	std::thread consumer([&] {
+		while (received + ring.Dropped() < CALLS)
+			received += ring.Drain([&sum](uint64_t value) { sum += value; });
+	});
+
+	uint64_t expected = 0;
+	for (uint64_t i = 0; i < CALLS; ++i)
+	{
+		signal(static_cast<int>(i % 1000), 1);
+		expected += i % 1000 + 1;
+	}
+
+	consumer.join();
+
+	BOOST_REQUIRE_EQUAL(ring.Dropped(), 0);
+	BOOST_REQUIRE_EQUAL(received, CALLS);
+	BOOST_REQUIRE_EQUAL(sum, expected);
+}
+
+BOOST_AUTO_TEST_CASE(spsc_ring_set_takes_one_producer_per_ring)
+{
+	constexpr uint64_t CALLS = 10000;
+
+	CORE::SpscRingSet<uint64_t> rings(2, CALLS);
+	BOOST_REQUIRE_EQUAL(rings.Size(), 2);
+
+	// Each producer invokes a signal of its own, like the links of different workers
+	CORE::SignalEveryone<void, uint64_t> first;
+	CORE::SignalEveryone<void, uint64_t> second;
+	first.RegisterAsync(rings[0], [](uint64_t value) { return value; });
+	second.RegisterAsync(rings[1], [](uint64_t value) { return value; });
+
+	std::thread producer([&first] {
+		for (uint64_t i = 0; i < CALLS; ++i)
+			first(i);
+	});
+	for (uint64_t i = 0; i < CALLS; ++i)
+		second(CALLS + i);
+	producer.join();
+
+	// Values of each producer keep their order
+	uint64_t next[2] = {0, CALLS};
+	size_t handled = rings.Drain([&next](uint64_t value) {
+		auto& expected = next[value < CALLS ? 0 : 1];
+		BOOST_REQUIRE_EQUAL(value, expected);
+		++expected;
+	});
+
+	BOOST_REQUIRE_EQUAL(handled, 2 * CALLS);
+	BOOST_REQUIRE_EQUAL(rings.Dropped(), 0);
+}
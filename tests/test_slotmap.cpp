@@ -0,0 +1,77 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+#include "core/slotmap.hpp"
+
+namespace
+{
+	// Neither copyable nor movable, like a link
+	struct Pinned
+	{
+		explicit Pinned(int aValue, int& arDestroyed) : value(aValue), destroyed(arDestroyed) {}
+		~Pinned() { ++destroyed; }
+
+		Pinned(const Pinned&) = delete;
+		Pinned& operator=(const Pinned&) = delete;
+
+		int value;
+		int& destroyed;
+	};
+}
+
+BOOST_AUTO_TEST_CASE(slotmap_keeps_addresses_on_growth)
+{
+	int destroyed = 0;
+	{
+		CORE::SlotMap<Pinned, 4> map;
+		std::vector<CORE::SlotMap<Pinned, 4>::Handle> handles;
+		std::vector<Pinned*> addresses;
+
+		for (int i = 0; i < 100; ++i)
+		{
+			handles.push_back(map.Emplace(i, destroyed));
+			addresses.push_back(map.Get(handles.back()));
+		}
+
+		BOOST_REQUIRE_EQUAL(map.Size(), 100);
+
+		for (int i = 0; i < 100; ++i)
+		{
+			BOOST_REQUIRE_EQUAL(map.Get(handles[i]), addresses[i]);
+			BOOST_REQUIRE_EQUAL(map.Get(handles[i])->value, i);
+		}
+
+		BOOST_REQUIRE_EQUAL(map.EraseIf([](const Pinned& p) { return p.value % 2 == 0; }), 50);
+		BOOST_REQUIRE_EQUAL(destroyed, 50);
+		BOOST_REQUIRE(map.Get(handles[0]) == nullptr);
+		BOOST_REQUIRE_EQUAL(map.Get(handles[1]), addresses[1]);
+	}
+	BOOST_REQUIRE_EQUAL(destroyed, 100);
+}
+
+BOOST_AUTO_TEST_CASE(slotmap_rejects_stale_handles)
+{
+	CORE::SlotMap<std::string> map;
+
+	auto first = map.Emplace("first");
+	BOOST_REQUIRE(map.Erase(first));
+	BOOST_REQUIRE(!map.Erase(first));
+
+	// The slot is reused with a new generation
+	auto second = map.Emplace("second");
+	BOOST_REQUIRE_EQUAL(second.Index(), first.Index());
+	BOOST_REQUIRE(map.Get(first) == nullptr);
+	BOOST_REQUIRE_EQUAL(*map.Get(second), "second");
+
+	BOOST_REQUIRE(map.Get(CORE::SlotMap<std::string>::Handle()) == nullptr);
+
+	size_t visited = 0;
+	map.ForEach([&](auto handle, std::string& value) {
+		BOOST_REQUIRE(handle == second);
+		BOOST_REQUIRE_EQUAL(value, "second");
+		++visited;
+	});
+	BOOST_REQUIRE_EQUAL(visited, 1);
+}
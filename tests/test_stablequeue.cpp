@@ -0,0 +1,98 @@
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "core/stablequeue.hpp"
+
+namespace
+{
+	// Neither copyable nor movable, like a frame, whose memory is being written
+	struct Pinned
+	{
+		explicit Pinned(int aValue, int& arDestroyed) : value(aValue), destroyed(arDestroyed) {}
+		~Pinned() { ++destroyed; }
+
+		Pinned(const Pinned&) = delete;
+		Pinned& operator=(const Pinned&) = delete;
+
+		int value;
+		int& destroyed;
+	};
+}
+
+BOOST_AUTO_TEST_CASE(stablequeue_keeps_addresses_on_growth)
+{
+	int destroyed = 0;
+	{
+		CORE::StableQueue<Pinned> queue(3);
+		BOOST_REQUIRE_EQUAL(queue.Capacity(), 3);
+
+		std::vector<Pinned*> addresses;
+		for (int i = 0; i < 100; ++i)
+			addresses.push_back(&queue.EmplaceBack(i, destroyed));
+
+		BOOST_REQUIRE_EQUAL(queue.Size(), 100);
+
+		for (int i = 0; i < 100; ++i)
+		{
+			BOOST_REQUIRE_EQUAL(&queue[i], addresses[i]);
+			BOOST_REQUIRE_EQUAL(queue[i].value, i);
+		}
+
+		queue.PopFront(40);
+		BOOST_REQUIRE_EQUAL(destroyed, 40);
+		BOOST_REQUIRE_EQUAL(queue.Front().value, 40);
+		BOOST_REQUIRE_EQUAL(&queue.Front(), addresses[40]);
+	}
+	BOOST_REQUIRE_EQUAL(destroyed, 100);
+}
+
+BOOST_AUTO_TEST_CASE(stablequeue_reuses_slots)
+{
+	CORE::StableQueue<std::string> queue(4);
+	std::vector<const std::string*> slots;
+
+	for (int i = 0; i < 4; ++i)
+		slots.push_back(&queue.EmplaceBack(std::to_string(i)));
+
+	// Wraps around the ring many times without another slot
+	for (int i = 4; i < 1000; ++i)
+	{
+		queue.PopFront();
+		auto* p_value = &queue.EmplaceBack(std::to_string(i));
+		BOOST_REQUIRE(std::find(slots.begin(), slots.end(), p_value) != slots.end());
+	}
+
+	BOOST_REQUIRE_EQUAL(queue.Capacity(), 4);
+	BOOST_REQUIRE_EQUAL(queue.Front(), "996");
+	BOOST_REQUIRE_EQUAL(queue[3], "999");
+}
+
+BOOST_AUTO_TEST_CASE(stablequeue_erases_in_order)
+{
+	CORE::StableQueue<int> queue(8);
+
+	// Start in the middle of the ring
+	for (int i = 0; i < 5; ++i)
+		queue.EmplaceBack(i);
+	queue.PopFront(5);
+
+	for (int i = 0; i < 8; ++i)
+		queue.EmplaceBack(i);
+
+	BOOST_REQUIRE_EQUAL(queue.EraseIf([](int value) { return value % 3 == 0; }), 3);
+	BOOST_REQUIRE_EQUAL(queue.Size(), 5);
+
+	const int expected[] = { 1, 2, 4, 5, 7 };
+	for (size_t i = 0; i < queue.Size(); ++i)
+		BOOST_REQUIRE_EQUAL(queue[i], expected[i]);
+
+	queue.EmplaceBack(8);
+	BOOST_REQUIRE_EQUAL(queue[5], 8);
+
+	queue.Clear();
+	BOOST_REQUIRE(queue.Empty());
+	BOOST_REQUIRE_EQUAL(queue.Capacity(), 8);
+}
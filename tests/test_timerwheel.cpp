@@ -0,0 +1,116 @@
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+#include <vector>
+#include "core/timerwheel.hpp"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+	struct Sleeper
+	{
+		explicit Sleeper(int aId) : id(aId), entry(*this) {}
+
+		int id;
+		CORE::TimerWheel<Sleeper>::Entry entry;
+	};
+}
+
+BOOST_AUTO_TEST_CASE(timerwheel_expires_in_order_of_deadline)
+{
+	CORE::TimerWheel<Sleeper> wheel(100ms, 16, 0ms);
+	Sleeper a(1), b(2), c(3);
+	std::vector<int> expired;
+	auto collect = [&expired](Sleeper& s) { expired.push_back(s.id); };
+
+	wheel.Schedule(a.entry, 250ms);
+	wheel.Schedule(b.entry, 1000ms);
+	wheel.Schedule(c.entry, 5000ms); // more than one revolution
+	BOOST_REQUIRE_EQUAL(wheel.Size(), 3);
+
+	wheel.Advance(249ms, collect);
+	BOOST_REQUIRE(expired.empty());
+
+	wheel.Advance(250ms, collect);
+	BOOST_REQUIRE_EQUAL(expired.size(), 1);
+	BOOST_REQUIRE_EQUAL(expired.back(), 1);
+	BOOST_REQUIRE(!a.entry.IsScheduled());
+
+	wheel.Advance(3400ms, collect);
+	BOOST_REQUIRE_EQUAL(expired.size(), 2);
+	BOOST_REQUIRE_EQUAL(expired.back(), 2);
+
+	wheel.Advance(4999ms, collect);
+	BOOST_REQUIRE_EQUAL(expired.size(), 2);
+
+	wheel.Advance(60000ms, collect);
+	BOOST_REQUIRE_EQUAL(expired.size(), 3);
+	BOOST_REQUIRE_EQUAL(expired.back(), 3);
+	BOOST_REQUIRE_EQUAL(wheel.Size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(timerwheel_cancel_and_reschedule)
+{
+	CORE::TimerWheel<Sleeper> wheel(100ms, 8, 1000ms);
+	Sleeper a(1), b(2);
+	int count = 0;
+
+	wheel.Schedule(a.entry, 1500ms);
+	wheel.Schedule(b.entry, 1500ms);
+	a.entry.Cancel();
+	BOOST_REQUIRE_EQUAL(wheel.Size(), 1);
+
+	// deadline in the past expires with the next advance
+	wheel.Schedule(a.entry, 500ms);
+	wheel.Advance(1000ms, [&count](Sleeper&) { ++count; });
+	BOOST_REQUIRE_EQUAL(count, 1);
+
+	// rescheduling from within the callback is allowed
+	wheel.Advance(1500ms, [&wheel, &count](Sleeper& s) { ++count; wheel.Schedule(s.entry, 2000ms); });
+	BOOST_REQUIRE_EQUAL(count, 2);
+	BOOST_REQUIRE(b.entry.IsScheduled());
+	BOOST_REQUIRE(b.entry.Deadline() == 2000ms);
+
+	{
+		Sleeper temporary(3);
+		wheel.Schedule(temporary.entry, 1600ms);
+		BOOST_REQUIRE_EQUAL(wheel.Size(), 2);
+	}
+	BOOST_REQUIRE_EQUAL(wheel.Size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(timerwheel_keeps_entries_when_callback_throws)
+{
+	CORE::TimerWheel<Sleeper> wheel(100ms, 8, 0ms);
+	Sleeper a(1), b(2), c(3), d(4);
+	std::vector<int> expired;
+
+	// a, b and c share a slot, d is due in an earlier one, which is visited after them
+	wheel.Schedule(a.entry, 300ms);
+	wheel.Schedule(b.entry, 300ms);
+	wheel.Schedule(c.entry, 300ms);
+	wheel.Schedule(d.entry, 100ms);
+
+	auto throwing = [&expired](Sleeper& s) {
+		expired.push_back(s.id);
+		throw std::runtime_error("callback failed");
+	};
+	BOOST_REQUIRE_THROW(wheel.Advance(300ms, throwing), std::runtime_error);
+
+	// Only the reported entry was unscheduled. The others stay within the wheel.
+	BOOST_REQUIRE_EQUAL(expired.size(), 1);
+	BOOST_REQUIRE_EQUAL(wheel.Size(), 3);
+	BOOST_REQUIRE(!a.entry.IsScheduled());
+	BOOST_REQUIRE(b.entry.IsScheduled() && c.entry.IsScheduled() && d.entry.IsScheduled());
+
+	// Cancelling an entry, which was not reported, unlinks it from the wheel
+	c.entry.Cancel();
+	BOOST_REQUIRE_EQUAL(wheel.Size(), 2);
+
+	// The remaining due entries expire with the next advance
+	wheel.Advance(300ms, [&expired](Sleeper& s) { expired.push_back(s.id); });
+	BOOST_REQUIRE_EQUAL(expired.size(), 3);
+	BOOST_REQUIRE_EQUAL(wheel.Size(), 0);
+	BOOST_REQUIRE(!b.entry.IsScheduled() && !d.entry.IsScheduled());
+}